@@ -0,0 +1,22 @@
+/*----------------------------------------------------------------------*/
+/*    NDES : décodage d'une trace binaire produite par le log.          */
+/*                                                                      */
+/*   Usage : ndes-logdump trace [fichier-texte]                         */
+/*   Le journal est écrit sur la sortie standard si aucun fichier texte */
+/* n'est fourni.                                                        */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+
+#include <log.h>
+
+int main(int argc, char * argv[]) {
+
+   if ((argc < 2) || (argc > 3)) {
+      fprintf(stderr, "Usage : %s trace [fichier-texte]\n", argv[0]);
+      exit(1);
+   }
+
+   return (ndesLog_decode(argv[1], (argc == 3)?argv[2]:NULL) < 0);
+}
@@ -15,6 +15,16 @@
 
 struct dateGenerator_t;
 
+/**
+ * @brief Nombre maximal d'inter-arrivées tirées d'avance
+ *
+ * Les inter-arrivées sont tirées par lots, dont la taille croît de
+ * DATE_GENERATOR_BATCH_MIN_LENGTH jusqu'à cette valeur (voir
+ * dateGenerator_setBatchLength).
+ */
+#define DATE_GENERATOR_BATCH_LENGTH 1024
+#define DATE_GENERATOR_BATCH_MIN_LENGTH 8
+
 /**
  * @brief Creation of a date generator
  * @result a struct dateGenerator_t * 
@@ -45,11 +55,28 @@ struct dateGenerator_t * dateGenerator_createPeriodic(double period);
 void dateGenerator_setRandomGenerator(struct dateGenerator_t * dateGen,
 				      struct randomGenerator_t * randGen);
 
+/**
+ * @brief Choix du nombre maximal d'inter-arrivées tirées d'avance
+ *
+ * @param dateGen le générateur à modifier
+ * @param length la taille maximale d'un lot. Avec 1, chaque
+ * inter-arrivée est tirée (et sondée) au moment où elle est utilisée.
+ */
+void dateGenerator_setBatchLength(struct dateGenerator_t * dateGen, int length);
+
+/**
+ * @brief Oubli des inter-arrivées tirées d'avance
+ */
+void dateGenerator_reset(struct dateGenerator_t * dateGen);
+
 /**
  * @brief Ajout d'une sonde sur les inter-arrivees
  *
  * @param dateGen le générateur à modifier
  * @param probe la sonde à affecter
+ *
+ * Les inter-arrivées sont sondées par lot, au moment de leur tirage,
+ * donc éventuellement avant d'être utilisées.
  */
 void dateGenerator_addInterArrivalProbe(struct dateGenerator_t * dateGen,
 					struct probe_t * probe);
@@ -72,4 +99,17 @@ void dateGenerator_setLambda(struct dateGenerator_t * dateGen, double lambda);
  */
 void dateGenerator_recordThenReplay(struct dateGenerator_t *  d);
 
+/*
+ * Prepare for record values in a file in order to replay on each
+ * reset (constant memory footprint)
+ */
+void dateGenerator_recordThenReplayToFile(struct dateGenerator_t *  d,
+                                          char * fileName);
+
+/*
+ * Replay values previously recorded in a file
+ */
+void dateGenerator_replayFromFile(struct dateGenerator_t *  d,
+                                  char * fileName);
+
 #endif
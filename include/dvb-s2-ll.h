@@ -7,9 +7,10 @@
  * préventif, cela apparait dans les noms des variables, et des macros
  * permettent d'envisager une modificiation sans conséquences sur le
  * reste.
- * Autre problème : il faudrait un point d'entrée par MODCOD. Pour le
- * moment, le MODCOD d'une BBFRAME est passé en private de la PDU
- * correspondante, ce qui n'est pas terrible du tout !
+ * Le MODCOD d'une BBFRAME est fourni avec elle lors de sa remise au
+ * lien (DVBS2ll_sendFrame). Le lien dispose d'une petite file de
+ * trames, ce qui permet à une source de calculer plusieurs trames
+ * d'avance.
  */
 
 #ifndef __DEF_DVBS2_LL
@@ -18,8 +19,6 @@
 #include <pdu.h>
 #include <probe.h>
 
-#define NB_MODCOD_MAX 4
-
 struct t_modcod;
 struct DVBS2ll_t;
 
@@ -88,6 +87,21 @@ int DVBS2ll_addModcod(struct DVBS2ll_t * dvbs2ll,
 		      unsigned int bbframeBitLength,
 		      unsigned int bitsPerSymbol);
 
+/**
+ * @brief Ajout des MODCODs décrits dans un fichier
+ * @param dvbs2ll le lien auquel ajouter les MODCODs
+ * @param fileName le nom du fichier
+ * @return le nombre de MODCODs ajoutés
+ *
+ * Chaque ligne décrit un MODCOD par deux mots : le nombre de bits par
+ * BBFRAME puis le nombre de bits par symbole. Chacun est un entier ou
+ * l'un des noms définis ci-dessus (C910SIZE, M32APSK, ...). Ce qui
+ * suit un '#' est ignoré. Les MODCODs sont ajoutés dans l'ordre du
+ * fichier et doivent donc y être classés par débit croissant. Il n'y a
+ * pas de limite à leur nombre (28 en DVB-S2, plus en DVB-S2X).
+ */
+int DVBS2ll_loadModcods(struct DVBS2ll_t * dvbs2ll, char * fileName);
+
 /*
  * Modification des propriétés du MODCOD n
  */
@@ -105,6 +119,36 @@ void DVBS2ll_setModcod(struct DVBS2ll_t * dvbs2ll,
  */
 void DVBS2ll_setSource(struct DVBS2ll_t * dvbs2ll, void * source, getPDU_t getPDU);
 
+/**
+ * @brief Type des fonctions de fourniture de trames par une source
+ * @param source la source
+ *
+ * Invoquée lorsque le lien a terminé une émission et n'a plus de
+ * trame en attente. La source remet alors zéro, une ou plusieurs
+ * trames via DVBS2ll_sendFrame. Si elle n'en remet aucune, une DUMMY
+ * PLFRAME est émise.
+ */
+typedef void (*DVBS2ll_provideFrames_t)(void * source);
+
+/**
+ * @brief Attribution d'une source de trames étiquetées par leur MODCOD
+ * @param dvbs2ll le lien
+ * @param source la source
+ * @param provideFrames la fonction de sollicitation de la source
+ *
+ * Remplace une éventuelle source définie par DVBS2ll_setSource.
+ */
+void DVBS2ll_setFrameSource(struct DVBS2ll_t * dvbs2ll, void * source,
+			    DVBS2ll_provideFrames_t provideFrames);
+
+/**
+ * @brief Taille de la file de trames du lien
+ * @param dvbs2ll le lien
+ * @param n nombre maximal (> 0) de trames en attente derrière celle en
+ * cours d'émission
+ */
+void DVBS2ll_setFrameQueueLength(struct DVBS2ll_t * dvbs2ll, int n);
+
 /*
  * Une fonction permettant la conformité au modèle d'échange
  */
@@ -112,13 +156,64 @@ int DVBS2ll_processPDU(struct DVBS2ll_t * dvbs2ll,
                         getPDU_t getPDU,
                         void * source);
 
+/**
+ * @brief Remise d'une BBFRAME à émettre sur un MODCOD
+ * @param dvbs2ll le lien
+ * @param pdu la BBFRAME, dont la taille ne doit pas dépasser la charge
+ * utile du MODCOD
+ * @param mc l'indice du MODCOD
+ * @return 1 si la trame est prise en charge, 0 si la file du lien est
+ * pleine (la trame reste alors à l'appelant)
+ *
+ * Si le support est libre et qu'aucune trame n'attend, l'émission
+ * commence immédiatement. Sinon la trame est émise après celles déjà
+ * remises. Une pdu NULL, qui n'est admise que si le support est
+ * libre, provoque l'émission d'une DUMMY PLFRAME.
+ */
+int DVBS2ll_sendFrame(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu, int mc);
+
+/**
+ * @brief Nombre de trames que le lien peut encore accepter
+ */
+int DVBS2ll_framesFree(struct DVBS2ll_t * dvbs2ll);
+
+/**
+ * @brief Nombre de trames remises et pas encore émises
+ */
+int DVBS2ll_framesQueued(struct DVBS2ll_t * dvbs2ll);
+
 /*
- * Emission d'une PDU au travers d'un MODCOD sélectionné. La PDU doit
- * être d'une taille inférieure ou égale à la taille de charge utile du
- * MODCOD choisi.
+ * Emission d'une PDU remise sans MODCOD (c'est le cas dans le modèle
+ * d'échange de NDES). Elle est émise sur le plus robuste des MODCODs
+ * dont la charge utile peut la contenir. Une PDU NULL correspond à une
+ * DUMMY PLFRAME.
  */
 void DVBS2ll_sendPDU(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu);
 
+/**
+ * @brief Autorisation du mode inactif
+ * @param dvbs2ll le lien
+ * @param idleMode valeur booléenne (0 par défaut)
+ *
+ * Lorsque la source n'a rien à émettre, le lien n'émet alors pas une
+ * DUMMY PLFRAME (et un événement) par durée de DUMMY : il n'en émet
+ * qu'une et ne sollicite plus la source. Les DUMMY qui auraient suivi
+ * sont comptées en bloc (sonde dummyFecFrameProbe) lors du réveil ou
+ * à la fin de la simulation. Le lien se réveille sur DVBS2ll_processPDU,
+ * DVBS2ll_sendFrame ou DVBS2ll_wakeUp et est libre à la fin de la
+ * DUMMY en cours, comme s'il avait émis les DUMMY une à une.
+ *
+ * La source n'étant pas sollicitée pendant l'inactivité, elle doit
+ * réveiller le lien lorsqu'elle a quelque chose à émettre, et ne pas
+ * dépendre des sollicitations sans résultat.
+ */
+void DVBS2ll_setIdleMode(struct DVBS2ll_t * dvbs2ll, int idleMode);
+
+/**
+ * @brief Réveil d'un lien inactif (sans effet s'il ne l'est pas)
+ */
+void DVBS2ll_wakeUp(struct DVBS2ll_t * dvbs2ll);
+
 /************************************************************************/
 /*    Les sondes                                                        */
 /************************************************************************/
@@ -140,6 +235,13 @@ void DVBS2ll_addDummyFecFrameProbe(struct DVBS2ll_t * dvbs2ll, struct probe_t *
  */
 int DVBS2ll_nbModcod(struct DVBS2ll_t * dvbs2ll);
 
+/*
+ * Version de la table des MODCODs. Elle change à chaque ajout ou
+ * modification d'un MODCOD, ce qui permet aux utilisateurs de savoir
+ * si ce qu'ils en ont déduit est encore valable.
+ */
+unsigned int DVBS2ll_modcodVersion(struct DVBS2ll_t * dvbs2ll);
+
 /*
  * Capacité d'une BBFRAME associée au MODCOD d'indice fourni
  */ 
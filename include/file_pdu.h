@@ -12,6 +12,7 @@
 #include <probe.h>
 
 struct filePDU_t;
+struct fluidSource_t;
 
 /**
  * Type de la stratÃ©gie de perte en cas d'insersion dans une file
@@ -49,6 +50,40 @@ unsigned long filePDU_getMaxSize(struct filePDU_t * file);
 void filePDU_setMaxLength(struct filePDU_t * file, unsigned long maxLength);
 unsigned long filePDU_getMaxLength(struct filePDU_t * file);
 
+/**
+ * @brief Partage de la file avec un trafic de fond fluide
+ * @param file la file
+ * @param fs la source fluide (dont la capacité du lien doit être
+ * définie)
+ *
+ * Le volume en attente dans la file fluide occupe une partie de la
+ * capacité maximale (voir filePDU_setMaxSize) : une PDU est rejetée
+ * si elle ne tient pas avec ce volume.
+ */
+void filePDU_setFluidBackground(struct filePDU_t * file, struct fluidSource_t * fs);
+
+/**
+ * @brief Type des fonctions notifiées des mouvements d'une file
+ * @param observer l'observateur enregistré
+ * @param pdu la PDU qui vient d'être insérée ou extraite
+ * @param insertion 1 pour une insertion, 0 pour une extraction
+ */
+typedef void (*filePDU_observer_t)(void * observer, struct PDU_t * pdu, int insertion);
+
+/**
+ * @brief Enregistrement d'un observateur des insertions/extractions
+ * @param file la file
+ * @param observer l'observateur (passé en premier paramètre de notify)
+ * @param notify la fonction invoquée, NULL pour ne plus observer
+ *
+ * Une file n'a qu'un observateur. Il est notifié de chaque PDU
+ * effectivement insérée (pas des pertes) et de chaque PDU extraite,
+ * y compris lors des pertes en tête et de la réinitialisation. Cela
+ * permet à un ordonnanceur de maintenir incrémentalement un état
+ * dérivé du contenu de la file.
+ */
+void filePDU_setObserver(struct filePDU_t * file, void * observer, filePDU_observer_t notify);
+
 
 /*
  * Choix de la stratÃ©gie de perte en cas d'insersion dans une file
@@ -84,6 +119,20 @@ int filePDU_processPDU(void * file,
  */
 struct PDU_t * filePDU_extract(struct filePDU_t * file);
 
+/**
+ * @brief Extraction des n premières PDUs de la file
+ * @param file la file depuis laquelle on extrait
+ * @param n le nombre de PDUs souhaitées
+ * @param pdus (out) tableau d'au moins n cases recevant les PDUs
+ * extraites, dans l'ordre de la file
+ * @return le nombre de PDUs extraites (moins de n si la file n'en
+ * contient pas assez)
+ *
+ * Équivalent à n appels à filePDU_extract (mêmes sondes, même
+ * journal, mêmes notifications), mais en une seule passe sur la file.
+ */
+int filePDU_extractN(struct filePDU_t * file, int n, struct PDU_t ** pdus);
+
 /**
  * @brief Extraction d'une PDU depuis la file
  * @param file la file depuis laquelle on souhaite extraire la
@@ -113,12 +162,32 @@ int filePDU_size(struct filePDU_t * file);
  */
 int filePDU_size_n_PDU(struct filePDU_t * file, int n);
 
+/**
+ * @brief Tailles cumulées des premières PDUs, en un seul parcours
+ * @param file la file
+ * @param maxSize volume cumulé à ne pas dépasser
+ * @param maxNb nombre maximal de PDUs à considérer
+ * @param cumul tableau d'au moins maxNb + 1 entiers
+ * @return le nombre k de PDUs dont le cumul tient dans maxSize
+ *
+ * En sortie, cumul[i] est le volume des i premières PDUs, pour i de
+ * 0 à k. Cette fonction évite les parcours répétés que nécessiterait
+ * filePDU_size_n_PDU.
+ */
+int filePDU_cumulatedSizes(struct filePDU_t * file, int maxSize, int maxNb, int * cumul);
+
 /*
  * Taille du enieme paquet de la file (n>=1)
  */
 int filePDU_size_PDU_n(struct filePDU_t * file, int n);
 int filePDU_id_PDU_n(struct filePDU_t * file, int n);
 
+/**
+ * @brief Date d'insertion de la première PDU (la file ne doit pas
+ * être vide)
+ */
+motSimDate_t filePDU_firstInsertDate(struct filePDU_t * file);
+
 /****************************************************************************
     File probes
  ***************************************************************************/
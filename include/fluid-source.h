@@ -0,0 +1,102 @@
+/**
+ * @file fluid-source.h
+ * @brief Les sources fluides
+ *
+ * Une source fluide représente un trafic de fond par son seul débit,
+ * constant par morceaux, sans produire de PDU. Elle ne crée aucun
+ * événement : les changements de débit sont calculés à la demande.
+ *
+ * Associée à un lien de capacité C (voir srvGen_setFluidBackground),
+ * elle est servie en priorité : le trafic paquet ne voit que la
+ * capacité résiduelle C - r(t). Si r(t) > C, le surplus s'accumule
+ * dans une file fluide qui doit être vidée avant que les paquets ne
+ * soient à nouveau servis.
+ */
+#ifndef __DEF_FLUID_SOURCE
+#define __DEF_FLUID_SOURCE
+
+#include <motsim.h>
+#include <date-generator.h>
+
+#include <ndesObject.h>
+
+struct fluidSource_t; //!< Le type d'une source fluide
+
+/**
+ * @brief Declare the object relative functions
+ */
+declareObjectFunctions(fluidSource);
+
+/**
+ * @brief Définition de couples {date, débit}
+ *
+ * Le débit (en octets par seconde) s'applique à partir de la date
+ * donnée et jusqu'à la date du couple suivant.
+ */
+struct fluidRate_t {
+   motSimDate_t date;
+   double       rate;
+};
+
+/**
+ * @brief Création d'une source fluide de profil déterministe
+ *
+ * @param profile Un tableau de couples {date, débit} de dates
+ * croissantes. Le dernier élément doit être {0.0, 0.0}, le débit du
+ * couple précédent s'applique alors indéfiniment. Le tableau n'est pas
+ * copié, il ne doit donc pas être libéré tant que la source peut
+ * servir.
+ * @result Un pointeur sur la source créée/initialisée
+ */
+struct fluidSource_t * fluidSource_createProfile(struct fluidRate_t * profile);
+
+/**
+ * @brief Création d'une source fluide on/off
+ *
+ * @param peakRate Le débit (en octets par seconde) en période "on"
+ * @param onDuration Le générateur des durées des périodes "on"
+ * @param offDuration Le générateur des durées des périodes "off"
+ * @result Un pointeur sur la source créée/initialisée
+ *
+ * La source commence par une période "off".
+ */
+struct fluidSource_t * fluidSource_createOnOff(double peakRate,
+                                               struct dateGenerator_t * onDuration,
+                                               struct dateGenerator_t * offDuration);
+
+/**
+ * @brief Capacité (en octets par seconde) du lien partagé
+ */
+void fluidSource_setLinkCapacity(struct fluidSource_t * fs, double capacity);
+
+/**
+ * @brief Débit de la source à la date courante
+ */
+double fluidSource_getRate(struct fluidSource_t * fs);
+
+/**
+ * @brief Volume de la file fluide à la date courante
+ */
+double fluidSource_getBacklog(struct fluidSource_t * fs);
+
+/**
+ * @brief Volume total émis par la source depuis le début de la
+ * simulation
+ */
+double fluidSource_getVolume(struct fluidSource_t * fs);
+
+/**
+ * @brief Date de fin de service d'un volume paquet
+ * @param fs La source fluide
+ * @param work Le volume (en octets) à servir à partir de maintenant
+ * @result La date à laquelle ce volume aura été servi avec la capacité
+ * résiduelle du lien
+ */
+motSimDate_t fluidSource_getServiceEnd(struct fluidSource_t * fs, double work);
+
+/**
+ * @brief Réinitialisation de la source (retour à la date 0)
+ */
+void fluidSource_reset(struct fluidSource_t * fs);
+
+#endif
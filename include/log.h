@@ -4,11 +4,17 @@
  *
  * L'objectif de cet outil est de permettre de "loguer" des
  * informations sur des événements qui ont lieu durant la
- * simulation. La base de données ainsi produite pourra ensuite être
- * sauvée dans un fichier permettant une exploitation a posteriori.
- * Le log est pour le moment une simple séquence de lignes de texte.
+ * simulation. Chaque événement est un enregistrement binaire de taille
+ * fixe (date, identifiant de l'objet, code de l'événement, paramètre)
+ * écrit dans des tampons recyclés puis vidés dans un fichier de
+ * trace. Ce fichier est ensuite décodé hors ligne (ndesLog_decode)
+ * pour obtenir le texte du journal.
  *
- * A faire : une macro USE_LOG sans laquelle tout est defini à rien.
+ * La journalisation est toujours compilée, mais chaque événement
+ * appartient à une catégorie (NDESLOG_FILE, NDESLOG_SRV, ...) qui
+ * peut être activée à l'exécution. Une catégorie inactive ne coûte
+ * qu'un test sur un masque global. La macro NDES_USES_LOG active
+ * toutes les catégories par défaut.
  */
 #ifndef __DEF_LOG
 #define __DEF_LOG
@@ -17,53 +23,196 @@
 
 #include <motsim.h>
 #include <ndesObject.h>
+#include <pdu.h>
+
+struct PDUFilter_t;
+
+/**
+ * @brief Les codes des événements journalisés
+ *
+ * Le paramètre d'un événement est l'identifiant de l'objet qui en est
+ * à l'origine (la file pour IN/OUT, la source pour CREATED_BY, ...)
+ */
+enum ndesLog_code_t {
+   ndesLog_text = 0,  //!< Texte libre (ndesLog_logLine)
+   ndesLog_type,      //!< "TYPE %s" : création d'un objet
+   ndesLog_in,        //!< "IN %d"
+   ndesLog_out,       //!< "OUT %d"
+   ndesLog_createdBy, //!< "CREATED_BY %d"
+   ndesLog_deletedBy, //!< "DELETED BY %d"
+   ndesLog_typeName,  //!< Interne : définition d'un nom de type
+   ndesLog_nbCodes
+};
+
+/**
+ * @brief Décodage d'un fichier de trace
+ * @param traceFileName le fichier de trace binaire
+ * @param textFileName le fichier texte produit (NULL pour la sortie
+ * standard)
+ * @return le nombre d'événements décodés, -1 en cas d'erreur
+ *
+ * Permet aussi de décoder hors ligne une trace produite par une autre
+ * simulation (voir examples/ndes-logdump).
+ */
+int ndesLog_decode(char * traceFileName, char * textFileName);
+
+/**
+ * @brief Les catégories de traces
+ *
+ * Chaque catégorie peut être activée à l'exécution, par
+ * ndesLog_setCategories ou par la variable d'environnement NDES_LOG
+ * (liste de noms séparés par des virgules, "all", ou un masque
+ * numérique), lue lors de ndesLog_init.
+ */
+#define NDESLOG_OBJECT 0x00000001 //!< "object" : création des objets (TYPE)
+#define NDESLOG_SOURCE 0x00000002 //!< "source" : les sources (CREATED_BY, OUT)
+#define NDESLOG_FILE   0x00000004 //!< "file" : les files (IN, OUT, DELETED BY)
+#define NDESLOG_SRV    0x00000008 //!< "srv" : les serveurs (IN, OUT)
+#define NDESLOG_SINK   0x00000010 //!< "sink" : les puits (IN)
+#define NDESLOG_SCHED  0x00000020 //!< "sched" : les ordonnanceurs (OUT)
+#define NDESLOG_TEXT   0x00000040 //!< "text" : les lignes libres
+#define NDESLOG_ALL    0xFFFFFFFF
+#define NDESLOG_NONE   0x00000000
+
+/**
+ * @brief Le masque des catégories actives
+ *
+ * A ne pas modifier directement, voir ndesLog_setCategories. Par
+ * défaut, toutes les catégories sont actives si NDES_USES_LOG est
+ * défini, aucune sinon.
+ */
+extern unsigned long ndesLog_categories;
+
+/**
+ * @brief Une catégorie est-elle active ?
+ *
+ * Le test est fait sur place, sans appel de fonction, et le
+ * compilateur est prévenu qu'il échoue en général.
+ */
+#define ndesLog_enabled(category) \
+   __builtin_expect((ndesLog_categories & (category)) != 0, 0)
 
 /**
- * Exporté pour ndesObject qui logue mais ne doit pas logué ce qui a
- * trait aux logs, ...
+ * @brief Journalisation d'un événement si sa catégorie est active
+ *
+ * L'objet n'est évalué que si la catégorie est active.
  */
-struct ndesObjectType_t ndesLogEntryType;
+#define ndesLog_trace(category, ndesObject, code, arg)		\
+   do {								\
+      if (ndesLog_enabled(category)) {				\
+         ndesLog_logEvent((ndesObject), (code), (arg));		\
+      }								\
+   } while (0)
 
-#ifdef NDES_USES_LOG
+/**
+ * @brief Journalisation d'un événement concernant une PDU
+ *
+ * L'événement n'est journalisé que si sa catégorie est active et que
+ * la PDU est retenue par l'échantillonnage (voir ndesLog_samplePDU).
+ * Une PDU nulle (extraction d'une file vide, ...) n'est pas tracée.
+ */
+#define ndesLog_tracePDU(category, pdu, code, arg)			\
+   do {								\
+      if ((ndesLog_enabled(category)) && ((pdu) != NULL)		\
+	  && (ndesLog_samplePDU(pdu))) {				\
+         ndesLog_logEvent(PDU_getObject(pdu), (code), (arg));	\
+      }								\
+   } while (0)
 
 /*
  * @brief Initialisation du log
+ *
+ * Lecture des variables d'environnement NDES_LOG (catégories),
+ * NDES_LOG_SAMPLE (échantillonnage des PDU) et NDES_LOG_FILE
+ * (fichier de trace). Invoquée par motSim_create.
  */
 void ndesLog_init();
 
+/**
+ * @brief Choix des catégories actives
+ * @param categories un masque de NDESLOG_*
+ */
+void ndesLog_setCategories(unsigned long categories);
+
+/**
+ * @brief Les catégories actives
+ */
+unsigned long ndesLog_getCategories();
+
 /*
- * @brief Activation du log
+ * @brief Activation de toutes les catégories
  */
 void ndesLog_enable();
 
 /*
- * @brief Désactivation du log
+ * @brief Désactivation de toutes les catégories
  */
 void ndesLog_disable();
 
+/**
+ * @brief Echantillonnage des PDU
+ * @param n seule une PDU sur n est tracée (0 ou 1 pour toutes)
+ *
+ * Le choix se fait sur l'identifiant de la PDU, de sorte que tous les
+ * événements d'une PDU retenue sont tracés.
+ */
+void ndesLog_setSampling(unsigned int n);
+
+/**
+ * @brief Filtrage des PDU tracées
+ * @param filter seules les PDU acceptées par ce filtre sont tracées
+ * (NULL pour aucun filtre)
+ *
+ * Le filtre se cumule à l'échantillonnage.
+ */
+void ndesLog_setPDUFilter(struct PDUFilter_t * filter);
+
+/**
+ * @brief La PDU doit-elle être tracée ?
+ */
+int ndesLog_samplePDU(struct PDU_t * pdu);
+
+/**
+ * @brief Choix du fichier de trace binaire
+ *
+ * A faire avant le premier événement. Par défaut, la trace est écrite
+ * dans NDESLOG_FICHIER_DEFAUT.
+ */
+void ndesLog_setFile(char * fileName);
+
+#define NDESLOG_FICHIER_DEFAUT "ndes-log.bin"
+
+/**
+ * @brief Journalisation d'un événement, quelles que soient les
+ * catégories actives
+ * @param ndesObject l'objet concerné
+ * @param code le code de l'événement (enum ndesLog_code_t)
+ * @param arg le paramètre de l'événement (ignoré pour ndesLog_type,
+ * le type étant celui de l'objet)
+ */
+void ndesLog_logEvent(struct ndesObject_t * ndesObject, int code, int arg);
+
 /*
- * Insersion d'une ligne de log
+ * Insersion d'une ligne de log (catégorie NDESLOG_TEXT)
  */
 void ndesLog_logLine(struct ndesObject_t * ndesObject, char * line);
 
 /*
- * @brief Insertion d'une ligne de log avec formatage
+ * @brief Insertion d'une ligne de log avec formatage (catégorie
+ * NDESLOG_TEXT)
  */
 void ndesLog_logLineF(struct ndesObject_t * ndesObject, char * fmt, ...);
 
+/**
+ * @brief Ecriture dans le fichier de trace de tous les événements
+ * journalisés par le thread appelant
+ */
+void ndesLog_flush();
+
 /*
- * Dump du log dans un fichier (l'éventuel contenu précédent est détruit)
+ * Dump du log dans un fichier (l'éventuel contenu précédent est
+ * détruit). La trace est vidée puis décodée dans le fichier texte.
  */
 int ndesLog_dump(char * fileName);
 
-#else  // Si NDES_USES_LOG n'est pas défini
-
-#define ndesLog_init() 
-#define ndesLog_enable()
-#define ndesLog_disable()
-#define ndesLog_logLine(ndesObject, line)
-#define ndesLog_logLineF(ndesObject, fmt, ...)
-#define ndesLog_dump(fileName)
-
-#endif // ifdef NDES_USES_LOG
 #endif
@@ -56,6 +56,17 @@ void motSim_create();
  */
 void motsim_addToResetList(void * data, void (*resetFunc)(void * data));
 
+/**
+ * @fun void motsim_addToRunList(void * data, void (*runFunc)(void * data))
+ * @brief Enregistrement d'un objet à prévenir au début de chaque
+ * motSim_runUntil, une fois la date de fin connue
+ * (motSim_getFinishTime)
+ * @param data donnée à passer à runFunc
+ * @param runFunc fonction invoquée au lancement de chaque exécution
+ * @result data s'est enregistré auprès du simulateur
+ */
+void motsim_addToRunList(void * data, void (*runFunc)(void * data));
+
 /**
  * @fun void motSim_reset()
  * @brief Réinitialisation pour une nouvelle exécution
@@ -90,6 +101,13 @@ void motSim_runNevents(int nbEvents);
  */
 motSimDate_t motSim_getCurrentTime();
 
+/**
+ * @fun motSimDate_t motSim_getFinishTime()
+ * @brief Obtention de la date de fin de la simulation en cours
+ * @return la date passée au dernier motSim_runUntil
+ */
+motSimDate_t motSim_getFinishTime();
+
 /**
  * @fun void motSim_runUntil(motSimDate_t date)
  * @brief Lancement d'une simulation d'une durée max de date
@@ -139,13 +157,6 @@ void motSim_exit(int retValue);
  * Les outils de debogage
 
  */
-#ifdef  DEBUG_NDES
-#include <stdio.h>
-
-#   define printf_debug(lvl, fmt, args...)	\
-   if ((lvl)& debug_mask)                    \
-      printf("[%6.3f ms] %s - " fmt, 1000.0*motSim_getCurrentTime() , __FUNCTION__ , ## args)
-
 #define DEBUG_EVENT    0x00000001
 #define DEBUG_MOTSIM   0x00000002
 #define DEBUG_GENE     0x00000004
@@ -172,6 +183,13 @@ void motSim_exit(int retValue);
 #define DEBUG_ALWAYS   0xFFFFFFFF
 #define DEBUG_NEVER    0x00000000
 
+#ifdef  DEBUG_NDES
+#include <stdio.h>
+
+#   define printf_debug(lvl, fmt, args...)	\
+   if ((lvl)& debug_mask)                    \
+      printf("[%6.3f ms] %s - " fmt, 1000.0*motSim_getCurrentTime() , __FUNCTION__ , ## args)
+
 static unsigned long debug_mask __attribute__ ((unused)) = 0x00000000
   //     | DEBUG_EVENT     // Les événements (lourd !)
   //     | DEBUG_MOTSIM    // Le moteur
@@ -198,6 +216,9 @@ static unsigned long debug_mask __attribute__ ((unused)) = 0x00000000
 
 #else
 #   define printf_debug(lvl, fmt, args...)
+
+// Les tests explicites du masque disparaissent à la compilation
+#   define debug_mask DEBUG_NEVER
 #endif
 
 #define MS_FATAL 1
@@ -59,7 +59,12 @@ struct ndesObjectType_t {
    void   (*free)(void *) ;     //!< Destruction d'une instance
    int    size;                 //!< La taille de la structure privée
    int    objectOffset; 
-   void * next;
+   void * next;                 //!< Les instances libres (voir ndesObjectType_alloc)
+
+   // Occupation du stock d'instances
+   unsigned long nbInUse;       //!< Instances allouées et non libérées
+   unsigned long nbFree;        //!< Instances libres, prêtes à resservir
+   unsigned long nbMalloc;      //!< Instances obtenues par malloc
 };
 
 /*
@@ -187,10 +192,43 @@ struct ndesObjectType_t * ndesObject_getType(struct ndesObject_t * ndesObject);
 /**
  * @brief Destruction d'un ndesObject.
  *
- * Les donnees privees doivent avoir ete detruites par l'appelant.
+ * Les donnees privees doivent avoir ete detruites par l'appelant. Les
+ * ndesObject sont alloués par blocs et recyclés, cette destruction ne
+ * fait que rendre celui-ci au stock commun.
  */
 void ndesObject_free(struct ndesObject_t * pdu);
 
+/*-----------------------------------------------------------------------
+ * Le stock d'instances de chaque type
+ *-----------------------------------------------------------------------
+ */
+
+/**
+ * @brief Obtention d'une instance d'un type
+ * @param ndesObjectType Le type de l'instance
+ * @return Une zone de ndesObjectType->size octets, non initialisée
+ *
+ * L'instance est prise parmi celles libérées par
+ * ndesObjectType_release si possible, allouée sinon.
+ */
+void * ndesObjectType_alloc(struct ndesObjectType_t * ndesObjectType);
+
+/**
+ * @brief Libération d'une instance d'un type
+ * @param ndesObjectType Le type de l'instance
+ * @param ob L'instance, qui ne doit plus être utilisée
+ *
+ * L'instance est conservée pour une prochaine allocation. Son premier
+ * champ (le pointeur sur le ndesObject) sert au chaînage, le
+ * ndesObject doit donc avoir été libéré avant.
+ */
+void ndesObjectType_release(struct ndesObjectType_t * ndesObjectType, void * ob);
+
+/**
+ * @brief Affichage de l'occupation du stock d'un type
+ */
+void ndesObjectType_printStats(struct ndesObjectType_t * ndesObjectType);
+
 /*-----------------------------------------------------------------------
  * Les fonctions par défaut
  *-----------------------------------------------------------------------
@@ -208,6 +246,8 @@ void ndesObject_defaultInit(void * ob);
 
 /**
  * @brief Libération générique d'un objet
+ *
+ * Le ndesObject est libéré et l'instance rendue au stock de son type.
  */
 void ndesObject_defaultFree(void * ob);
 
@@ -239,6 +279,12 @@ void ndesObject_defaultSetObject(void * ob, struct ndesObject_t * ndesObject);
  */
 void * ndesObject_createObject(struct ndesObjectType_t * ndesObjectType);
 
+/**
+ * @brief Destruction d'un objet créé par ndesObject_createObject
+ * @param ob L'objet, qui est libéré par la fonction free de son type
+ */
+void ndesObject_freeObject(void * ob);
+
 /*-----------------------------------------------------------------------
  * Gestion des types d'objets
  */
@@ -0,0 +1,106 @@
+/**
+ * @file pdu-source-aggregate.h
+ * @brief Agrégat de sources de PDU
+ *
+ * Un agrégat regroupe N processus d'arrivée indépendants (N flots)
+ * alimentant une même destination. Les prochaines dates de chaque
+ * flot sont conservées dans un tas, de sorte qu'un seul événement de
+ * l'agrégat est présent à tout instant dans l'échéancier du
+ * simulateur, quel que soit N.
+ */
+#ifndef __DEF_PDU_SOURCE_AGGREGATE
+#define __DEF_PDU_SOURCE_AGGREGATE
+
+#include <random-generator.h>
+#include <date-generator.h>
+#include <pdu.h>
+#include <motsim.h>
+
+#include <ndesObject.h>
+
+struct PDUSourceAggregate_t; //!< Le type d'un agrégat
+
+/**
+ * @brief Declare the object relative functions
+ */
+declareObjectFunctions(PDUSourceAggregate);
+
+/**
+ * @brief Création d'un agrégat de nbFlows flots homogènes
+ *
+ * @param nbFlows Le nombre de flots
+ * @param dateGen Le générateur de date utilisé par tous les flots
+ * @param destination L'entité aval
+ * @param destProcessPDU La fonction de traitement de la destination
+ * @result Un pointeur sur l'agrégat créé/initialisé
+ *
+ * Chaque tirage de dateGen fournit une inter-arrivée indépendante,
+ * un même générateur peut donc être partagé par tous les flots
+ * (qui restent indépendants). Voir
+ * PDUSourceAggregate_setFlowDateGenerator pour des flots hétérogènes.
+ */
+struct PDUSourceAggregate_t * PDUSourceAggregate_create(int nbFlows,
+                                     struct dateGenerator_t * dateGen,
+                                     void * destination,
+                                     processPDU_t destProcessPDU);
+
+/**
+ * @brief Choix du générateur de date d'un flot
+ * @param agg L'agrégat
+ * @param flow Le numéro du flot (entre 0 et nbFlows - 1)
+ * @param dateGen Le générateur de date de ce flot
+ */
+void PDUSourceAggregate_setFlowDateGenerator(struct PDUSourceAggregate_t * agg,
+                                             int flow,
+                                             struct dateGenerator_t * dateGen);
+
+/**
+ * @brief Spécification du générateur de taille des PDUs (commun à
+ * tous les flots)
+ *
+ *  En l'absence d'un tel générateur, les PDUs générées sont de taille
+ *  nulle.
+ */
+void PDUSourceAggregate_setPDUSizeGenerator(struct PDUSourceAggregate_t * agg,
+                                            struct randomGenerator_t * rg);
+
+/**
+ * @brief Positionnement d'une sonde sur la taille des PDUs produites
+ */
+void PDUSourceAggregate_addPDUGenerationSizeProbe(struct PDUSourceAggregate_t * agg,
+                                                  struct probe_t * probe);
+
+/**
+ * @brief Démarrage de l'agrégat (c'est aussi sa fonction de reset)
+ */
+void PDUSourceAggregate_start(struct PDUSourceAggregate_t * agg);
+
+/**
+ * @brief The function used by the destination to actually get the
+ * next PDU
+ */
+struct PDU_t * PDUSourceAggregate_getPDU(void * src);
+
+/**
+ * @brief Nombre de flots de l'agrégat
+ */
+int PDUSourceAggregate_getNbFlows(struct PDUSourceAggregate_t * agg);
+
+/**
+ * @brief Le flot ayant produit la dernière PDU
+ */
+int PDUSourceAggregate_getCurrentFlow(struct PDUSourceAggregate_t * agg);
+
+/**
+ * @brief Nombre de PDUs produites par un flot depuis le dernier reset
+ */
+unsigned long PDUSourceAggregate_getFlowNbPDU(struct PDUSourceAggregate_t * agg,
+                                              int flow);
+
+/**
+ * @brief Volume (en octets) produit par un flot depuis le dernier reset
+ */
+unsigned long PDUSourceAggregate_getFlowVolume(struct PDUSourceAggregate_t * agg,
+                                               int flow);
+
+#endif
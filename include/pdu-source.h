@@ -52,6 +52,78 @@ struct PDUSource_t * PDUSource_create(struct dateGenerator_t * dateGen,
 struct PDUSource_t * PDUSource_createDeterministic(struct dateSize * sequence,
 						   void * destination,
 						   processPDU_t destProcessPDU);
+/**
+ * @brief Format d'un enregistrement d'une trace binaire
+ *
+ * Une trace binaire est une simple suite de ces enregistrements (dans
+ * la représentation de la machine). Les dates doivent être croissantes.
+ */
+struct PDUTraceRecord_t {
+   motSimDate_t date;
+   unsigned int size;
+   unsigned int flowId;
+};
+
+/*
+ * Formats de trace disponibles
+ */
+#define PDUSourceTraceBinary 1 //!< Suite de struct PDUTraceRecord_t
+#define PDUSourceTraceText   2 //!< Lignes "date size [flowId]"
+
+/** @brief Création d'une source rejouant une trace
+ * 
+ *  @param fileName Le fichier contenant la trace
+ *  @param format PDUSourceTraceBinary ou PDUSourceTraceText
+ *  @param destination L'entité aval par défaut
+ *  @param destProcessPDU La fonction de traitement de la destination
+ *  @result Un pointeur sur la source créée/initialisée
+ *
+ *  La trace est lue séquentiellement par blocs, la mémoire utilisée
+ *  ne dépend donc pas de sa longueur. Dans le format texte, chaque
+ *  ligne contient une date, une taille et éventuellement un
+ *  identifiant de flot (séparés par des blancs ou des virgules), les
+ *  lignes commençant par '#' sont ignorées.
+ *  Les dates sont décalées de sorte que le premier enregistrement soit
+ *  émis à la date 0 (voir PDUSource_setTraceTimeShift).
+ */
+struct PDUSource_t * PDUSource_createFromTrace(char * fileName,
+                                               int format,
+                                               void * destination,
+                                               processPDU_t destProcessPDU);
+
+/**
+ * @brief Décalage temporel de la trace
+ * @param src La source
+ * @param shift La date à laquelle est émis le premier enregistrement
+ */
+void PDUSource_setTraceTimeShift(struct PDUSource_t * src,
+                                 motSimDate_t shift);
+
+/**
+ * @brief Rejeu en boucle de la trace
+ * @param src La source
+ * @param period La durée d'un tour de trace : le premier
+ * enregistrement est rejoué period secondes après le début du tour
+ * précédent. Une valeur nulle ou négative désactive le bouclage.
+ */
+void PDUSource_setTraceLoop(struct PDUSource_t * src,
+                            motSimDate_t period);
+
+/**
+ * @brief Association d'une destination à un flot de la trace
+ * @param src La source
+ * @param flowId L'identifiant du flot dans la trace
+ * @param destination L'entité aval pour ce flot
+ * @param destProcessPDU La fonction de traitement de cette destination
+ *
+ * Les flots sans destination spécifique sont envoyés à la destination
+ * par défaut (celle fournie à la création).
+ */
+void PDUSource_setTraceFlowDestination(struct PDUSource_t * src,
+                                       unsigned int flowId,
+                                       void * destination,
+                                       processPDU_t destProcessPDU);
+
 /**
  * @brief Change the date generator
  * @param src The PDUSource to modify
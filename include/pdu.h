@@ -12,6 +12,17 @@
 #include <motsim.h>
 
 struct PDU_t ;
+struct ndesObject_t ;
+
+/*
+ * Le ndesObject associé à une PDU (défini par defineObjectFunctions)
+ */
+struct ndesObject_t * PDU_getObject(struct PDU_t * PDU);
+
+/*
+ * L'identifiant de ce ndesObject
+ */
+int PDU_getObjectId(struct PDU_t * PDU);
 
 /*
  * Création d'une PDU de taille fournie. Elle peut contenir
@@ -33,9 +44,32 @@ extern motSimDate_t PDU_getCreationDate(struct PDU_t * PDU);
 
 void * PDU_private(struct PDU_t * PDU);
 
+/**
+ * @brief Type des fonctions de libération des données privées
+ */
+typedef void (*PDU_privateFree_t)(void * private);
+
+/**
+ * @brief Choix de la fonction de libération des données privées
+ * @param PDU la PDU
+ * @param freePrivate fonction invoquée sur les données privées lors
+ * de PDU_free (NULL pour aucune)
+ *
+ * Cela permet par exemple de libérer automatiquement un en-tête
+ * d'encapsulation quelle que soit l'entité qui détruit la PDU.
+ */
+void PDU_setPrivateFree(struct PDU_t * PDU, PDU_privateFree_t freePrivate);
+
+/**
+ * @brief La fonction de libération des données privées (NULL si
+ * aucune)
+ */
+PDU_privateFree_t PDU_getPrivateFree(struct PDU_t * PDU);
+
 /*
  * Destruction d'une PDU. Les donnees privees doivent avoir
- * ete detruites par l'appelant.
+ * ete detruites par l'appelant, sauf si une fonction de liberation
+ * a ete fournie (PDU_setPrivateFree).
  */
 void PDU_free(struct PDU_t * pdu);
 
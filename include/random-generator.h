@@ -49,6 +49,7 @@ struct randomGenerator_t;
 #define rGSourceErand48 1
 #define rGSourceReplay  2
 #define rgSourceUrandom 3
+#define rGSourceFileReplay 4
 
 #define rgSourceDefault rGSourceErand48
 
@@ -122,7 +123,8 @@ struct randomGenerator_t * randomGenerator_createFromProbe(struct probe_t * p);
 void randomGenerator_reset(struct randomGenerator_t * rg);
 
 /*
- * Destructor
+ * Destructor. Une trace en cours d'enregistrement est vidée puis
+ * fermée (elle l'est aussi automatiquement à la fin du processus).
  */
 void randomGenerator_delete(struct randomGenerator_t * rg);
 
@@ -208,12 +210,49 @@ void randomGenerator_setLambda(struct randomGenerator_t * rg, double lambda);
  */
 void randomGenerator_recordThenReplay(struct randomGenerator_t * rg);
 
+/**
+ * @brief Enregistrement des valeurs dans un fichier puis rejeu à
+ * chaque reset
+ * @param rg Le générateur
+ * @param fileName Le fichier (binaire) dans lequel sont enregistrées
+ * les valeurs
+ *
+ * Contrairement à randomGenerator_recordThenReplay, les valeurs ne
+ * sont pas conservées en mémoire mais écrites puis relues
+ * séquentiellement par blocs. L'empreinte mémoire est donc constante.
+ */
+void randomGenerator_recordThenReplayToFile(struct randomGenerator_t * rg,
+                                            char * fileName);
+
+/**
+ * @brief Rejeu des valeurs enregistrées dans un fichier
+ * @param rg Le générateur
+ * @param fileName Un fichier produit par
+ * randomGenerator_recordThenReplayToFile
+ *
+ * Permet d'utiliser les mêmes nombres aléatoires dans plusieurs
+ * simulations (de plusieurs processus).
+ */
+void randomGenerator_replayFromFile(struct randomGenerator_t * rg,
+                                    char * fileName);
+
 /*
  * Value generation
  */
 unsigned int randomGenerator_getNextUInt(struct randomGenerator_t * rg);
 double randomGenerator_getNextDouble(struct randomGenerator_t * rg);
 
+/**
+ * @brief Production de n valeurs successives
+ * @param rg Le générateur
+ * @param n Le nombre de valeurs à produire
+ * @param values Le tableau (d'au moins n éléments) à remplir
+ *
+ * Equivalent à n appels à randomGenerator_getNextDouble, en moins cher.
+ */
+void randomGenerator_getNextDoubles(struct randomGenerator_t * rg,
+                                    int n, double * values);
+
 /*
  * Obtention de certains paramÃ¨tres. Il s'agit ici de valeurs
  * thÃ©oriques, pour obtenir leurs Ã©quivalents sur une sÃ©rie
@@ -107,6 +107,8 @@ typedef struct {
    double    interet;
    int       nbChoix;        // Nombre de choix menant à cet interet
    int       casTraite;      // Pour éviter de retraiter un cas
+
+   struct remplissage_bloc_t * bloc; //!< Stockage de nbrePaquets
 } t_remplissage ;
 
 /**
@@ -141,18 +143,20 @@ typedef struct {
  *
  * la fonction schedule est invoquée par la fonction buildBBFRAME
  * générique. Si cette dernière est utilisée, la fonction
- * d'ordonnancement ne peut donc pas être null. Elle doit construire
+ * d'ordonnancement ne peut donc pas être null.
+ * Les fonctions getPDU et buildBBFRAME fournissent dans *modcod le
+ * MODCOD sur lequel émettre la BBFRAME produite. Elle doit construire
  * le champ "solutionChoisie" de la structure schedACM. C'est ce
  * champ, de type t_remplissage, 
  * qui est utilisé par la fonction buildBBFRAME générique pour
  * construire la BBFRAME en fonction du choix d'ordonnancement.
  */
 struct schedACM_func_t {
-   struct PDU_t * (*getPDU)(void * private);
+   struct PDU_t * (*getPDU)(void * private, int * modcod);
    int  (*processPDU)(void * private,
 	               getPDU_t getPDU, void * source);
 
-   struct PDU_t * (* buildBBFRAME)(void * private);
+   struct PDU_t * (* buildBBFRAME)(void * private, int * modcod);
 
    void (*schedule)(void * private);
    int batch;    //! < Une valeur non nulle stipule un ordonnanceur
@@ -203,11 +207,34 @@ void schedACM_setFileQoSType(struct schedACM_t * sched, int mc, int qos, int qos
  */
 double utiliteDerivee(t_qosMgt * qos, double x, struct DVBS2ll_t * dvbs2ll);
 
-/*
- * Fonction à invoquer lorsque le support est libre afin de solliciter
- * la construction d'une nouvelle trame
+/**
+ * @brief Construction d'une nouvelle trame
+ * @param sched l'ordonnanceur
+ * @param modcod (out) le MODCOD de la trame produite (peut être NULL)
+ * @return la BBFRAME ou NULL si rien n'est à émettre
+ */
+struct PDU_t * schedACM_getPDU(struct schedACM_t * sched, int * modcod);
+
+/**
+ * @brief Fourniture de trames au lien
+ *
+ * Invoquée par le lien (cf DVBS2ll_setFrameSource) lorsqu'il n'a plus
+ * de trame à émettre. Les BBFRAMEs sont construites puis remises au
+ * lien avec leur MODCOD.
  */
-struct PDU_t * schedACM_getPDU(struct schedACM_t * sched);
+void schedACM_provideFrames(struct schedACM_t * sched);
+
+/**
+ * @brief Nombre de BBFRAMEs construites d'avance
+ * @param sched l'ordonnanceur
+ * @param n le nombre (> 0) de trames remises au lien à chaque
+ * sollicitation (1 par défaut)
+ *
+ * Avec n > 1, le coût de chaque décision est amorti sur plusieurs
+ * trames, mais les paquets arrivés entre-temps ne sont pris en compte
+ * qu'à la sollicitation suivante. L'émission reste cadencée par le lien.
+ */
+void schedACM_setFramesAhead(struct schedACM_t * sched, int n);
 int schedACM_processPDU(struct schedACM_t * sched,
                          getPDU_t getPDU, void * source);
 
@@ -275,6 +302,44 @@ inline t_qosMgt * schedACM_getQoS(struct schedACM_t * sched, int mc, int qos);
  */
 inline struct DVBS2ll_t * schedACM_getACMLink(struct schedACM_t * sched);
 
+/*
+ * État des files d'entrée. Il est maintenu incrémentalement à partir
+ * des notifications des files (voir filePDU_setObserver), ces
+ * fonctions sont donc en temps constant, contrairement à leurs
+ * équivalents de file_pdu.h qui parcourent la file.
+ */
+
+/*
+ * Taille du n-ième paquet (n >= 1) de la file (m, q)
+ */
+int schedACM_getPDUSize(struct schedACM_t * sched, int m, int q, int n);
+
+/*
+ * Taille cumulée des n premiers paquets (n >= 0) de la file (m, q)
+ */
+int schedACM_getCumulatedSize(struct schedACM_t * sched, int m, int q, int n);
+
+/*
+ * Cumuls des tailles des premiers paquets de la file (m, q) : même
+ * sémantique que filePDU_cumulatedSizes
+ */
+int schedACM_cumulatedSizes(struct schedACM_t * sched, int m, int q, int maxSize, int maxNb, int * cumul);
+
+/*
+ * Dérivée de la fonction d'utilité de la file (m, q) en son débit
+ * courant. Elle n'est recalculée qu'au début d'un ordonnancement et
+ * seulement pour les files dont le débit ou la QoS a changé.
+ */
+double schedACM_getDerivee(struct schedACM_t * sched, int m, int q);
+
+/*
+ * Gain d'utilité de l'émission d'un paquet de la file (m, q) dans une
+ * BBFRAME du MODCOD mc (voir gainUtilite). Le gain par octet de
+ * chaque (file, MODCOD) est mis en cache avec la dérivée : il n'est
+ * recalculé qu'une fois par ordonnancement au plus.
+ */
+double schedACM_gainUtilite(struct schedACM_t * sched, int m, int q, int taillePaquet, int mc);
+
 /*
  * Obtention d'un pointeur vers une sonde
  */
@@ -309,6 +374,12 @@ void schedACM_afficherFiles(struct schedACM_t * sched, int mc);
  */
 void schedACM_printFilesSummary(struct schedACM_t * sched);
 
+/*
+ * Application de l'algorithme d'ordonnancement : la solution est
+ * ensuite disponible via schedACM_getSolution
+ */
+void schedACM_schedule(struct schedACM_t * sched);
+
 /*
  * Obtention d'un pointeur sur la solution choisie
  */
@@ -335,6 +406,43 @@ void schedACM_addNbSolProbe(struct schedACM_t * sched, struct probe_t * probe);
  */
 int schedACM_getNbSolutions(struct schedACM_t * sched);
 
+/**
+ * @brief Résolution d'un sous-problème associé à un MODCOD
+ * @param private les données privées de l'ordonnanceur
+ * @param mc le MODCOD de la BBFRAME envisagée
+ * @param remplissage (out) la solution pour ce MODCOD (mise à zéro,
+ * avec son modcod, avant l'appel)
+ * @param executant le numéro (de 0 à nbThreads - 1) de l'exécutant,
+ * pour l'utilisation de tampons de travail privés
+ *
+ * Une telle fonction ne doit modifier que remplissage et les tampons
+ * de son exécutant : elle peut être invoquée en parallèle pour
+ * plusieurs MODCODs.
+ */
+typedef void (*schedACM_solveMC_t)(void * private, int mc, t_remplissage * remplissage, int executant);
+
+/**
+ * @brief Choix du nombre d'exécutants pour la résolution par MODCOD
+ * Sans NDES_PTHREAD à la compilation, seule la valeur 1 est possible.
+ * Avec, le nombre ne peut plus changer après le premier ordonnancement.
+ */
+void schedACM_setNbThreads(struct schedACM_t * sched, int nb);
+int schedACM_getNbThreads(struct schedACM_t * sched);
+
+/**
+ * @brief Résolution indépendante de chaque MODCOD
+ * @param sched l'ordonnanceur
+ * @param solve la fonction de résolution pour un MODCOD
+ * @param remplissages un tableau de nbModCod remplissages initialisés
+ *
+ * La fonction solve est invoquée pour chaque MODCOD, séquentiellement
+ * ou par un pool d'exécutants persistant. Les solutions ne dépendent
+ * pas de l'ordre d'exécution : l'appelant les réduit ensuite dans
+ * l'ordre des MODCODs, le résultat est donc identique dans les deux
+ * cas.
+ */
+void schedACM_solveAllModcods(struct schedACM_t * sched, schedACM_solveMC_t solve, t_remplissage * remplissages);
+
 /**
  * @brief Choix de la longreur maximale d'une séquence
  */
@@ -402,8 +510,17 @@ void remplissage_free(t_remplissage * tr, int nbModCod);
  */
 int remplissage_nbPackets(t_remplissage * tr, int m, int q);
 
+/**
+ * @brief Tableaux de remplissages
+ *
+ * Les matrices nbrePaquets des nbR remplissages sont allouées d'un
+ * bloc, contigües : un tableau se remet à zéro d'un seul memset. Le
+ * bloc d'un tableau libéré est recyclé par l'allocation suivante de
+ * mêmes dimensions.
+ */
 void tabRemplissage_init(t_remplissage * tr, int nbR, int nbModCod, int nbQoS);
 void tabRemplissage_raz(t_remplissage * tr, int nbR, int nbModCod, int nbQoS);
+void tabRemplissage_free(t_remplissage * tr, int nbR);
 void remplissage_copy(t_remplissage * src, t_remplissage * dst, int nbModCod, int nbQoS);
 
 /**
@@ -411,6 +528,11 @@ void remplissage_copy(t_remplissage * src, t_remplissage * dst, int nbModCod, in
  */
 void sequence_init(t_sequence * seq, int lgMax, int nbModCod, int nbQoS);
 
+/**
+ * @brief Libération d'une séquence (son stockage est recyclé)
+ */
+void sequence_free(t_sequence * seq);
+
 /**
  * @brief Remise à zéro d'une séquence
  */
@@ -2,7 +2,8 @@
  * @file sched_drr.h
  * @brief Définition d'un ordonnanceur Deficit Round Robin
  *
- * En cours de ralisation, donc pas utilisable pour le moment
+ * Les entrées actives sont servies à partir d'une liste FIFO, chaque
+ * ordonnancement coûte O(1) quel que soit le nombre d'entrées.
  */
 #ifndef __SCHED_DEFICIT_ROUND_ROBIN
 #define __SCHED_DEFICIT_ROUND_ROBIN
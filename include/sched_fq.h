@@ -0,0 +1,102 @@
+/**
+ * @file sched_fq.h
+ * @brief Définition des ordonnanceurs équitables à temps virtuel
+ *
+ * Trois variantes de fair queueing paquet par paquet sont proposées,
+ * avec la même interface que le Deficit Round Robin (sched_drr.h) :
+ *
+ *   - WFQ (PGPS) [1] : la PDU servie est celle qui terminerait la
+ *     première dans le système fluide GPS, dont le temps virtuel est
+ *     suivi exactement. Il faut pour cela connaître le débit du lien.
+ *   - WF2Q+ [2] : seules les PDU éligibles (qui auraient commencé
+ *     dans le système fluide) sont candidates, ce qui évite les
+ *     rafales de WFQ.
+ *   - SCFQ [3] : le temps virtuel est l'étiquette de fin de la PDU en
+ *     cours de service.
+ *
+ * Chaque source reçoit un poids, sa part du lien étant son poids
+ * rapporté à la somme des poids des sources actives. Le choix de la
+ * prochaine PDU se fait sur un tas, en O(log N) pour N sources.
+ *
+ *   [1] A. Parekh, R. Gallager - "A Generalized Processor Sharing
+ *   Approach to Flow Control in Integrated Services Networks: The
+ *   Single-Node Case". IEEE/ACM ToN, 1993.
+ *   [2] J. Bennett, H. Zhang - "Hierarchical Packet Fair Queueing
+ *   Algorithms". SIGCOMM '96.
+ *   [3] S. J. Golestani - "A Self-Clocked Fair Queueing Scheme for
+ *   Broadband Applications". INFOCOM '94.
+ */
+#ifndef __SCHED_FAIR_QUEUEING
+#define __SCHED_FAIR_QUEUEING
+
+#include <pdu.h>
+#include <ndesObject.h>
+
+/**
+ * Structure définissant notre ordonanceur
+ */
+struct schedFQ_t ;
+
+/**
+ * @brief Declare the object relative functions
+ */
+declareObjectFunctions(schedFQ);
+
+/**
+ * @brief Création d'un ordonnanceur WFQ
+ * @param destination l'entité aval (un lien)
+ * @param destProcessPDU la fonction de réception de la destination
+ * @param throughput le débit (en bits/s) du lien aval, sur lequel est
+ * calé le système fluide
+ */
+struct schedFQ_t * schedWFQ_create(void * destination,
+				   processPDU_t destProcessPDU,
+				   unsigned long throughput);
+
+/**
+ * @brief Création d'un ordonnanceur WF2Q+
+ *
+ * Le temps virtuel avance du travail effectué, il n'est donc pas
+ * nécessaire de connaître le débit du lien.
+ */
+struct schedFQ_t * schedWF2QPlus_create(void * destination,
+					processPDU_t destProcessPDU);
+
+/**
+ * @brief Création d'un ordonnanceur SCFQ
+ */
+struct schedFQ_t * schedSCFQ_create(void * destination,
+				    processPDU_t destProcessPDU);
+
+/**
+ * @brief Ajout d'une source
+ * @param sched l'ordonnanceur
+ * @param weight le poids (strictement positif) de la source
+ * @param source la source
+ * @param getPDU la fonction fournissant les PDU de la source
+ *
+ * Le nombre de sources n'est pas limité.
+ */
+void schedFQ_addSource(struct schedFQ_t * sched,
+		       double weight,
+		       void * source,
+		       getPDU_t getPDU);
+
+/**
+ * @brief Le temps virtuel courant de l'ordonnanceur
+ */
+double schedFQ_getVirtualTime(struct schedFQ_t * sched);
+
+/**
+ * La fonction permettant de demander une PDU à notre scheduler
+ * C'est ici qu'est implanté l'algorithme
+ */
+struct PDU_t * schedFQ_getPDU(void * s);
+
+/**
+ * La fonction de soumission d'un paquet à notre ordonnanceur
+ */
+int schedFQ_processPDU(void *s,
+		       getPDU_t getPDU,
+		       void * source);
+#endif
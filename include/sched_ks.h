@@ -15,17 +15,29 @@
 
 struct sched_kse_t;
 
+/*
+ * Algorithmes de résolution disponibles (paramètre algo de
+ * sched_kse_create)
+ */
+#define KS_ALGO_BEST_PER_SIZE 0 // Pour une taille donnée, seule la meilleure piste
+#define KS_ALGO_EXHAUSTIVE    1 // Tous les cas (peut faire beaucoup !)
+#define KS_ALGO_DYNAMIC       2 // Programmation dynamique sur le volume
+
 /*
  * Création d'un scheduler avec sa "destination". Cette dernière doit
  * être de type struct DVBS2ll_t  et avoir déjà été complêtement
  * construite (tous les MODCODS créés).
  * Le nombre de files de QoS différentes par MODCOD est également
  * passé en paramètre.
- * Si exhaustif == 1 alors tous les cas sont envisages, ce qui peut
- * faire beaucoup. Sinon, pour une taille donnée, on ne poursuit que
- * la meilleure piste.
+ * Le paramètre algo désigne l'algorithme de résolution (KS_ALGO_*).
+ * Avec KS_ALGO_EXHAUSTIVE, tous les cas sont envisages, ce qui peut
+ * faire beaucoup. Avec KS_ALGO_BEST_PER_SIZE, pour une taille donnée,
+ * on ne poursuit que la meilleure piste. Ces deux algorithmes sont
+ * limités à NB_SOUS_CAS_MAX états. KS_ALGO_DYNAMIC résout exactement
+ * le problème par programmation dynamique sur le volume de la BBFRAME,
+ * sans limite sur le nombre d'états.
  */
-struct schedACM_t * sched_kse_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int declOK, int exhaustif);
+struct schedACM_t * sched_kse_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int declOK, int algo);
 
 
 #endif
@@ -7,11 +7,6 @@
 
 #include <pdu.h>
 
-/**
- * Nombre maximal d'entrées
- */
-#define SCHED_RR_NB_INPUT_MAX 8
-
 /**
  * Structure définissant notre ordonanceur
  */
@@ -26,6 +21,10 @@ struct rrSched_t * rrSched_create(void * destination,
 
 /**
  * Ajout d'une source (ce sera par exemple une file)
+ *
+ * Le nombre de sources n'est pas limité. Une source n'est sollicitée
+ * qu'après avoir signalé une PDU par rrSched_processPDU, en se
+ * désignant comme source.
  */
 void rrSched_addSource(struct rrSched_t * sched,
 		       void * source,
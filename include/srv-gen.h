@@ -10,6 +10,7 @@
 #include <motsim.h>
 
 struct srvGen_t;
+struct fluidSource_t;
 
 /**
  * @brief Création d'un serveur générique
@@ -63,3 +64,15 @@ void srvGen_setServiceTime(struct srvGen_t * srv,
  * @brief Ajout d'une sonde sur le temps de service
  */
 void srvGen_addServiceProbe(struct srvGen_t * srv, struct probe_t * serviceProbe);
+
+/**
+ * @brief Ajout d'un trafic de fond fluide
+ * @param srv le serveur à modifier
+ * @param fs la source fluide
+ *
+ * Le serveur doit avoir un temps de service proportionnel à la taille
+ * (serviceTimeProp), sa capacité est alors 1/parameter octets par
+ * seconde. La source fluide est servie en priorité, les PDUs ne
+ * disposent que de la capacité résiduelle.
+ */
+void srvGen_setFluidBackground(struct srvGen_t * srv, struct fluidSource_t * fs);
@@ -5,10 +5,12 @@
 #include <stdio.h>     // printf
 #include <stdlib.h>    // Malloc, NULL, exit...
 #include <math.h>      // log
+#include <assert.h>
 
 #include <motsim.h>
 #include <probe.h>
 #include <random-generator.h>  
+#include <date-generator.h>
 
 /** 
  * @brief Implantation des générateurs de dates.
@@ -31,6 +33,14 @@ struct dateGenerator_t {
        de vérifier qu'on est conforme à ce que l'on souhaite. */
    struct probe_t * interArrivalProbe;
 
+   /** Les inter-arrivées tirées d'avance, consommées de batchNext
+       à batchNb. */
+   double * batch;
+   int batchNext;
+   int batchNb;
+   int batchLength;    //!< Taille actuelle du tableau
+   int batchMaxLength; //!< Taille maximale du tableau
+
   //   double (* nextDate)(struct dateGenerator_t * dateGen, double currentTime);  //   void           * data;
 };
 
@@ -51,6 +61,23 @@ struct dateGenerator_t {
 void dateGenerator_setRandomGenerator(struct dateGenerator_t * dateGen,
 				      struct randomGenerator_t * randGen);
 
+/**
+ * @brief Oubli des inter-arrivées tirées d'avance
+ * @param dateGen le générateur
+ *
+ * C'est aussi la fonction de reset du générateur : les valeurs tirées
+ * d'avance ne doivent pas survivre à une réinitialisation de la
+ * source aléatoire (rejeu par exemple). La taille des lots repart
+ * elle aussi du minimum, afin qu'un rejeu tire exactement autant de
+ * valeurs que l'enregistrement.
+ */
+void dateGenerator_reset(struct dateGenerator_t * dateGen)
+{
+  dateGen->batchNext = 0;
+  dateGen->batchNb = 0;
+  dateGen->batchLength = 0;
+}
+
 struct dateGenerator_t * dateGenerator_create()
 {
   struct dateGenerator_t * result = (struct dateGenerator_t * )
@@ -59,6 +86,13 @@ struct dateGenerator_t * dateGenerator_create()
 
   result->randGen = NULL;
 
+  result->batch = NULL;
+  result->batchMaxLength = DATE_GENERATOR_BATCH_LENGTH;
+  dateGenerator_reset(result);
+
+  // Ajout à la liste des choses à réinitialiser avant une prochaine simu
+  motsim_addToResetList(result, (void (*)(void *))dateGenerator_reset);
+
   return result;
 }
 
@@ -111,6 +145,55 @@ void dateGenerator_setRandomGenerator(struct dateGenerator_t * dateGen,
 				      struct randomGenerator_t * randGen)
 {
    dateGen->randGen = randGen;
+   dateGenerator_reset(dateGen);
+}
+
+/**
+ * @brief Choix du nombre maximal d'inter-arrivées tirées d'avance
+ * @param dateGen le générateur à modifier
+ * @param length la taille maximale d'un lot (1 pour un tirage à
+ * chaque date)
+ */
+void dateGenerator_setBatchLength(struct dateGenerator_t * dateGen, int length)
+{
+   assert(length > 0);
+
+   dateGen->batchMaxLength = length;
+   dateGenerator_reset(dateGen);
+}
+
+/*
+ * Tirage d'un nouveau lot d'inter-arrivées. La taille du lot double à
+ * chaque fois jusqu'à batchMaxLength, de sorte qu'un générateur peu
+ * utilisé n'occupe que peu de mémoire.
+ */
+static void dateGenerator_fillBatch(struct dateGenerator_t * dateGen)
+{
+   int n;
+
+   if (dateGen->batchLength < dateGen->batchMaxLength) {
+      dateGen->batchLength = 2 * dateGen->batchLength;
+      if (dateGen->batchLength < DATE_GENERATOR_BATCH_MIN_LENGTH) {
+         dateGen->batchLength = DATE_GENERATOR_BATCH_MIN_LENGTH;
+      }
+      if (dateGen->batchLength > dateGen->batchMaxLength) {
+         dateGen->batchLength = dateGen->batchMaxLength;
+      }
+      dateGen->batch = realloc(dateGen->batch, dateGen->batchLength*sizeof(double));
+      assert(dateGen->batch);
+   }
+
+   randomGenerator_getNextDoubles(dateGen->randGen, dateGen->batchLength, dateGen->batch);
+   dateGen->batchNext = 0;
+   dateGen->batchNb = dateGen->batchLength;
+
+   // Les inter-arrivées sont sondées par lot, dès leur tirage
+   if (dateGen->interArrivalProbe){
+      for (n = 0; n < dateGen->batchNb; n++) {
+         probe_sample(dateGen->interArrivalProbe, dateGen->batch[n]);
+      }
+      printf_debug(DEBUG_GENE, " Mean = %6.3f\n", probe_mean(dateGen->interArrivalProbe));
+   }
 }
 
 
@@ -125,14 +208,11 @@ void dateGenerator_setRandomGenerator(struct dateGenerator_t * dateGen,
  */
 double dateGenerator_nextDate(struct dateGenerator_t * dateGen, double currentTime)
 {
-   double result =  randomGenerator_getNextDouble(dateGen->randGen);
-
-   if (dateGen->interArrivalProbe){
-      probe_sample(dateGen->interArrivalProbe, result);
-      printf_debug(DEBUG_GENE, " Mean = %6.3f\n", probe_mean(dateGen->interArrivalProbe));
+   if (dateGen->batchNext == dateGen->batchNb) {
+      dateGenerator_fillBatch(dateGen);
    }
 
-   return currentTime + result ;
+   return currentTime + dateGen->batch[dateGen->batchNext++];
   //   return dateGen->nextDate(dateGen, currentTime);
 }
 
@@ -185,6 +265,7 @@ double loi_expo(struct dateGenerator_t * dateGen, double currentTime)
 void dateGenerator_setLambda(struct dateGenerator_t * dateGen, double lambda)
 {
    randomGenerator_setLambda(dateGen->randGen, lambda);
+   dateGenerator_reset(dateGen);
 }
 
 /**
@@ -194,5 +275,32 @@ void dateGenerator_setLambda(struct dateGenerator_t * dateGen, double lambda)
  * @result le générateur de date est enregistré
  */
 void dateGenerator_recordThenReplay(struct dateGenerator_t *  d){
+  dateGenerator_reset(d);
   randomGenerator_recordThenReplay(d->randGen);
 };
+
+/**
+ * @brief Prepare for record values in a file in order to replay on
+ * each reset
+ * @param d le générateur de date dont on doit enregistrer puis rejouer
+ * les actions
+ * @param fileName le fichier dans lequel sont enregistrées les valeurs
+ */
+void dateGenerator_recordThenReplayToFile(struct dateGenerator_t *  d,
+                                          char * fileName)
+{
+  dateGenerator_reset(d);
+  randomGenerator_recordThenReplayToFile(d->randGen, fileName);
+}
+
+/**
+ * @brief Replay values previously recorded in a file
+ * @param d le générateur de date
+ * @param fileName le fichier dans lequel ont été enregistrées les valeurs
+ */
+void dateGenerator_replayFromFile(struct dateGenerator_t *  d,
+                                  char * fileName)
+{
+  dateGenerator_reset(d);
+  randomGenerator_replayFromFile(d->randGen, fileName);
+}
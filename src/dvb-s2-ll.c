@@ -7,6 +7,8 @@
 /*  pourrait alors gérer la progpatation                                */
 /*----------------------------------------------------------------------*/
 #include <stdlib.h>    // Malloc, NULL, exit...
+#include <stdio.h>     // fopen, fgets, ...
+#include <string.h>    // strtok, strcmp
 #include <assert.h>
 
 #include <motsim.h>
@@ -24,6 +26,26 @@ struct t_modcod {
 };
 
 
+/*
+ * Taille initiale de la table des MODCODs, qui est ensuite doublée
+ * autant que nécessaire
+ */
+#define DVBS2LL_NB_MODCOD_INIT 4
+
+/*
+ * Une BBFRAME remise au lien, avec le MODCOD sur lequel l'émettre
+ */
+struct DVBS2ll_trame_t {
+   struct PDU_t * pdu;
+   int            modcod;
+};
+
+/*
+ * Nombre de trames en attente d'émission par défaut (en plus de celle
+ * en cours d'émission)
+ */
+#define DVBS2LL_NB_TRAMES_DEFAUT 4
+
 /*
  * Les MODCODs seront classés dans l'ordre croissant de la capacité
  * donc dans l'ordre décroissant de la robustesse. On peut donc déclasser
@@ -33,7 +55,9 @@ struct DVBS2ll_t {
    unsigned int      FECFrameBitLength; // Taille de la FECFRAME
    unsigned long     symbolPerSecond;
    int               nbModCods;
-   struct t_modcod   modcod[NB_MODCOD_MAX];
+   unsigned int      versionModcods; // Incrémentée à chaque modification
+   int               nbModCodsAlloues; // Taille de la table modcod
+   struct t_modcod * modcod;
    int               available; // Le support est-il libre ?
 
    // Description de la destination
@@ -43,11 +67,25 @@ struct DVBS2ll_t {
    // Description de la source
    void * source;      // L'objet en question
    getPDU_t getPDU;    // La méthode de récupération des PDU
+   DVBS2ll_provideFrames_t provideFrames; // ou de trames étiquetées
 
    struct PDU_t   *  currentPDU; // La PDU en cours d'emission
 
+   // Les trames remises d'avance, dans l'ordre d'émission (anneau)
+   struct DVBS2ll_trame_t * trames;
+   int               nbTramesMax; // Taille de l'anneau
+   int               premiereTrame;
+   int               nbTrames;
+
    // Une probe de datage des DUMMY
    struct probe_t *  dummyFecFrameProbe;
+
+   // Mode inactif : les DUMMY ne sont pas émises une à une mais
+   // comptabilisées en bloc au réveil
+   int               modeInactif;    // Le mode est-il autorisé ?
+   int               inactif;        // Y sommes-nous ?
+   double            prochaineDummy; // Début de la prochaine DUMMY non comptée
+   double            finComptage;    // Date de l'événement de fin de simulation prévu
 };
 
 /*
@@ -59,9 +97,19 @@ void DVBS2ll_reset(struct DVBS2ll_t * dvbs2ll)
       PDU_free(dvbs2ll->currentPDU);
       dvbs2ll->currentPDU = NULL;
    }
+   while (dvbs2ll->nbTrames) {
+      PDU_free(dvbs2ll->trames[dvbs2ll->premiereTrame].pdu);
+      dvbs2ll->premiereTrame = (dvbs2ll->premiereTrame + 1)%dvbs2ll->nbTramesMax;
+      dvbs2ll->nbTrames--;
+   }
+   dvbs2ll->premiereTrame = 0;
    dvbs2ll->available = 1;
+   dvbs2ll->inactif = 0;
+   dvbs2ll->finComptage = -1.0;
 }
 
+static void DVBS2ll_lancement(struct DVBS2ll_t * dvbs2ll);
+
 /*
  * Création d'une entité DVB-S2 couche 2. Attention, elle ne contient
  * aucun MODCOD par défaut, il faut en ajouter.
@@ -77,18 +125,35 @@ struct DVBS2ll_t * DVBS2ll_create(void * destination,
  
    if (result) {
       result->nbModCods = 0;
+      result->versionModcods = 0;
+      result->nbModCodsAlloues = DVBS2LL_NB_MODCOD_INIT;
+      result->modcod = (struct t_modcod *)sim_malloc(DVBS2LL_NB_MODCOD_INIT*sizeof(struct t_modcod));
+      assert(result->modcod);
       result->destination = destination;
       result->send = destProcessPDU;
       result->symbolPerSecond = symbolPerSecond;
       result->FECFrameBitLength = FECFrameBitLength;
       result->source = NULL;
       result->getPDU = NULL;
+      result->provideFrames = NULL;
+      result->currentPDU = NULL;
+      result->nbTramesMax = DVBS2LL_NB_TRAMES_DEFAUT;
+      result->trames = (struct DVBS2ll_trame_t *)sim_malloc(DVBS2LL_NB_TRAMES_DEFAUT*sizeof(struct DVBS2ll_trame_t));
+      assert(result->trames);
+      result->premiereTrame = 0;
+      result->nbTrames = 0;
       result->dummyFecFrameProbe = NULL;
       result->available = 1;
+      result->modeInactif = 0;
+      result->inactif = 0;
+      result->finComptage = -1.0;
  
       // Ajout à la liste des choses à réinitialiser avant une prochaine simu
       motsim_addToResetList(result, (void (*)(void *))DVBS2ll_reset);
 
+      // Chaque exécution a sa propre date de fin de comptage
+      motsim_addToRunList(result, (void (*)(void *))DVBS2ll_lancement);
+
       printf_debug(DEBUG_DVB, "%p created\n", result);
    }
    return result;
@@ -103,6 +168,51 @@ void DVBS2ll_setSource(struct DVBS2ll_t * dvbs2ll, void * source, getPDU_t getPD
 {
    dvbs2ll->source = source;
    dvbs2ll->getPDU = getPDU;
+   dvbs2ll->provideFrames = NULL;
+}
+
+/*
+ * Attribution d'une source qui remet ses trames, étiquetées par leur
+ * MODCOD, via DVBS2ll_sendFrame
+ */
+void DVBS2ll_setFrameSource(struct DVBS2ll_t * dvbs2ll, void * source,
+			    DVBS2ll_provideFrames_t provideFrames)
+{
+   dvbs2ll->source = source;
+   dvbs2ll->getPDU = NULL;
+   dvbs2ll->provideFrames = provideFrames;
+}
+
+/*
+ * Autorisation du mode inactif
+ */
+void DVBS2ll_setIdleMode(struct DVBS2ll_t * dvbs2ll, int idleMode)
+{
+   dvbs2ll->modeInactif = idleMode;
+}
+
+/*
+ * Nombre maximal de trames en attente derrière celle en cours
+ * d'émission
+ */
+void DVBS2ll_setFrameQueueLength(struct DVBS2ll_t * dvbs2ll, int n)
+{
+   struct DVBS2ll_trame_t * trames;
+   int t;
+
+   assert(n > 0);
+   assert(n >= dvbs2ll->nbTrames);
+
+   // On remet les trames présentes dans l'ordre au début du nouvel anneau
+   trames = (struct DVBS2ll_trame_t *)sim_malloc(n*sizeof(struct DVBS2ll_trame_t));
+   assert(trames);
+   for (t = 0; t < dvbs2ll->nbTrames; t++) {
+      trames[t] = dvbs2ll->trames[(dvbs2ll->premiereTrame + t)%dvbs2ll->nbTramesMax];
+   }
+   free(dvbs2ll->trames);
+   dvbs2ll->trames = trames;
+   dvbs2ll->nbTramesMax = n;
+   dvbs2ll->premiereTrame = 0;
 }
 
 /*
@@ -116,7 +226,12 @@ int DVBS2ll_addModcod(struct DVBS2ll_t * dvbs2ll, unsigned int bbframeBitLength,
 {
    int n;
 
-   assert(dvbs2ll->nbModCods < NB_MODCOD_MAX);
+   if (dvbs2ll->nbModCods == dvbs2ll->nbModCodsAlloues) {
+      dvbs2ll->nbModCodsAlloues *= 2;
+      dvbs2ll->modcod = (struct t_modcod *)realloc(dvbs2ll->modcod,
+                                                   dvbs2ll->nbModCodsAlloues*sizeof(struct t_modcod));
+      assert(dvbs2ll->modcod);
+   }
 
    n = dvbs2ll->nbModCods;
 
@@ -139,22 +254,105 @@ void DVBS2ll_setModcod(struct DVBS2ll_t * dvbs2ll,
 
    // Les MODCODs doivent être "ordonnés" (pour le scheduler avec
    // déclassement, pas génial, il vaudrait mieux que l'algo vérifie
-   // mais ce serait plus lourd !)
+   // mais ce serait plus lourd !). C'est le débit utile (bits par
+   // BBFRAME multiplié par bits par symbole) qui doit croître : dans
+   // la table complète, un 8PSK 3/5 précède un QPSK 9/10.
    if (n>0) {
-     assert(bbframeBitLength >= dvbs2ll->modcod[n-1].bitLength);
-     assert(bitsPerSymbol >= dvbs2ll->modcod[n-1].bitsPerSymbol);
+     assert((unsigned long)bbframeBitLength*bitsPerSymbol
+            >= (unsigned long)dvbs2ll->modcod[n-1].bitLength*dvbs2ll->modcod[n-1].bitsPerSymbol);
    }
 
    if (n<dvbs2ll->nbModCods-1) {
-     assert(bbframeBitLength <= dvbs2ll->modcod[n+1].bitLength);
-     assert(bitsPerSymbol <= dvbs2ll->modcod[n+1].bitsPerSymbol);
+     assert((unsigned long)bbframeBitLength*bitsPerSymbol
+            <= (unsigned long)dvbs2ll->modcod[n+1].bitLength*dvbs2ll->modcod[n+1].bitsPerSymbol);
    }
 
 
    dvbs2ll->modcod[n].bitLength = bbframeBitLength;
    dvbs2ll->modcod[n].bitsPerSymbol = bitsPerSymbol;
    dvbs2ll->modcod[n].actualPayloadBitSizeProbe = NULL;
+   dvbs2ll->versionModcods++;
+}
+
+/*
+ * Les noms symboliques utilisables dans un fichier de MODCODs
+ */
+static struct {
+   char       * nom;
+   unsigned int valeur;
+} DVBS2ll_symboles[] = {
+   {C14SIZE_str, C14SIZE}, {C13SIZE_str, C13SIZE}, {C25SIZE_str, C25SIZE},
+   {C12SIZE_str, C12SIZE}, {C35SIZE_str, C35SIZE}, {C23SIZE_str, C23SIZE},
+   {C34SIZE_str, C34SIZE}, {C45SIZE_str, C45SIZE}, {C56SIZE_str, C56SIZE},
+   {C89SIZE_str, C89SIZE}, {C910SIZE_str, C910SIZE},
+   {MQPSK_str, MQPSK}, {M8PSK_str, M8PSK}, {M16APSK_str, M16APSK}, {M32APSK_str, M32APSK},
+   {NULL, 0}
+};
 
+/*
+ * Valeur d'un mot d'un fichier de MODCODs : un entier ou un nom
+ * symbolique. Retourne 0 si le mot n'est pas reconnu.
+ */
+static int DVBS2ll_valeurMot(char * mot, unsigned int * valeur)
+{
+   char * fin;
+   int n;
+
+   *valeur = (unsigned int)strtoul(mot, &fin, 10);
+   if ((fin != mot) && (*fin == 0)) {
+      return 1;
+   }
+   for (n = 0; DVBS2ll_symboles[n].nom; n++) {
+      if (!strcmp(mot, DVBS2ll_symboles[n].nom)) {
+         *valeur = DVBS2ll_symboles[n].valeur;
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*
+ * Ajout des MODCODs décrits dans un fichier texte
+ */
+int DVBS2ll_loadModcods(struct DVBS2ll_t * dvbs2ll, char * fileName)
+{
+   FILE * f;
+   char ligne[256];
+   char * codage, * modulation;
+   unsigned int bitLength = 0, bitsPerSymbol = 0;
+   int numLigne = 0;
+   int nb = 0;
+
+   f = fopen(fileName, "r");
+   if (f == NULL) {
+      motSim_error(MS_FATAL, "Ouverture de \"%s\" impossible\n", fileName);
+   }
+
+   while (fgets(ligne, sizeof(ligne), f)) {
+      numLigne++;
+      // Les commentaires vont jusqu'à la fin de la ligne
+      if (strchr(ligne, '#')) {
+         *strchr(ligne, '#') = 0;
+      }
+      codage = strtok(ligne, " \t\r\n");
+      if (codage == NULL) {
+         continue; // Ligne vide
+      }
+      modulation = strtok(NULL, " \t\r\n");
+      if ((modulation == NULL)
+	  || (!DVBS2ll_valeurMot(codage, &bitLength))
+	  || (!DVBS2ll_valeurMot(modulation, &bitsPerSymbol))
+	  || (strtok(NULL, " \t\r\n") != NULL)) {
+         motSim_error(MS_FATAL, "%s:%d : MODCOD mal decrit\n", fileName, numLigne);
+      }
+      DVBS2ll_addModcod(dvbs2ll, bitLength, bitsPerSymbol);
+      nb++;
+   }
+   fclose(f);
+
+   printf_debug(DEBUG_DVB, "%d MODCODs lus dans %s\n", nb, fileName);
+
+   return nb;
 }
 
 /*
@@ -165,6 +363,14 @@ int DVBS2ll_nbModcod(struct DVBS2ll_t * dvbs2ll)
    return dvbs2ll->nbModCods;
 }
 
+/*
+ * Version de la table des MODCODs
+ */
+unsigned int DVBS2ll_modcodVersion(struct DVBS2ll_t * dvbs2ll)
+{
+   return dvbs2ll->versionModcods;
+}
+
 /*
  * Capacité d'une BBFRAME associée au MODCOD d'indice fourni
  */ 
@@ -228,12 +434,111 @@ struct PDU_t * DVBS2ll_getPDU(struct DVBS2ll_t * dvbs2ll)
    return pdu;
 }
 
+static void DVBS2ll_transmit(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu, int mc);
+void DVBS2ll_endTransmission(struct DVBS2ll_t * dvbs2ll);
+
+/*
+ * Comptabilisation des DUMMY qui ont débuté jusqu'à la date courante
+ * pendant une période d'inactivité. Les dates sont cumulées comme
+ * elles le seraient par des émissions successives, la grille est donc
+ * exactement la même.
+ */
+static void DVBS2ll_compterDummies(struct DVBS2ll_t * dvbs2ll)
+{
+   double duree = DVBS2ll_bbframeTransmissionTime(dvbs2ll, dvbs2ll->nbModCods);
+   double maintenant = motSim_getCurrentTime();
+
+   while (dvbs2ll->prochaineDummy <= maintenant) {
+      if (dvbs2ll->dummyFecFrameProbe) {
+	 probe_sampleEvent(dvbs2ll->dummyFecFrameProbe);
+      }
+      dvbs2ll->prochaineDummy += duree;
+   }
+}
+
+/*
+ * Evénement de fin de simulation pendant une période d'inactivité :
+ * les sondes doivent être à jour
+ */
+static void DVBS2ll_finInactivite(struct DVBS2ll_t * dvbs2ll)
+{
+   dvbs2ll->finComptage = -1.0;
+   if (dvbs2ll->inactif) {
+      DVBS2ll_compterDummies(dvbs2ll);
+   }
+}
+
+/*
+ * Si la simulation se termine avant le réveil, il faut tout de même
+ * avoir compté les DUMMY jusque là
+ */
+static void DVBS2ll_planifierFinComptage(struct DVBS2ll_t * dvbs2ll)
+{
+   if ((motSim_getFinishTime() > motSim_getCurrentTime())
+       && (dvbs2ll->finComptage != motSim_getFinishTime())) {
+      dvbs2ll->finComptage = motSim_getFinishTime();
+      motSim_insertNewEvent((eventAction_t)DVBS2ll_finInactivite, dvbs2ll,
+			    motSim_getFinishTime());
+   }
+}
+
+/*
+ * Lancement d'une exécution (motSim_runUntil) : si le lien est resté
+ * inactif depuis la précédente, aucun événement ne le concerne, il
+ * faut donc planifier le comptage jusqu'à la nouvelle date de fin
+ */
+static void DVBS2ll_lancement(struct DVBS2ll_t * dvbs2ll)
+{
+   if (dvbs2ll->inactif) {
+      DVBS2ll_planifierFinComptage(dvbs2ll);
+   }
+}
+
+/*
+ * Entrée en inactivité : une première DUMMY débute maintenant, les
+ * suivantes ne génèrent aucun événement. Le support reste occupé
+ * (comme par une DUMMY) jusqu'au réveil.
+ */
+static void DVBS2ll_entrerInactivite(struct DVBS2ll_t * dvbs2ll)
+{
+   printf_debug(DEBUG_DVB, "t=%f : idle\n", motSim_getCurrentTime());
+
+   if (dvbs2ll->currentPDU) {
+      PDU_free(dvbs2ll->currentPDU);
+      dvbs2ll->currentPDU = NULL;
+   }
+   dvbs2ll->available = 0;
+   dvbs2ll->inactif = 1;
+   dvbs2ll->prochaineDummy = motSim_getCurrentTime();
+   DVBS2ll_compterDummies(dvbs2ll);
+   DVBS2ll_planifierFinComptage(dvbs2ll);
+}
+
+/*
+ * Sortie de l'inactivité
+ */
+void DVBS2ll_wakeUp(struct DVBS2ll_t * dvbs2ll)
+{
+   if (!dvbs2ll->inactif) {
+      return;
+   }
+   // La DUMMY en cours est comptée, le support se libère à sa fin,
+   // sur la grille des trames
+   DVBS2ll_compterDummies(dvbs2ll);
+   dvbs2ll->inactif = 0;
+
+   printf_debug(DEBUG_DVB, "t=%f : wake up at %f\n", motSim_getCurrentTime(), dvbs2ll->prochaineDummy);
+
+   motSim_insertNewEvent((eventAction_t)DVBS2ll_endTransmission, dvbs2ll,
+			 dvbs2ll->prochaineDummy);
+}
+
 /*
  * Evenement de fin d'emission
  */
 void DVBS2ll_endTransmission(struct DVBS2ll_t * dvbs2ll)
 {
-   struct PDU_t * pdu;
+   struct DVBS2ll_trame_t * trame;
 
    printf_debug(DEBUG_DVB, "t=%f\n",
 		motSim_getCurrentTime());
@@ -245,12 +550,31 @@ void DVBS2ll_endTransmission(struct DVBS2ll_t * dvbs2ll)
 
    // On est pret à remettre le couvert ...
    dvbs2ll->available = 1;
-   // On demande une BBFRAME à la source ...
-   pdu = dvbs2ll->getPDU(dvbs2ll->source);
 
-   // ... et on la transmet (s'il n'y en a pas, pdu == NULL et c'est
-   // une DUMMY qui est émise).
-   DVBS2ll_sendPDU(dvbs2ll, pdu);
+   // Si des trames ont été remises d'avance, on ne sollicite pas la
+   // source, sinon on lui demande une (ou plusieurs) BBFRAME. Dans le
+   // cas d'une source de trames, la première est émise par
+   // DVBS2ll_sendFrame.
+   if (dvbs2ll->nbTrames == 0) {
+      if (dvbs2ll->provideFrames) {
+         dvbs2ll->provideFrames(dvbs2ll->source);
+      } else if (dvbs2ll->getPDU) {
+         DVBS2ll_sendPDU(dvbs2ll, dvbs2ll->getPDU(dvbs2ll->source));
+      }
+   }
+
+   if (dvbs2ll->available) {
+      if (dvbs2ll->nbTrames) {
+         trame = &dvbs2ll->trames[dvbs2ll->premiereTrame];
+         dvbs2ll->premiereTrame = (dvbs2ll->premiereTrame + 1)%dvbs2ll->nbTramesMax;
+         dvbs2ll->nbTrames--;
+         DVBS2ll_transmit(dvbs2ll, trame->pdu, trame->modcod);
+      } else if (dvbs2ll->modeInactif) { // Rien à émettre
+         DVBS2ll_entrerInactivite(dvbs2ll);
+      } else { // Rien à émettre, c'est une DUMMY
+         DVBS2ll_transmit(dvbs2ll, NULL, dvbs2ll->nbModCods);
+      }
+   }
 }
 
 /*
@@ -264,31 +588,24 @@ void  DVBS2ll_endPropagation(struct DVBS2ll_t * dvbs2ll)
 }
 
 /*
- * Emission d'une PDU au travers d'un MODCOD sélectionné. La PDU doit
- * être d'une taille inférieure ou égale à la taille de charge utile du
- * MODCOD choisi.
- * 
- * L'indice du MODCOD a utiliser est passe dans le champ prive de la PDU
+ * Emission effective d'une trame sur le MODCOD mc. Si pdu est NULL,
+ * c'est une DUMMY PLFRAME (et mc vaut nbModCods).
  */
-void DVBS2ll_sendPDU(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu)
+static void DVBS2ll_transmit(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu, int mc)
 {
    double transmissionTime;
    //   double propagationTime = 0.0; // WARNING on ne peut pas mettre plus, on ne sait pas garder plus d'une PDU !!!
 
-   int mc = dvbs2ll->nbModCods; // Représente une DUMMY PLFRAME
-   unsigned int bitLength;
-   //   unsigned int bitsPerSymbol;
+   unsigned int bitLength = 0;
 
    // On doit être dispo
    assert(dvbs2ll->available);
 
-   // Le cas pdu == NULL est toléré et correspond à une
-   // demande d'émission d'une trame de bourage (DUMMY PLFRAME)
    if (pdu) {
-     mc  = (int)(long)PDU_private(pdu);
-  
+      assert(mc >= 0);
+      assert(mc < dvbs2ll->nbModCods);
+
       bitLength = dvbs2ll->modcod[mc].bitLength;
-      //bitsPerSymbol = dvbs2ll->modcod[mc].bitsPerSymbol;
 
       // Les tailles de PDU sont en octets, celle du DVB en bits
       assert(8*PDU_size(pdu) <= bitLength);
@@ -324,6 +641,81 @@ void DVBS2ll_sendPDU(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu)
    //			 motSim_getCurrentTime() + propagationTime);
 }
 
+/*
+ * Remise d'une BBFRAME à émettre sur le MODCOD mc
+ */
+int DVBS2ll_sendFrame(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu, int mc)
+{
+   struct DVBS2ll_trame_t * trame;
+
+   // Le support inactif ne sera libre qu'à la fin de la DUMMY en cours
+   DVBS2ll_wakeUp(dvbs2ll);
+
+   // Support libre et personne devant : on émet tout de suite
+   if ((dvbs2ll->available) && (dvbs2ll->nbTrames == 0)) {
+      DVBS2ll_transmit(dvbs2ll, pdu, pdu?mc:dvbs2ll->nbModCods);
+      return 1;
+   }
+
+   // Une DUMMY ne s'attend pas, elle comble un vide
+   assert(pdu);
+   assert(mc >= 0);
+   assert(mc < dvbs2ll->nbModCods);
+   assert(8*PDU_size(pdu) <= dvbs2ll->modcod[mc].bitLength);
+
+   if (dvbs2ll->nbTrames == dvbs2ll->nbTramesMax) {
+      printf_debug(DEBUG_DVB, "frame queue full, frame refused\n");
+      return 0;
+   }
+   trame = &dvbs2ll->trames[(dvbs2ll->premiereTrame + dvbs2ll->nbTrames)%dvbs2ll->nbTramesMax];
+   trame->pdu = pdu;
+   trame->modcod = mc;
+   dvbs2ll->nbTrames++;
+
+   return 1;
+}
+
+/*
+ * Nombre de trames que le lien peut encore accepter
+ */
+int DVBS2ll_framesFree(struct DVBS2ll_t * dvbs2ll)
+{
+   return dvbs2ll->nbTramesMax - dvbs2ll->nbTrames + (dvbs2ll->available?1:0);
+}
+
+/*
+ * Nombre de trames remises d'avance et pas encore émises
+ */
+int DVBS2ll_framesQueued(struct DVBS2ll_t * dvbs2ll)
+{
+   return dvbs2ll->nbTrames;
+}
+
+/*
+ * Le MODCOD le plus robuste dont la BBFRAME peut contenir une PDU de
+ * la taille donnée (en octets)
+ */
+static int DVBS2ll_modcodPourTaille(struct DVBS2ll_t * dvbs2ll, int size)
+{
+   int mc;
+
+   for (mc = 0; mc < dvbs2ll->nbModCods; mc++) {
+      if (8*size <= dvbs2ll->modcod[mc].bitLength) {
+         return mc;
+      }
+   }
+   motSim_error(MS_FATAL, "PDU de %d octets trop grande pour tous les MODCODs\n", size);
+   return -1;
+}
+
+/*
+ * Emission d'une PDU remise sans MODCOD (modèle d'échange de NDES)
+ */
+void DVBS2ll_sendPDU(struct DVBS2ll_t * dvbs2ll, struct PDU_t * pdu)
+{
+   DVBS2ll_sendFrame(dvbs2ll, pdu, pdu?DVBS2ll_modcodPourTaille(dvbs2ll, PDU_size(pdu)):dvbs2ll->nbModCods);
+}
+
 /*
  * Le support est-il disponible ?
  */
@@ -342,6 +734,9 @@ int DVBS2ll_processPDU(struct DVBS2ll_t * dvbs2ll,
 {
    struct PDU_t * pdu;
 
+   // Quelque chose arrive, il faut sortir de l'inactivité
+   DVBS2ll_wakeUp(dvbs2ll);
+
    // Si c'est juste pour tester si je suis pret
    if ((getPDU == NULL) || (source == NULL)) {
       printf_debug(DEBUG_ALWAYS, "getPDU/source should not be NULL\n");
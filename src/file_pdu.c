@@ -7,6 +7,7 @@
 #include <assert.h>
 
 #include <file_pdu.h>
+#include <fluid-source.h>
 #include <motsim.h>
 #include <ndesObject.h>
 #include <log.h>
@@ -52,6 +53,13 @@ struct filePDU_t {
    struct probe_t * dropProbe;
    struct probe_t * sejournProbe;
    struct probe_t * lengthProbe;
+
+   /* Le trafic de fond fluide partageant la file */
+   struct fluidSource_t * fluid;
+
+   /* L'éventuel observateur des entrées/sorties */
+   void * observer;
+   filePDU_observer_t notify;
 };
 
 /**
@@ -109,6 +117,10 @@ struct PDU_t * filePDU_extract(struct filePDU_t * file)
       file->nombre --;
       file->size -= PDU_size(PDU_private(premier));
 
+      if (file->notify) {
+         file->notify(file->observer, PDU_private(premier), 0);
+      }
+
       /* Gestion des sondes */
       if (file->extractProbe) {
          probe_sampleValuePDUFilter(file->extractProbe, PDU_size(PDU_private(premier)), PDU_private(premier));
@@ -126,11 +138,65 @@ struct PDU_t * filePDU_extract(struct filePDU_t * file)
    }
    printf_debug(DEBUG_FILE, "out (pdu id %d)\n", PDU?PDU_id(PDU):-1);
    //   filePDU_dump(file);
-   ndesLog_logLineF(PDU_getObject(PDU), "OUT %d", filePDU_getObjectId(file));
+   ndesLog_tracePDU(NDESLOG_FILE, PDU, ndesLog_out, filePDU_getObjectId(file));
    
    return PDU;
 }
 
+/*
+ * Extraction des n premiers éléments de la file en une passe.
+ */
+int filePDU_extractN(struct filePDU_t * file, int n, struct PDU_t ** pdus)
+{
+   struct PDU_t * premier;
+   struct PDU_t * PDU;
+   int k;
+
+   printf_debug(DEBUG_FILE, " file %p extracting %d PDUs (out of %d) at %6.3f\n", file, n, file->nombre, motSim_getCurrentTime());
+
+   if (n > file->nombre) {
+      n = file->nombre;
+   }
+
+   for (k = 0; k < n; k++) {
+      premier = file->premier;
+      PDU = PDU_private(premier);
+      file->premier = PDU_getNext(premier);
+      file->nombre--;
+      file->size -= PDU_size(PDU);
+
+      if (file->notify) {
+         file->notify(file->observer, PDU, 0);
+      }
+
+      /* Gestion des sondes */
+      if (file->extractProbe) {
+         probe_sampleValuePDUFilter(file->extractProbe, PDU_size(PDU), PDU);
+      }
+      if (file->sejournProbe) {
+         if (motSim_getCurrentTime() < PDU_getCreationDate(premier)) {
+	    printf_debug(DEBUG_WARN, "Attention, quand on purge, il ne faut pas mettre dans les sondes\n");
+         } else {
+	    probe_sampleValuePDUFilter(file->sejournProbe, motSim_getCurrentTime() - PDU_getCreationDate(premier), PDU);
+	 }
+      }
+      ndesLog_tracePDU(NDESLOG_FILE, PDU, ndesLog_out, filePDU_getObjectId(file));
+
+      PDU_free(premier);
+      pdus[k] = PDU;
+   }
+
+   // Le chaînage n'est réparé qu'une fois
+   if (file->premier) {
+      PDU_setPrev(file->premier, NULL);
+   } else {
+      assert(file->nombre == 0);
+      file->dernier = NULL;
+   }
+
+   return n;
+}
+
 struct PDU_t * filePDU_getPDU(void * file)
 {
    struct PDU_t * pdu = filePDU_extract((struct filePDU_t *) file);
@@ -241,6 +307,11 @@ struct filePDU_t * filePDU_create(void * destination,
    result->sejournProbe = NULL;
    result->lengthProbe = NULL;
 
+   result->fluid = NULL;
+
+   result->observer = NULL;
+   result->notify = NULL;
+
    // Ajout Ã  la liste des choses Ã  rÃ©initialiser avant une prochaine simu
    motsim_addToResetList(result, (void (*)(void *))filePDU_reset);
 
@@ -249,10 +320,22 @@ struct filePDU_t * filePDU_create(void * destination,
    return result;
 }
 
+void filePDU_setFluidBackground(struct filePDU_t * file, struct fluidSource_t * fs)
+{
+   file->fluid = fs;
+}
+
+void filePDU_setObserver(struct filePDU_t * file, void * observer, filePDU_observer_t notify)
+{
+   file->observer = observer;
+   file->notify = notify;
+}
+
 void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
 {
    struct PDU_t * pq;
    struct PDU_t * pduDel;
+   unsigned long fluidSize = 0; // Volume occupé par le trafic fluide
  
    printf_debug(DEBUG_FILE, " file %p insert PDU %d size %d (Length = %d/%d, size = %lu/%d, strat %d)\n",
                 file, PDU_id(PDU), PDU_size(PDU),
@@ -260,11 +343,15 @@ void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
 
    //   filePDU_dump(file);
 
+   if (file->fluid && file->maxSize) {
+      fluidSize = (unsigned long)fluidSource_getBacklog(file->fluid);
+   }
+
    // S'il s'agit d'une "drop head", on fait la place si besoin est !
    if (file->dropStrategy == filePDU_dropHead) {
       while ((((file->maxLength) && (file->maxLength < file->nombre + 1))    // Trop de PDUs
              ||            
-	    ((file->maxSize) && (file->maxSize < file->size + PDU_size(PDU))) // Trop de volume
+	    ((file->maxSize) && (file->maxSize < file->size + fluidSize + PDU_size(PDU))) // Trop de volume
 	    ) && (file->nombre)) {
  	 printf_debug(DEBUG_FILE, "need some room, head droping ...\n");
 
@@ -274,7 +361,7 @@ void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
          }
 
          pduDel = filePDU_extract(file);
-         ndesLog_logLineF(PDU_getObject(pduDel), "DELETED BY %d", filePDU_getObjectId(file));
+         ndesLog_tracePDU(NDESLOG_FILE, pduDel, ndesLog_deletedBy, filePDU_getObjectId(file));
 
          PDU_free(pduDel);
 
@@ -284,7 +371,7 @@ void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
 
    // S'il s'agit d'une drop tail 
    // WARNING a mieux expliquer, voire re écrire
-   if (((file->maxSize == 0)||(file->size + PDU_size(PDU) <= file->maxSize))
+   if (((file->maxSize == 0)||(file->size + fluidSize + PDU_size(PDU) <= file->maxSize))
        && ((file->maxLength == 0)||(file->nombre + 1 <= file->maxLength))) {
       pq = PDU_create(0, PDU);// Oui, les PDUs servent de chainons de liste !
 
@@ -302,7 +389,13 @@ void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
       file->nombre++;
       file->size += PDU_size(PDU);
 
-      ndesLog_logLineF(PDU_getObject(PDU), "IN %d", filePDU_getObjectId(file));
+      // L'observateur doit être au courant avant que la destination
+      // ne vienne, le cas échéant, extraire des PDUs
+      if (file->notify) {
+         file->notify(file->observer, PDU, 1);
+      }
+
+      ndesLog_tracePDU(NDESLOG_FILE, PDU, ndesLog_in, filePDU_getObjectId(file));
 
       /* Gestion des sondes */
       if (file->insertProbe) {
@@ -329,7 +422,7 @@ void filePDU_insert(struct filePDU_t * file, struct PDU_t * PDU)
       if (file->dropProbe) {
          probe_sample(file->dropProbe, PDU_size(PDU));
       }
-      ndesLog_logLineF(PDU_getObject(PDU), "DELETED BY %d", filePDU_getObjectId(file));
+      ndesLog_tracePDU(NDESLOG_FILE, PDU, ndesLog_deletedBy, filePDU_getObjectId(file));
 
       PDU_free(PDU); 
       file->nbOverflow++;
@@ -409,6 +502,30 @@ int filePDU_size_n_PDU(struct filePDU_t * file, int n)
    return result;
 }
 
+/**
+ * @brief Tailles cumulées des premières PDUs, en un seul parcours
+ * @param file la file
+ * @param maxSize volume cumulé à ne pas dépasser
+ * @param maxNb nombre maximal de PDUs à considérer
+ * @param cumul tableau d'au moins maxNb + 1 entiers
+ * @return le nombre k de PDUs dont le cumul tient dans maxSize
+ */
+int filePDU_cumulatedSizes(struct filePDU_t * file, int maxSize, int maxNb, int * cumul)
+{
+   int k = 0;
+   struct PDU_t * pq = file->premier;
+
+   cumul[0] = 0;
+   while ((pq) && (k < maxNb)
+	  && (cumul[k] + PDU_size((struct PDU_t *)PDU_private(pq)) <= maxSize)) {
+      cumul[k+1] = cumul[k] + PDU_size((struct PDU_t *)PDU_private(pq));
+      k++;
+      pq = PDU_getNext(pq);
+   }
+
+   return k;
+}
+
 /**
  * @brief Taille cumulée des PDU d'une file
  */
@@ -468,6 +585,17 @@ int filePDU_id_PDU_n(struct filePDU_t * file, int n)
    return PDU_id((struct PDU_t *)PDU_private(pq));
 }
 
+/*
+ * Date d'insertion de la première PDU de la file
+ */
+motSimDate_t filePDU_firstInsertDate(struct filePDU_t * file)
+{
+   assert(file->premier);
+
+   // Le chaînon est créé lors de l'insertion
+   return PDU_getCreationDate(file->premier);
+}
+
 /*
  * Affectation d'une sonde sur les evenements d'insertion
  */
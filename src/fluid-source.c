@@ -0,0 +1,310 @@
+/**
+ * @file fluid-source.c
+ * @brief Les sources fluides
+ *
+ *   Le débit est décrit par une liste de segments {début, débit},
+ *   construite paresseusement : un segment n'est créé que lorsqu'une
+ *   requête (débit, volume, fin de service) a besoin de voir aussi
+ *   loin. Les segments passés sont oubliés au fur et à mesure que la
+ *   date courante avance, la mémoire utilisée reste donc bornée.
+ *
+ *   L'état de la file fluide (volume en attente, volume émis) est mis
+ *   à jour à la demande jusqu'à la date courante.
+ */
+#include <stdlib.h>    // Malloc, NULL, exit...
+#include <string.h>    // memmove
+#include <values.h>    // MAXDOUBLE
+#include <assert.h>
+
+#include <fluid-source.h>
+
+#define fluidSourceProfile 1
+#define fluidSourceOnOff   2
+
+/**
+ * @brief Un segment de débit constant
+ */
+struct fluidSegment_t {
+   motSimDate_t start; //!< Début du segment (fin du précédent)
+   double       rate;  //!< Débit (en octets par seconde)
+};
+
+/**
+ * @brief Une source fluide
+ */
+struct fluidSource_t {
+   declareAsNdesObject;  //!< C'est un ndesObject
+
+   int mode;             //!< Profil ou on/off
+
+   // Pour un profil déterministe
+   struct fluidRate_t * profile; //!< Le profil
+   int profileIdx;       //!< Prochain élément du profil à prendre en compte
+
+   // Pour une source on/off
+   double peakRate;      //!< Débit crête
+   struct dateGenerator_t * onDuration;
+   struct dateGenerator_t * offDuration;
+
+   // Les segments connus, le premier est le segment courant
+   struct fluidSegment_t * seg;
+   int nbSeg;
+   int nbSegMax;
+
+   // Etat de la file fluide à la date lastDate
+   double capacity;      //!< Capacité du lien (0 si non définie)
+   motSimDate_t lastDate;
+   double backlog;
+   double volume;
+};
+
+/**
+ * @brief Définition des fonctions spécifiques liées au ndesObject
+ */
+defineObjectFunctions(fluidSource);
+struct ndesObjectType_t fluidSourceType = {
+  ndesObjectTypeDefaultValues(fluidSource)
+};
+
+/*
+ * Ajout d'un segment en fin de liste
+ */
+static void fluidSource_appendSegment(struct fluidSource_t * fs,
+                                      motSimDate_t start, double rate)
+{
+   if (fs->nbSeg == fs->nbSegMax) {
+      fs->nbSegMax = fs->nbSegMax?2*fs->nbSegMax:8;
+      fs->seg = realloc(fs->seg, fs->nbSegMax*sizeof(struct fluidSegment_t));
+      assert(fs->seg);
+   }
+   fs->seg[fs->nbSeg].start = start;
+   fs->seg[fs->nbSeg].rate = rate;
+   fs->nbSeg++;
+}
+
+/*
+ * Construction du segment suivant le dernier connu. Renvoie 0 si le
+ * dernier segment est infini.
+ */
+static int fluidSource_extend(struct fluidSource_t * fs)
+{
+   struct fluidSegment_t * last = &fs->seg[fs->nbSeg - 1];
+
+   switch (fs->mode) {
+      case fluidSourceProfile :
+         if ((fs->profileIdx > 0) && (fs->profile[fs->profileIdx].date == 0.0)) {
+            return 0;
+         }
+         fluidSource_appendSegment(fs, fs->profile[fs->profileIdx].date,
+                                   fs->profile[fs->profileIdx].rate);
+         fs->profileIdx++;
+      break;
+      case fluidSourceOnOff :
+         if (last->rate > 0.0) {
+            fluidSource_appendSegment(fs,
+                 dateGenerator_nextDate(fs->onDuration, last->start), 0.0);
+         } else {
+            fluidSource_appendSegment(fs,
+                 dateGenerator_nextDate(fs->offDuration, last->start), fs->peakRate);
+         }
+      break;
+      default :
+         motSim_error(MS_FATAL, "Unknown fluid source mode");
+      break;
+   }
+   return 1;
+}
+
+/*
+ * Fin du segment i (MAXDOUBLE s'il est infini)
+ */
+static motSimDate_t fluidSource_segmentEnd(struct fluidSource_t * fs, int i)
+{
+   if ((i + 1 == fs->nbSeg) && (!fluidSource_extend(fs))) {
+      return MAXDOUBLE;
+   }
+   return fs->seg[i + 1].start;
+}
+
+/*
+ * Mise à jour de l'état jusqu'à la date courante
+ */
+static void fluidSource_advance(struct fluidSource_t * fs)
+{
+   motSimDate_t now = motSim_getCurrentTime();
+   motSimDate_t end, to;
+   double r, d;
+
+   while (fs->lastDate < now) {
+      end = fluidSource_segmentEnd(fs, 0);
+      to = (end < now)?end:now;
+      d = to - fs->lastDate;
+      r = fs->seg[0].rate;
+
+      fs->volume += r * d;
+      if (fs->capacity > 0.0) {
+         fs->backlog += (r - fs->capacity) * d;
+         if (fs->backlog < 0.0) {
+            fs->backlog = 0.0;
+         }
+      }
+      fs->lastDate = to;
+
+      // Le segment courant est terminé, on l'oublie
+      if (to == end) {
+         fs->nbSeg--;
+         memmove(fs->seg, fs->seg + 1, fs->nbSeg*sizeof(struct fluidSegment_t));
+      }
+   }
+}
+
+void fluidSource_reset(struct fluidSource_t * fs)
+{
+   fs->nbSeg = 0;
+   fs->profileIdx = 0;
+   fs->lastDate = 0.0;
+   fs->backlog = 0.0;
+   fs->volume = 0.0;
+
+   // Le premier segment commence toujours à 0
+   if (fs->mode == fluidSourceProfile) {
+      if (fs->profile[0].date > 0.0) {
+         fluidSource_appendSegment(fs, 0.0, 0.0);
+      } else {
+         fluidSource_appendSegment(fs, 0.0, fs->profile[0].rate);
+         fs->profileIdx = 1;
+      }
+   } else {
+      fluidSource_appendSegment(fs, 0.0, 0.0);
+   }
+}
+
+/*
+ * Création d'une source sans segment
+ */
+static struct fluidSource_t * fluidSource_create(int mode)
+{
+   struct fluidSource_t * result = (struct fluidSource_t *)
+              sim_malloc(sizeof(struct fluidSource_t));
+
+   ndesObjectInit(result, fluidSource);
+
+   result->mode = mode;
+   result->profile = NULL;
+   result->profileIdx = 0;
+   result->peakRate = 0.0;
+   result->onDuration = NULL;
+   result->offDuration = NULL;
+   result->seg = NULL;
+   result->nbSeg = 0;
+   result->nbSegMax = 0;
+   result->capacity = 0.0;
+
+   // Ajout à la liste des choses à réinitialiser avant une prochaine simu
+   motsim_addToResetList(result, (void (*)(void *))fluidSource_reset);
+
+   return result;
+}
+
+struct fluidSource_t * fluidSource_createProfile(struct fluidRate_t * profile)
+{
+   struct fluidSource_t * result = fluidSource_create(fluidSourceProfile);
+
+   result->profile = profile;
+   fluidSource_reset(result);
+
+   return result;
+}
+
+struct fluidSource_t * fluidSource_createOnOff(double peakRate,
+                                               struct dateGenerator_t * onDuration,
+                                               struct dateGenerator_t * offDuration)
+{
+   struct fluidSource_t * result = fluidSource_create(fluidSourceOnOff);
+
+   result->peakRate = peakRate;
+   result->onDuration = onDuration;
+   result->offDuration = offDuration;
+   fluidSource_reset(result);
+
+   return result;
+}
+
+void fluidSource_setLinkCapacity(struct fluidSource_t * fs, double capacity)
+{
+   fluidSource_advance(fs);
+   fs->capacity = capacity;
+}
+
+double fluidSource_getRate(struct fluidSource_t * fs)
+{
+   fluidSource_advance(fs);
+
+   return fs->seg[0].rate;
+}
+
+double fluidSource_getBacklog(struct fluidSource_t * fs)
+{
+   fluidSource_advance(fs);
+
+   return fs->backlog;
+}
+
+double fluidSource_getVolume(struct fluidSource_t * fs)
+{
+   fluidSource_advance(fs);
+
+   return fs->volume;
+}
+
+/*
+ * Le calcul se fait sur une copie de l'état : la file fluide doit
+ * d'abord être vidée, ensuite le volume paquet est servi avec la
+ * capacité résiduelle, segment après segment.
+ */
+motSimDate_t fluidSource_getServiceEnd(struct fluidSource_t * fs, double work)
+{
+   double C = fs->capacity;
+   double b, r, s;
+   motSimDate_t t, end;
+   int i;
+
+   if (C <= 0.0) {
+      motSim_error(MS_FATAL, "Fluid source without link capacity");
+   }
+
+   fluidSource_advance(fs);
+
+   b = fs->backlog;
+   t = motSim_getCurrentTime();
+   for (i = 0; ; i++) {
+      end = fluidSource_segmentEnd(fs, i);
+      r = fs->seg[i].rate;
+      if (r >= C) {
+         if (end == MAXDOUBLE) {
+            motSim_error(MS_WARN, "Link saturated forever by fluid source %d\n",
+                         fluidSource_getObjectId(fs));
+            return MAXDOUBLE;
+         }
+         b += (r - C) * (end - t);
+      } else {
+         s = C - r;
+         // On vide d'abord la file fluide
+         if (b > 0.0) {
+            if (t + b / s >= end) {
+               b -= s * (end - t);
+               t = end;
+               continue;
+            }
+            t += b / s;
+            b = 0.0;
+         }
+         // Puis on sert les paquets
+         if ((end == MAXDOUBLE) || (t + work / s <= end)) {
+            return t + work / s;
+         }
+         work -= s * (end - t);
+      }
+      t = end;
+   }
+}
@@ -15,6 +15,7 @@ struct llSimplex_t {
 
    struct PDU_t     * pdu; // La PDU en cours d'émission
    struct filePDU_t * flyingPDUs;  // Les PDUs "en vol"
+   int propagating;                // Une fin de propagation est-elle prévue ?
    struct PDU_t     * pduOut; // Une PDU qui vient de sortir
 
    // L'entité aval
@@ -26,6 +27,22 @@ struct llSimplex_t {
    void * lastSource;
 };
 
+/*
+ * Réinitalisation. Les PDU en vol sont détruites avec la file, et les
+ * événements avec l'échéancier
+ */
+static void llSimplex_reset(struct llSimplex_t * lls)
+{
+   if (lls->pdu) {
+      PDU_free(lls->pdu);
+      lls->pdu = NULL;
+   }
+   lls->idle = 1;
+   lls->propagating = 0;
+   lls->lastSource = NULL;
+   lls->lastGetPDU = NULL;
+}
+
 /*
  * Création d'une entité. Les deux paramètres importants sont le
  * débits (en bits/s) et le temps de propagation (en secondes).
@@ -46,6 +63,11 @@ struct llSimplex_t * llSimplex_create(void * destination,
    result->lastGetPDU = NULL;
    result->pduOut = NULL;
    result->flyingPDUs = filePDU_create(NULL, NULL);
+   result->propagating = 0;
+   result->pdu = NULL;
+
+   // Ajout à la liste des choses à réinitialiser avant une prochaine simu
+   motsim_addToResetList(result, (void (*)(void *))llSimplex_reset);
 
    result->idle = 1;
 
@@ -62,6 +84,10 @@ void llSimplex_delete(struct llSimplex_t * lls)
 
 /*
  * Fin d'un temps de propagation
+ *
+ * Un seul événement est prévu à la fois, pour la première PDU en
+ * vol : le temps de propagation étant constant, les PDU arrivent dans
+ * l'ordre, et l'événement est réarmé pour la suivante.
  */
 void llSimplex_endOfPropagation(void * l)
 {
@@ -80,6 +106,15 @@ void llSimplex_endOfPropagation(void * l)
    // S'il ne l'a pas prise tout de suite, elle est perdue !
    PDU_free(lls->pduOut);
 
+   // On prépare l'arrivée de la suivante
+   if (filePDU_length(lls->flyingPDUs) > 0) {
+      event_add(llSimplex_endOfPropagation,
+		l,
+		filePDU_firstInsertDate(lls->flyingPDUs) + lls->propagation);
+   } else {
+      lls->propagating = 0;
+   }
+
    printf_debug(DEBUG_PDU, "out");
 }
 
@@ -102,11 +137,14 @@ void llSimplex_endOfTransmission(void * l)
    // Elle est partie !
    lls->pdu = NULL;
 
-   // On prépare son arrivée
-   printf_debug(DEBUG_PDU, "On prepare la fin de propagation a %lf\n", motSim_getCurrentTime() + lls->propagation);
-   event_add(llSimplex_endOfPropagation,
-	     l,
-	     motSim_getCurrentTime() + lls->propagation);
+   // On prépare son arrivée, sauf si elle suit une PDU déjà en vol
+   if (!lls->propagating) {
+      printf_debug(DEBUG_PDU, "On prepare la fin de propagation a %lf\n", motSim_getCurrentTime() + lls->propagation);
+      event_add(llSimplex_endOfPropagation,
+		l,
+		motSim_getCurrentTime() + lls->propagation);
+      lls->propagating = 1;
+   }
 
    // On va voir en amont si par hasard une nouvelle PDU n'attend pas ...
    if ((lls->lastSource) && (lls->lastGetPDU)){
@@ -2,140 +2,618 @@
  *  @file log.c
  *  @brief Gestion des log de NDES
  *
- *  Pas encore pret à être utilisé ! L'objectif des logs est
- *  d'enregistrer des événements significatifs dans une simulation. La
- *  définition de ce qui est significatif est à la discrétion de
- *  l'utilisateur ! L'idée n'est pas de fournir un outil de débogage,
- *  il n'a pas vocation à être utilisé pour des gros volumes de
- *  données. Il s'agit plutôt de permettre de transcrire des petites
+ *  L'objectif des logs est d'enregistrer des événements significatifs
+ *  dans une simulation. La définition de ce qui est significatif est
+ *  à la discrétion de l'utilisateur ! L'idée n'est pas de fournir un
+ *  outil de débogage, mais plutôt de permettre de transcrire des
  *  simulations, par exemple pour tracer des chronogrammes à vocation
  *  pédagogique ou illustrative.
+ *
+ *  Chaque événement est un enregistrement de taille fixe. Les
+ *  enregistrements sont accumulés dans un tampon par thread. Un
+ *  tampon plein est écrit dans le fichier de trace puis recyclé : il
+ *  n'y a donc ni allocation ni formatage par événement. Avec
+ *  NDES_PTHREAD, l'écriture est confiée à un thread dédié et le
+ *  simulateur n'attend que si tous les tampons sont pleins.
+ *
+ *  Les événements sont regroupés en catégories activées à
+ *  l'exécution, les PDU tracées pouvant de plus être échantillonnées
+ *  ou filtrées.
+ *
+ *  Le texte du journal n'est produit que lors du décodage de la trace.
  */
-#include <string.h>
+#include <stdlib.h>    // malloc, realloc, free
+#include <stdio.h>     // fopen, fwrite, fread, vsnprintf
+#include <string.h>    // strlen, memcpy, memset, strdup, strtok
 
-#ifdef NDES_USES_LOG
-#   define NDES_USES_LOG_IS_SET
-#else
-#   undef NDES_USES_LOG_IS_SET
+#ifdef NDES_PTHREAD
+#include <pthread.h>
 #endif
 
-#define NDES_USES_LOG // Nécessaire localement
 #include <log.h>
+#include <pdu-filter.h>
 
-#ifdef NDES_USES_LOG_IS_SET
-#   define NDES_USES_LOG
-#else
-#   undef NDES_USES_LOG
-#endif
-
+/**
+ * @brief Un enregistrement de la trace
+ *
+ * Un texte (ligne libre, nom de type) est rangé dans les
+ * enregistrements qui suivent celui qui l'annonce, dont le champ arg
+ * donne alors la longueur.
+ */
+struct ndesLogEnreg_t {
+   motSimDate_t date;  //!< Date d'occurence de l'événement
+   int          objet; //!< Identifiant de l'objet concerné
+   int          code;  //!< Code de l'événement (enum ndesLog_code_t)
+   int          arg;   //!< Paramètre de l'événement
+};
 
-#include <ndesObjectFile.h>
+/*
+ * Nombre d'enregistrements nécessaires pour ranger un texte
+ */
+#define ndesLog_nbEnregTexte(longueur) \
+   (((longueur) + sizeof(struct ndesLogEnreg_t) - 1)/sizeof(struct ndesLogEnreg_t))
 
 /**
- * @brief définition d'une entrée dans les log
+ * @brief Le texte associé à chaque code, tel que produit par le décodage
+ */
+static char * ndesLog_formats[ndesLog_nbCodes] = {
+   [ndesLog_text]      = "%s",
+   [ndesLog_type]      = "TYPE %s",
+   [ndesLog_in]        = "IN %d",
+   [ndesLog_out]       = "OUT %d",
+   [ndesLog_createdBy] = "CREATED_BY %d",
+   [ndesLog_deletedBy] = "DELETED BY %d",
+   [ndesLog_typeName]  = NULL
+};
+
+/*
+ * Lecture d'un texte de longueur donnée dans la trace. Le résultat
+ * est alloué, c'est à l'appelant de le libérer.
+ */
+static char * ndesLog_lireTexte(FILE * trace, int longueur)
+{
+   int nb = ndesLog_nbEnregTexte(longueur);
+   char * result = (char *)sim_malloc(nb*sizeof(struct ndesLogEnreg_t) + 1);
+
+   if (fread(result, sizeof(struct ndesLogEnreg_t), nb, trace) != nb) {
+      free(result);
+      return NULL;
+   }
+   result[longueur] = 0;
+
+   return result;
+}
+
+/*
+ * Décodage d'un fichier de trace
+ */
+int ndesLog_decode(char * traceFileName, char * textFileName)
+{
+   FILE * trace, * texte;
+   struct ndesLogEnreg_t e;
+   char ** noms = NULL;
+   int nbNoms = 0;
+   char * chaine;
+   int nb = 0;
+
+   trace = fopen(traceFileName, "rb");
+   if (trace == NULL) {
+      motSim_error(MS_WARN, "Ouverture de \"%s\" impossible\n", traceFileName);
+      return -1;
+   }
+
+   // Premier passage : les noms des types. Si plusieurs threads
+   // journalisent, un nom peut être écrit après son utilisation.
+   while (fread(&e, sizeof(e), 1, trace) == 1) {
+      if (e.code == ndesLog_typeName) {
+         if (e.objet >= nbNoms) {
+            noms = (char **)realloc(noms, (e.objet + 1)*sizeof(char *));
+            assert(noms);
+            memset(noms + nbNoms, 0, (e.objet + 1 - nbNoms)*sizeof(char *));
+            nbNoms = e.objet + 1;
+         }
+         noms[e.objet] = ndesLog_lireTexte(trace, e.arg);
+      } else if (e.code == ndesLog_text) {
+         fseek(trace, ndesLog_nbEnregTexte(e.arg)*sizeof(e), SEEK_CUR);
+      }
+   }
+   rewind(trace);
+
+   texte = textFileName?fopen(textFileName, "w"):stdout;
+   if (texte == NULL) {
+      motSim_error(MS_WARN, "Ouverture de \"%s\" impossible\n", textFileName);
+      fclose(trace);
+      return -1;
+   }
+
+   // Second passage : les événements, dans l'ordre de la trace
+   while (fread(&e, sizeof(e), 1, trace) == 1) {
+      if ((e.code < 0) || (e.code >= ndesLog_nbCodes)) {
+         motSim_error(MS_WARN, "Code %d inconnu dans \"%s\"\n", e.code, traceFileName);
+         nb = -1;
+         break;
+      }
+      switch (e.code) {
+         case ndesLog_typeName :
+            fseek(trace, ndesLog_nbEnregTexte(e.arg)*sizeof(e), SEEK_CUR);
+	    continue;
+         case ndesLog_text :
+            chaine = ndesLog_lireTexte(trace, e.arg);
+            fprintf(texte, "[LOG] %f %d \"%s\" !\n", e.date, e.objet, chaine?chaine:"");
+            free(chaine);
+	    break;
+         case ndesLog_type :
+            fprintf(texte, "[LOG] %f %d \"", e.date, e.objet);
+            fprintf(texte, ndesLog_formats[e.code],
+		    ((e.arg < nbNoms) && (noms[e.arg]))?noms[e.arg]:"?");
+            fprintf(texte, "\" !\n");
+	    break;
+         default :
+            fprintf(texte, "[LOG] %f %d \"", e.date, e.objet);
+            fprintf(texte, ndesLog_formats[e.code], e.arg);
+            fprintf(texte, "\" !\n");
+	    break;
+      }
+      nb++;
+   }
+
+   if (textFileName) {
+      fclose(texte);
+   }
+   fclose(trace);
+   while (nbNoms--) {
+      free(noms[nbNoms]);
+   }
+   free(noms);
+
+   return nb;
+}
+
+/*
+ * Taille d'un tampon, en nombre d'enregistrements
+ */
+#define NDESLOG_TAMPON_NB_ENREG 4096
+
+/*
+ * Nombre maximal de tampons (avec NDES_PTHREAD). Au delà, le
+ * simulateur attend que l'écrivain en libère un.
+ */
+#define NDESLOG_NB_TAMPONS_MAX 8
+
+/*
+ * Longueur maximale d'une ligne de texte libre
  */
-struct  ndesLogEntry_t {
-   declareAsNdesObject; //< C'est un ndesObject 
+#define NDESLOG_TEXTE_MAX 1024
 
-   motSimDate_t date ; //< Date d'occurence de l'événement
-   char * msg;         //< Représentation textuelle
-   struct ndesObject_t * object;  //< L'objet sur lequel se produit l'événement
+/**
+ * @brief Un tampon d'enregistrements
+ */
+struct ndesLogTampon_t {
+   int                      nb;      //!< Nombre d'enregistrements
+   struct ndesLogTampon_t * suivant; //!< Chaînage (tampons pleins ou libres)
+   struct ndesLogEnreg_t    enreg[NDESLOG_TAMPON_NB_ENREG];
 };
 
 /**
- * @brief Définition des fonctions spécifiques liées au ndesObject
+ * @brief Structure du log
  */
-defineObjectFunctions(ndesLogEntry);
+struct ndesLog_t {
+   unsigned int         echantillonnage; //!< Une PDU sur echantillonnage
+   struct PDUFilter_t * filtre;          //!< Les PDU à tracer
+   char * nomFichier;
+   FILE * fichier;   //!< Ouvert à la première écriture
+
+   // Les types dont le nom a déjà été écrit dans la trace
+   struct ndesObjectType_t ** types;
+   int    nbTypes;
+   int    nbTypesMax;
+
+   struct ndesLogTampon_t * libres; //!< Les tampons recyclés
+#ifdef NDES_PTHREAD
+   pthread_mutex_t mutex;
+   pthread_cond_t  aEcrire;    //!< Un tampon plein attend l'écrivain
+   pthread_cond_t  ecrit;      //!< L'écrivain a recyclé un tampon
+   struct ndesLogTampon_t * pleinsTete; //!< File des tampons à écrire
+   struct ndesLogTampon_t * pleinsQueue;
+   int    nbTampons;
+   int    enEcriture;          //!< L'écrivain traite un tampon
+   int    ecrivainLance;
+#endif
+};
 
 /**
- * @brief Les entrées de log sont des ndesObject
+ * Le log général
  */
-struct ndesObjectType_t ndesLogEntryType = {
-  ndesObjectTypeDefaultValues(ndesLogEntry)
+static struct ndesLog_t ndesLog = {
+   .echantillonnage = 1,
+   .filtre = NULL,
+   .nomFichier = NDESLOG_FICHIER_DEFAUT,
+   .fichier = NULL,
+   .types = NULL,
+   .nbTypes = 0,
+   .nbTypesMax = 0,
+   .libres = NULL,
+#ifdef NDES_PTHREAD
+   .mutex = PTHREAD_MUTEX_INITIALIZER,
+   .aEcrire = PTHREAD_COND_INITIALIZER,
+   .ecrit = PTHREAD_COND_INITIALIZER,
+   .pleinsTete = NULL,
+   .pleinsQueue = NULL,
+   .nbTampons = 0,
+   .enEcriture = 0,
+   .ecrivainLance = 0
+#endif
 };
 
+/**
+ * Les catégories actives
+ */
+#ifdef NDES_USES_LOG
+unsigned long ndesLog_categories = NDESLOG_ALL;
+#else
+unsigned long ndesLog_categories = NDESLOG_NONE;
+#endif
+
+/**
+ * Les noms des catégories, pour la variable NDES_LOG
+ */
+static struct {
+   char *        nom;
+   unsigned long masque;
+} ndesLog_nomsCategories[] = {
+   {"object", NDESLOG_OBJECT},
+   {"source", NDESLOG_SOURCE},
+   {"file",   NDESLOG_FILE},
+   {"srv",    NDESLOG_SRV},
+   {"sink",   NDESLOG_SINK},
+   {"sched",  NDESLOG_SCHED},
+   {"text",   NDESLOG_TEXT},
+   {"all",    NDESLOG_ALL},
+   {NULL,     NDESLOG_NONE}
+};
 
 /**
- * @brief La fonction d'allocation
+ * Le tampon en cours de remplissage, un par thread
+ */
+#ifdef NDES_PTHREAD
+static __thread struct ndesLogTampon_t * ndesLog_tampon = NULL;
+#else
+static struct ndesLogTampon_t * ndesLog_tampon = NULL;
+#endif
+
+/*
+ * Ecriture d'un tampon dans le fichier de trace
  */
-struct ndesLogEntry_t * ndesLogEntry_alloc()
+static void ndesLog_ecrire(struct ndesLogTampon_t * tampon)
 {
-   struct ndesLogEntry_t * result;
+   if (ndesLog.fichier == NULL) {
+      ndesLog.fichier = fopen(ndesLog.nomFichier, "wb");
+      if (ndesLog.fichier == NULL) {
+         motSim_error(MS_FATAL, "Ouverture de \"%s\" impossible\n", ndesLog.nomFichier);
+      }
+   }
+   if (fwrite(tampon->enreg, sizeof(struct ndesLogEnreg_t), tampon->nb, ndesLog.fichier) != tampon->nb) {
+      motSim_error(MS_FATAL, "Ecriture dans \"%s\" impossible\n", ndesLog.nomFichier);
+   }
+}
 
-   result = sim_malloc(sizeof(struct ndesLogEntry_t *));
+#ifdef NDES_PTHREAD
+/*
+ * La boucle de l'écrivain : les tampons pleins sont écrits dans
+ * l'ordre de leur soumission puis recyclés
+ */
+static void * ndesLog_ecrivain(void * arg)
+{
+   struct ndesLogTampon_t * tampon;
+
+   pthread_mutex_lock(&ndesLog.mutex);
+   while (1) {
+      while (ndesLog.pleinsTete == NULL) {
+         pthread_cond_wait(&ndesLog.aEcrire, &ndesLog.mutex);
+      }
+      tampon = ndesLog.pleinsTete;
+      ndesLog.pleinsTete = tampon->suivant;
+      if (ndesLog.pleinsTete == NULL) {
+         ndesLog.pleinsQueue = NULL;
+      }
+      ndesLog.enEcriture = 1;
+      pthread_mutex_unlock(&ndesLog.mutex);
+
+      ndesLog_ecrire(tampon);
+
+      pthread_mutex_lock(&ndesLog.mutex);
+      tampon->suivant = ndesLog.libres;
+      ndesLog.libres = tampon;
+      ndesLog.enEcriture = 0;
+      pthread_cond_broadcast(&ndesLog.ecrit);
+   }
+   return NULL;
+}
+#endif
+
+/*
+ * Obtention d'un tampon vide, recyclé si possible
+ */
+static struct ndesLogTampon_t * ndesLog_nouveauTampon()
+{
+   struct ndesLogTampon_t * result;
+
+#ifdef NDES_PTHREAD
+   pthread_mutex_lock(&ndesLog.mutex);
+   while ((ndesLog.libres == NULL) && (ndesLog.nbTampons >= NDESLOG_NB_TAMPONS_MAX)) {
+      pthread_cond_wait(&ndesLog.ecrit, &ndesLog.mutex);
+   }
+#endif
+   if (ndesLog.libres) {
+      result = ndesLog.libres;
+      ndesLog.libres = result->suivant;
+   } else {
+      result = (struct ndesLogTampon_t *)sim_malloc(sizeof(struct ndesLogTampon_t));
+      assert(result);
+#ifdef NDES_PTHREAD
+      ndesLog.nbTampons++;
+#endif
+   }
+#ifdef NDES_PTHREAD
+   pthread_mutex_unlock(&ndesLog.mutex);
+#endif
+   result->nb = 0;
+   result->suivant = NULL;
 
    return result;
 }
 
-/**
- * @brief Un créateur avec paramètres
+/*
+ * Soumission d'un tampon (plein ou non) pour écriture
  */
-struct ndesLogEntry_t * ndesLogEntry_create(struct ndesObject_t * object,
-					    char * msg)
+static void ndesLog_soumettre(struct ndesLogTampon_t * tampon)
 {
-   struct ndesLogEntry_t * result;
+#ifdef NDES_PTHREAD
+   pthread_t ecrivain;
+
+   pthread_mutex_lock(&ndesLog.mutex);
+   if (!ndesLog.ecrivainLance) {
+      if (pthread_create(&ecrivain, NULL, ndesLog_ecrivain, NULL)) {
+         motSim_error(MS_FATAL, "Création de l'écrivain du log impossible\n");
+      }
+      pthread_detach(ecrivain);
+      ndesLog.ecrivainLance = 1;
+   }
+   tampon->suivant = NULL;
+   if (ndesLog.pleinsQueue) {
+      ndesLog.pleinsQueue->suivant = tampon;
+   } else {
+      ndesLog.pleinsTete = tampon;
+   }
+   ndesLog.pleinsQueue = tampon;
+   pthread_cond_signal(&ndesLog.aEcrire);
+   pthread_mutex_unlock(&ndesLog.mutex);
+#else
+   ndesLog_ecrire(tampon);
+   tampon->suivant = ndesLog.libres;
+   ndesLog.libres = tampon;
+#endif
+}
 
-   result = ndesLogEntry_alloc();
+/*
+ * Réservation de nb enregistrements consécutifs dans le tampon du
+ * thread courant. Ils sont dans le même tampon afin qu'un texte ne
+ * soit pas entrecoupé par les tampons d'un autre thread.
+ */
+static struct ndesLogEnreg_t * ndesLog_reserver(int nb)
+{
+   struct ndesLogEnreg_t * result;
 
-   ndesObjectInit(result, ndesLogEntry);
+   assert(nb <= NDESLOG_TAMPON_NB_ENREG);
 
-   result->date = motSim_getCurrentTime();
-   result->object = object;
-   result->msg = strdup(msg);
+   if ((ndesLog_tampon) && (ndesLog_tampon->nb + nb > NDESLOG_TAMPON_NB_ENREG)) {
+      ndesLog_soumettre(ndesLog_tampon);
+      ndesLog_tampon = NULL;
+   }
+   if (ndesLog_tampon == NULL) {
+      ndesLog_tampon = ndesLog_nouveauTampon();
+   }
+   result = &(ndesLog_tampon->enreg[ndesLog_tampon->nb]);
+   ndesLog_tampon->nb += nb;
+
+   return result;
+}
+
+/*
+ * Enregistrement d'un texte
+ */
+static void ndesLog_logTexte(int objet, int code, char * texte)
+{
+   struct ndesLogEnreg_t * e;
+   int longueur = strlen(texte);
+
+   if (longueur > NDESLOG_TEXTE_MAX) {
+      longueur = NDESLOG_TEXTE_MAX;
+   }
+   e = ndesLog_reserver(1 + ndesLog_nbEnregTexte(longueur));
+   e->date = motSim_getCurrentTime();
+   e->objet = objet;
+   e->code = code;
+   e->arg = longueur;
+
+   memset(e + 1, 0, ndesLog_nbEnregTexte(longueur)*sizeof(struct ndesLogEnreg_t));
+   memcpy(e + 1, texte, longueur);
+}
+
+/*
+ * Indice d'un type dans la trace. Son nom y est écrit la première
+ * fois.
+ */
+static int ndesLog_indiceType(struct ndesObjectType_t * type)
+{
+   int result, nouveau = 0;
+
+#ifdef NDES_PTHREAD
+   pthread_mutex_lock(&ndesLog.mutex);
+#endif
+   for (result = 0; (result < ndesLog.nbTypes) && (ndesLog.types[result] != type); result++);
+   if (result == ndesLog.nbTypes) {
+      if (ndesLog.nbTypes == ndesLog.nbTypesMax) {
+         ndesLog.nbTypesMax = ndesLog.nbTypesMax?2*ndesLog.nbTypesMax:16;
+         ndesLog.types = (struct ndesObjectType_t **)realloc(ndesLog.types,
+							      ndesLog.nbTypesMax*sizeof(struct ndesObjectType_t *));
+         assert(ndesLog.types);
+      }
+      ndesLog.types[ndesLog.nbTypes++] = type;
+      nouveau = 1;
+   }
+#ifdef NDES_PTHREAD
+   pthread_mutex_unlock(&ndesLog.mutex);
+#endif
+
+   if (nouveau) {
+      ndesLog_logTexte(result, ndesLog_typeName, type->name);
+   }
 
    return result;
 }
 
 /**
- * @brief Structure du log
- * 
- * On peut en avoir plusieurs si besoin est.
+ * @brief Choix des catégories actives
  */
-struct ndesLog_t {
-   struct ndesObjectFile_t * journal; //< Liste des événements
-} ndesLog_t;
+void ndesLog_setCategories(unsigned long categories)
+{
+   ndesLog_categories = categories;
+}
 
 /**
- * Le log général
+ * @brief Les catégories actives
  */
-struct ndesLog_t * ndesLog;
+unsigned long ndesLog_getCategories()
+{
+   return ndesLog_categories;
+}
 
 /**
- * @brief Activation du log
+ * @brief Activation de toutes les catégories
  */
 void ndesLog_enable()
 {
+   ndesLog_categories = NDESLOG_ALL;
 }
 
 /**
- * @brief Désactivation du log
+ * @brief Désactivation de toutes les catégories
  */
 void ndesLog_disable()
 {
+   ndesLog_categories = NDESLOG_NONE;
 }
 
 /**
- * @brief Création d'un log
+ * @brief Echantillonnage des PDU
  */
-struct ndesLog_t * ndesLog_create()
+void ndesLog_setSampling(unsigned int n)
 {
-   struct ndesLog_t * result;
+   ndesLog.echantillonnage = n?n:1;
+}
 
-   // On crée l'objet
-   result = (struct ndesLog_t *)sim_malloc(sizeof(struct ndesLog_t));
- 
-   // Le journal est une liste de logEntry
-   result->journal = ndesObjectFile_create(&ndesLogEntryType);
+/**
+ * @brief Filtrage des PDU tracées
+ */
+void ndesLog_setPDUFilter(struct PDUFilter_t * filter)
+{
+   ndesLog.filtre = filter;
+}
+
+/**
+ * @brief La PDU doit-elle être tracée ?
+ */
+int ndesLog_samplePDU(struct PDU_t * pdu)
+{
+   if ((ndesLog.echantillonnage > 1) && (PDU_id(pdu) % ndesLog.echantillonnage)) {
+      return 0;
+   }
+   return (ndesLog.filtre == NULL) || (PDUFilter_filterPDU(ndesLog.filtre, pdu));
+}
+
+/*
+ * Lecture des catégories dans une chaîne : une liste de noms séparés
+ * par des virgules, ou un masque numérique
+ */
+static unsigned long ndesLog_lireCategories(char * chaine)
+{
+   unsigned long result;
+   char * copie, * nom, * fin;
+   int c;
+
+   result = strtoul(chaine, &fin, 0);
+   if ((fin != chaine) && (*fin == 0)) {
+      return result;
+   }
+
+   copie = strdup(chaine);
+   for (nom = strtok(copie, ","); nom; nom = strtok(NULL, ",")) {
+      for (c = 0; (ndesLog_nomsCategories[c].nom) && (strcmp(nom, ndesLog_nomsCategories[c].nom)); c++);
+      if (ndesLog_nomsCategories[c].nom) {
+         result |= ndesLog_nomsCategories[c].masque;
+      } else {
+         motSim_error(MS_WARN, "Categorie de log \"%s\" inconnue\n", nom);
+      }
+   }
+   free(copie);
 
    return result;
-};
+}
+
+/**
+ * @brief Choix du fichier de trace
+ */
+void ndesLog_setFile(char * fileName)
+{
+   if (ndesLog.fichier) {
+      motSim_error(MS_WARN, "Trace deja commencee dans \"%s\"\n", ndesLog.nomFichier);
+      return;
+   }
+   ndesLog.nomFichier = strdup(fileName);
+}
 
 /**
  * @brief Initialisation du log
+ *
+ * Les variables d'environnement sont lues à chaque invocation. Les
+ * événements encore en tampon sont écrits à la fin du programme.
  */
 void ndesLog_init()
 {
-   ndesLog = ndesLog_create();
+   static int initialise = 0;
+   char * valeur;
+
+   if ((valeur = getenv("NDES_LOG"))) {
+      ndesLog_setCategories(ndesLog_lireCategories(valeur));
+   }
+   if ((valeur = getenv("NDES_LOG_SAMPLE"))) {
+      ndesLog_setSampling(atoi(valeur));
+   }
+   if ((valeur = getenv("NDES_LOG_FILE"))) {
+      ndesLog_setFile(valeur);
+   }
+   if (!initialise) {
+      atexit(ndesLog_flush);
+      initialise = 1;
+   }
+}
+
+/**
+ * @brief Journalisation d'un événement
+ */
+void ndesLog_logEvent(struct ndesObject_t * ndesObject, int code, int arg)
+{
+   struct ndesLogEnreg_t * e;
+
+   if (code == ndesLog_type) {
+      arg = ndesLog_indiceType(ndesObject_getType(ndesObject));
+   }
+   e = ndesLog_reserver(1);
+   e->date = motSim_getCurrentTime();
+   e->objet = ndesObject_getId(ndesObject);
+   e->code = code;
+   e->arg = arg;
 }
 
 /**
@@ -143,58 +621,59 @@ void ndesLog_init()
  */
 void ndesLog_logLine(struct ndesObject_t * ndesObject, char * line)
 {
-   struct ndesLogEntry_t * le;
-
-   le = ndesLogEntry_create(ndesObject, line);
-   ndesObjectFile_insert(ndesLog->journal, le);
+   if (ndesLog_enabled(NDESLOG_TEXT)) {
+      ndesLog_logTexte(ndesObject_getId(ndesObject), ndesLog_text, line);
+   }
 }
 
 /**
- * @brief Insertion d'une ligne de log avec des ndesObject
+ * @brief Insertion d'une ligne de log avec formatage
  */
-void ndesLog_logLineF(struct ndesObject_t * ndesObject, char * fmt, ...)           
+void ndesLog_logLineF(struct ndesObject_t * ndesObject, char * fmt, ...)
 {
-   char msg[1024];
+   char msg[NDESLOG_TEXTE_MAX + 1];
    va_list args;
- 
-   printf_debug(DEBUG_ALWAYS, "Coucou IN\n");
 
+   if (!ndesLog_enabled(NDESLOG_TEXT)) {
+      return;
+   }
    va_start(args, fmt);
-   printf(fmt, args);
-   //   vsprintf(msg, fmt, args);
+   vsnprintf(msg, sizeof(msg), fmt, args);
    va_end(args);
 
    ndesLog_logLine(ndesObject, msg);
-
-   printf_debug(DEBUG_ALWAYS, "OUT (msg = \"%s\")\n", msg);
 }
 
+/**
+ * @brief Ecriture des événements du thread appelant
+ */
+void ndesLog_flush()
+{
+   if ((ndesLog_tampon) && (ndesLog_tampon->nb)) {
+      ndesLog_soumettre(ndesLog_tampon);
+      ndesLog_tampon = NULL;
+   }
+#ifdef NDES_PTHREAD
+   // On attend que l'écrivain ait tout traité
+   pthread_mutex_lock(&ndesLog.mutex);
+   while ((ndesLog.pleinsTete) || (ndesLog.enEcriture)) {
+      pthread_cond_wait(&ndesLog.ecrit, &ndesLog.mutex);
+   }
+   pthread_mutex_unlock(&ndesLog.mutex);
+#endif
+   if (ndesLog.fichier) {
+      fflush(ndesLog.fichier);
+   }
+}
 
 /*
  * Dump du log dans un fichier (l'éventuel contenu précédent est détruit)
  */
 int ndesLog_dump(char * fileName)
 {
-   struct ndesObjectFileIterator_t * ofi;
-   struct ndesObject_t             * obj;
-   struct ndesLogEntry_t           * le;
-
-   ofi = ndesObjectFile_createIterator(ndesLog->journal);
-   while ((obj = ndesObjectFile_iteratorGetNext(ofi))) {
-      assert(ndesObject_getType(obj) == &ndesLogEntryType);
-      le = ndesObject_getPrivate(obj);
-      printf("[LOG] %f %d \"%s\" !\n", le->date, ndesObject_getId(le->object), le->msg);
+   ndesLog_flush();
+   if (ndesLog.fichier == NULL) { // Rien n'a encore été journalisé
+      return 0;
    }
-   ndesObjectFile_deleteIterator(ofi);
-   
-   return -1;
+   return ndesLog_decode(ndesLog.nomFichier, fileName);
 }
-
-/*
- * @brief Définition permettant d'utiliser ndesObject pour le Log
- *
- */
-struct ndesObjectType_t ndesLog_type = {
-   .name = "log",
-   .malloc = (void * (*)())ndesLog_create
-};
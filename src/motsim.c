@@ -36,6 +36,7 @@ struct motsim_t {
 
    struct probe_t       * dureeSimulation;
    struct resetClient_t * resetClient;
+   struct resetClient_t * runClient;   // Prévenus à chaque motSim_runUntil
 };
 
 struct motsim_t * __motSim;
@@ -75,12 +76,16 @@ void mainHandler(int sig)
    }
 }
 
+/*
+ * Le message périodique est demandé par SIGALRM mais affiché par la
+ * boucle de simulation : printf n'est pas utilisable dans un
+ * gestionnaire de signal (le signal peut interrompre un malloc).
+ */
+static volatile sig_atomic_t motSim_messageDemande = 0;
+
 void periodicHandler(int sig)
 {
-   if (__motSim->currentTime<= __motSim->finishTime) {
-      motSim_periodicMessage(NULL);
-      alarm(1);
-   }
+   motSim_messageDemande = 1;
 }
 
 /*
@@ -102,12 +107,14 @@ void motSim_create()
 
    __motSim = (struct motsim_t * )sim_malloc(sizeof(struct motsim_t));
    __motSim->currentTime = 0.0;
+   __motSim->finishTime = 0.0;
 
    printf_debug(DEBUG_MOTSIM, "Initialisation du simulateur ...\n");
    __motSim->events = eventFile_create();
    __motSim->nbInsertedEvents = 0;
    __motSim->nbRanEvents = 0;
    __motSim->resetClient = NULL;
+   __motSim->runClient = NULL;
 
    printf_debug(DEBUG_MOTSIM, "gestion des signaux \n");
    // We want to close files on exit, even with ^c
@@ -230,6 +237,7 @@ void motSim_runNSimu(motSimDate_t date, int nbSimu)
 void motSim_runUntil(motSimDate_t date)
 {
    struct event_t * event;
+   struct resetClient_t * runClient;
 
    //event_periodicAdd(motSim_periodicMessage, NULL, 0.0, date/200.0);
    alarm(1);
@@ -238,6 +246,12 @@ void motSim_runUntil(motSimDate_t date)
    if (!__motSim->nbRanEvents) {
       __motSim->actualStartTime = time(NULL);
    }
+
+   // Les clients qui dépendent de la date de fin (ils peuvent insérer
+   // de nouveaux événements)
+   for (runClient = __motSim->runClient; runClient; runClient = runClient->next) {
+      runClient->resetFunc(runClient->data);
+   }
    event = eventFile_nextEvent(__motSim->events);
 
    while ((event) && (event_getDate(event) <= date)) {
@@ -248,6 +262,11 @@ void motSim_runUntil(motSimDate_t date)
       __motSim->currentTime = event_getDate(event);
       event_run(event);
       __motSim->nbRanEvents ++;
+      if (motSim_messageDemande) {
+         motSim_messageDemande = 0;
+         motSim_periodicMessage(NULL);
+         alarm(1);
+      }
       /*
 afficher le message toutes les 
       n secondes de temps réel
@@ -306,6 +325,26 @@ void motsim_addToResetList(void * data, void (*resetFunc)(void * data))
    __motSim->resetClient = resetClient;
 }
 
+/*
+ * Certains objets ont besoin de connaître la date de fin de chaque
+ * exécution (pour planifier un traitement à cette date par
+ * exemple). Ils s'enregistrent par la fonction suivante et seront
+ * invoqués au début de chaque motSim_runUntil, une fois la date de
+ * fin connue.
+ */
+void motsim_addToRunList(void * data, void (*runFunc)(void * data))
+{
+   struct resetClient_t * runClient = (struct resetClient_t *)sim_malloc(sizeof(struct resetClient_t));
+
+   assert (runClient);
+
+   runClient->next = __motSim->runClient;
+   runClient->data = data;
+   runClient->resetFunc = runFunc;
+
+   __motSim->runClient = runClient;
+}
+
 
 /*
  * Réinitialisation du simulateur pour une nouvelle
@@ -342,6 +381,11 @@ motSimDate_t motSim_getCurrentTime()
    return __motSim->currentTime;
 };
 
+motSimDate_t motSim_getFinishTime()
+{
+   return __motSim->finishTime;
+};
+
 /*
  * Initialisation puis insertion d'un evenement
  */
@@ -3,10 +3,140 @@
  * @brief A basic multiplxer/demultiplexer
  */
 
-#include <limits.h>   // UINT_MAX
+#include <stdlib.h>   // free
+#include <strings.h>  // bzero
+#include <assert.h>
 #include <muxdemux.h>
 #include <ndesObject.h>
-#include <ndesObjectFile.h>
+
+/*********************************************************************************
+            SAP TABLE
+ */
+
+/**
+ * @brief Initial size of a SAP table (a power of two)
+ */
+#define MUXDEMUX_TABLE_SIZE 64
+
+/**
+ * @brief A SAP table, indexed by SAPI
+ *
+ * An open addressing hash table with linear probing. The hash is the
+ * SAPI itself, so that the usual consecutive SAPIs are directly
+ * indexed without collision. SAPI 0 is never used and marks empty
+ * slots. The table is kept at most half full.
+ */
+struct muxDemuxTable_t {
+   unsigned int   size;      //<! Number of slots (a power of two)
+   unsigned int   nb;        //<! Number of SAPs
+   unsigned int   firstFree; //<! No free SAPI below this one
+   unsigned int * sapis;
+   void        ** saps;
+};
+
+static void muxDemuxTable_init(struct muxDemuxTable_t * t)
+{
+   t->size = MUXDEMUX_TABLE_SIZE;
+   t->nb = 0;
+   t->firstFree = 1;
+   t->sapis = (unsigned int *)sim_malloc(t->size*sizeof(unsigned int));
+   t->saps = (void **)sim_malloc(t->size*sizeof(void *));
+   bzero(t->sapis, t->size*sizeof(unsigned int));
+}
+
+/**
+ * @brief Slot of a SAPI (or of the empty slot where it should be)
+ */
+static inline unsigned int muxDemuxTable_slot(struct muxDemuxTable_t * t, unsigned int sapi)
+{
+   unsigned int n = sapi & (t->size - 1);
+
+   while ((t->sapis[n] != 0) && (t->sapis[n] != sapi)) {
+      n = (n + 1) & (t->size - 1);
+   }
+   return n;
+}
+
+/**
+ * @brief Get the SAP with a given identifier (NULL if none)
+ *
+ * SAPI 0 marks empty slots (whose SAP is not initialized), so it is
+ * never found.
+ */
+static inline void * muxDemuxTable_lookup(struct muxDemuxTable_t * t, unsigned int sapi)
+{
+   unsigned int n;
+
+   if (sapi == 0) {
+      return NULL;
+   }
+   n = muxDemuxTable_slot(t, sapi);
+
+   return (t->sapis[n] == sapi)?t->saps[n]:NULL;
+}
+
+/**
+ * @brief Insertion of a SAP whose identifier is not in use
+ */
+static void muxDemuxTable_insert(struct muxDemuxTable_t * t, unsigned int sapi, void * sap)
+{
+   unsigned int   oldSize = t->size;
+   unsigned int * oldSapis = t->sapis;
+   void        ** oldSaps = t->saps;
+   unsigned int   n;
+
+   assert(sapi != 0);
+
+   // Keep the table at most half full
+   if (2*(t->nb + 1) > t->size) {
+      t->size = 2*oldSize;
+      t->sapis = (unsigned int *)sim_malloc(t->size*sizeof(unsigned int));
+      t->saps = (void **)sim_malloc(t->size*sizeof(void *));
+      bzero(t->sapis, t->size*sizeof(unsigned int));
+      for (n = 0; n < oldSize; n++) {
+         if (oldSapis[n]) {
+            t->sapis[muxDemuxTable_slot(t, oldSapis[n])] = oldSapis[n];
+            t->saps[muxDemuxTable_slot(t, oldSapis[n])] = oldSaps[n];
+	 }
+      }
+      free(oldSapis);
+      free(oldSaps);
+   }
+
+   n = muxDemuxTable_slot(t, sapi);
+   t->sapis[n] = sapi;
+   t->saps[n] = sap;
+   t->nb++;
+}
+
+/**
+ * @brief The lowest available identifier (0 if none)
+ */
+static unsigned int muxDemuxTable_firstFreeSAPI(struct muxDemuxTable_t * t)
+{
+   while ((t->firstFree != 0) && (muxDemuxTable_lookup(t, t->firstFree))) {
+      t->firstFree++; // Wraps to 0 when every SAPI is in use
+   }
+   return t->firstFree;
+}
+
+/**
+ * @brief Choice of the identifier of a new SAP
+ * @param newSAPI The desired identifier (non zero) or unspecified
+ * (zero)
+ * @result The identifier or 0 (identifier unavailable)
+ */
+static unsigned int muxDemuxTable_chooseSAPI(struct muxDemuxTable_t * t, unsigned int newSAPI)
+{
+   if (newSAPI == 0) {
+      return muxDemuxTable_firstFreeSAPI(t);
+   }
+   return muxDemuxTable_lookup(t, newSAPI)?0:newSAPI;
+}
+
+/*********************************************************************************
+            SENDER SIDE
+ */
 
 /**
  * @brief A multiplexing sender
@@ -16,7 +146,7 @@ struct muxDemuxSender_t {
    void * destination;
    processPDU_t destProcessPDU;
 
-   struct ndesObjectFile_t * sapList; //<! Sorted in ascending identifier
+   struct muxDemuxTable_t saps; //<! The SAPs, by identifier
 };
 
 /**
@@ -43,35 +173,58 @@ struct ndesObjectType_t  muxDemuxSenderSAPType = {
    ndesObjectTypeDefaultValues(muxDemuxSenderSAP)
 };
 
-#define SAPI_MAGIC_NB ((long long unsigned)684253148796258036)
-//#define SAPI_MAGIC_NB ((long long unsigned)48324832)
-
 /**
  * @brief An encapsulation structure
+ *
+ * It is the private data of the encapsulating PDU, and is released
+ * with it (see PDU_setPrivateFree). This is also how encapsulating
+ * PDUs are recognized.
  */
 struct muxDemuxEncaps_t {
-   unsigned long long magic;  // WARNING to remove
+   struct PDU_t * pdu; //<! First field, used by the free list
    unsigned int sapi;
-   struct PDU_t * pdu;
 };
 
-struct muxDemuxEncaps_t * muxDemuxEncaps_create(struct muxDemuxSenderSAP_t * sap,
-						struct PDU_t * pdu)
+/**
+ * @brief Encapsulation structures are recycled by their type
+ */
+struct ndesObjectType_t muxDemuxEncapsType = {
+   .name = "muxDemuxEncaps",
+   .size = sizeof(struct muxDemuxEncaps_t)
+};
+
+/**
+ * @brief Release of an encapsulation, with the encapsulating PDU
+ *
+ * The encapsulated PDU, if it has not been delivered, is released
+ * too.
+ */
+void muxDemuxEncaps_delete(void * e)
+{
+   struct muxDemuxEncaps_t * encaps = (struct muxDemuxEncaps_t *)e;
+
+   PDU_free(encaps->pdu);
+   ndesObjectType_release(&muxDemuxEncapsType, encaps);
+}
+
+/**
+ * @brief Encapsulation of a PDU in a new PDU (overheadless)
+ */
+struct PDU_t * muxDemuxEncaps_create(struct muxDemuxSenderSAP_t * sap,
+				     struct PDU_t * pdu)
 {
-   struct muxDemuxEncaps_t * result = (struct muxDemuxEncaps_t * )sim_malloc(sizeof(struct muxDemuxEncaps_t ));
+   struct muxDemuxEncaps_t * encaps = (struct muxDemuxEncaps_t *)ndesObjectType_alloc(&muxDemuxEncapsType);
+   struct PDU_t * result;
 
    printf_debug(DEBUG_MUX, "IN for PDU %d in SAPI %d\n", PDU_id(pdu), sap->identifier);
 
-   result->magic = SAPI_MAGIC_NB;
-   result->sapi = sap->identifier;
-   result->pdu = pdu;
+   encaps->sapi = sap->identifier;
+   encaps->pdu = pdu;
 
-   return result;
-}
+   result = PDU_create(PDU_size(pdu), encaps);
+   PDU_setPrivateFree(result, muxDemuxEncaps_delete);
 
-void muxDemuxEncaps_delete(struct muxDemuxEncaps_t * encaps)
-{
-   free(encaps);
+   return result;
 }
 
 /**
@@ -84,7 +237,7 @@ struct muxDemuxSender_t * muxDemuxSender_create(void * destination,
 
    result->destination = destination;
    result->destProcessPDU = destProcessPDU;
-   result->sapList = ndesObjectFile_create(&muxDemuxSenderSAPType);
+   muxDemuxTable_init(&result->saps);
  
    return result;
 }
@@ -99,37 +252,13 @@ struct muxDemuxSender_t * muxDemuxSender_create(void * destination,
 struct muxDemuxSenderSAP_t * muxDemuxSender_createNewSAP(struct muxDemuxSender_t * sender,
 							 unsigned int newSAPI)
 {
-   unsigned int nextSAPI = 1;
-
-   struct ndesObjectFileIterator_t *i;
-   struct muxDemuxSenderSAP_t * s; //!< For iteration
-   struct muxDemuxSenderSAP_t * p; //!< The SAP after which to insert
    struct muxDemuxSenderSAP_t * result = NULL;
 
    // If the chosen SAPI is non zero, we check for its availability,
    // else we search the next available value. 
-   i = ndesObjectFile_createIterator(sender->sapList);
-   s = (struct muxDemuxSenderSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   while (s != NULL) {
-      // Looking for an available identifier
-      if (s->identifier == nextSAPI) {
-         if (nextSAPI == UINT_MAX) {
-            ndesObjectFile_deleteIterator(i);
-            return NULL;
-  	 }
-         nextSAPI++;
-      }
-      // Aborting on "collisions"
-      if ((newSAPI != 0) && (s->identifier == newSAPI)) {
-	 ndesObjectFile_deleteIterator(i);
-         return NULL;
-      }
-      s = (struct muxDemuxSenderSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   }
-   ndesObjectFile_deleteIterator(i);
-   // The new SAP can be created
+   newSAPI = muxDemuxTable_chooseSAPI(&sender->saps, newSAPI);
    if (newSAPI == 0) {
-      newSAPI = nextSAPI;
+      return NULL;
    }
 
    // Creation and initialisation
@@ -140,22 +269,9 @@ struct muxDemuxSenderSAP_t * muxDemuxSender_createNewSAP(struct muxDemuxSender_t
    result->srcGet = NULL;
    ndesObjectInit(result, muxDemuxSenderSAP);
 
-   // Now we search for its position within the file
-   p = NULL; // A priori it is the first
-   i = ndesObjectFile_createIterator(sender->sapList);
-   s = (struct muxDemuxSenderSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   while ((s != NULL) && (s->identifier < newSAPI)) {
-      p=s;
-      s = (struct muxDemuxSenderSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   } 
-   ndesObjectFile_deleteIterator(i);
-
    // Insertion
-   if (p) {
-      ndesObjectFile_insertAfter(sender->sapList, p, result);
-   } else {
-      ndesObjectFile_insert(sender->sapList, result);
-   }
+   muxDemuxTable_insert(&sender->saps, newSAPI, result);
+
    return result;
 }
 
@@ -166,7 +282,6 @@ struct PDU_t * muxDemuxSender_getPDU(void * s)
 {
    struct PDU_t * pdu, * pduEnc;
    struct muxDemuxSenderSAP_t * sap = (struct muxDemuxSenderSAP_t * )s;
-   struct muxDemuxEncaps_t * encaps;
 
    printf_debug(DEBUG_MUX, "IN\n");
 
@@ -179,10 +294,7 @@ struct PDU_t * muxDemuxSender_getPDU(void * s)
    pdu = sap->srcGet(sap->src);
 
    // Encapsulation (overheadless)
-   encaps = muxDemuxEncaps_create(sap, pdu);
-
-   // Embed this in a PDU
-   pduEnc = PDU_create(PDU_size(pdu), encaps);
+   pduEnc = muxDemuxEncaps_create(sap, pdu);
    printf_debug(DEBUG_MUX, "OUT (encapsulated in PDU %d)\n", PDU_id(pduEnc));
 
    return pduEnc;
@@ -224,14 +336,10 @@ int muxDemuxSender_processPDU(void * receiver,
 int muxDemuxSender_pduMatchesSAP(void* s, struct PDU_t * pdu)
 {
    struct muxDemuxSenderSAP_t * sap = (struct muxDemuxSenderSAP_t *)s;
-   struct muxDemuxEncaps_t * encaps = (struct muxDemuxEncaps_t * ) PDU_private(pdu);
-   
-   printf_debug(DEBUG_MUX, "IN (magic (%llu %llu) %s) PDU %d\n", encaps->magic,  SAPI_MAGIC_NB, (encaps->magic == SAPI_MAGIC_NB)?"Yes":"NO", PDU_id(pdu));
-   if (encaps->magic == SAPI_MAGIC_NB) {
-     printf_debug(DEBUG_MUX, "Match (%d/%d): %s\n", encaps->sapi, sap->identifier, (encaps->sapi == sap->identifier)?"Yes":"NO");
-   }
 
-   return ((encaps->magic == SAPI_MAGIC_NB) && (encaps->sapi == sap->identifier));
+   // Only encapsulating PDUs have this release function
+   return (PDU_getPrivateFree(pdu) == muxDemuxEncaps_delete)
+      && (((struct muxDemuxEncaps_t *)PDU_private(pdu))->sapi == sap->identifier);
 }
 
 /**
@@ -257,7 +365,7 @@ struct PDUFilter_t * muxDemuxSender_createFilterFromSAP(struct muxDemuxSenderSAP
  * @brief A demultiplexing receiver
  */
 struct muxDemuxReceiver_t {
-   struct ndesObjectFile_t * sapList; //<! Sorted in ascending identifier
+   struct muxDemuxTable_t saps; //<! The SAPs, by identifier
 };
 
 /**
@@ -292,7 +400,7 @@ struct muxDemuxReceiver_t * muxDemuxReceiver_create()
 {
    struct muxDemuxReceiver_t * result = (struct muxDemuxReceiver_t *)sim_malloc(sizeof(struct muxDemuxReceiver_t ));
 
-   result->sapList = ndesObjectFile_create(&muxDemuxReceiverSAPType);
+   muxDemuxTable_init(&result->saps);
  
    return result;
 }
@@ -309,45 +417,15 @@ struct muxDemuxReceiverSAP_t * muxDemuxReceiver_createNewSAP(struct muxDemuxRece
 							     void * destination,
 							     processPDU_t destProcessPDU)
 {
-   unsigned int nextSAPI = 1;
-
-   struct ndesObjectFileIterator_t * i;
-   struct muxDemuxReceiverSAP_t * s; //!< For iteration
-   struct muxDemuxReceiverSAP_t * p; //!< The SAP after which to insert
    struct muxDemuxReceiverSAP_t * result = NULL;
 
    printf_debug(DEBUG_MUX, "IN\n");
 
    // If the chosen SAPI is non zero, we check for its availability,
    // else we search the next available value. 
-   i = ndesObjectFile_createIterator(receiver->sapList);
-   printf_debug(DEBUG_MUX, "STEADY\n");
-   s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   printf_debug(DEBUG_MUX, "GO\n");
-   while (s != NULL) {
-     printf_debug(DEBUG_MUX, "id %d\n", s->identifier);
-      // Looking for an available identifier
-      if (s->identifier == nextSAPI) {
-         if (nextSAPI == UINT_MAX) {
-            ndesObjectFile_deleteIterator(i);
-            return NULL;
-  	 }
-         nextSAPI++;
-      }
-      // Aborting on "collisions"
-      if ((newSAPI != 0) && (s->identifier == newSAPI)) {
-	 ndesObjectFile_deleteIterator(i);
-         return NULL;
-      }
-      s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   }
-   printf_debug(DEBUG_MUX, "DONE\n");
-   ndesObjectFile_deleteIterator(i);
-   printf_debug(DEBUG_MUX, "Search over\n");
-
-   // The new SAP can be created
+   newSAPI = muxDemuxTable_chooseSAPI(&receiver->saps, newSAPI);
    if (newSAPI == 0) {
-      newSAPI = nextSAPI;
+      return NULL;
    }
    printf_debug(DEBUG_MUX, "newSAPI %d\n", newSAPI);
 
@@ -362,25 +440,8 @@ struct muxDemuxReceiverSAP_t * muxDemuxReceiver_createNewSAP(struct muxDemuxRece
 
    printf_debug(DEBUG_MUX, "Created\n");
 
-   // Now we search for its position within the file
-   p = NULL; // A priori it is the first
-   i = ndesObjectFile_createIterator(receiver->sapList);
-   s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   while ((s != NULL) && (s->identifier < newSAPI)) {
-      p=s;
-      s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   } 
-   ndesObjectFile_deleteIterator(i);
-   printf_debug(DEBUG_MUX, "Ready to insert\n");
-
    // Insertion
-   if (p) {
-      printf_debug(DEBUG_MUX, "After\n");
-      ndesObjectFile_insertAfter(receiver->sapList, p, result);
-   } else {
-      printf_debug(DEBUG_MUX, "First\n");
-      ndesObjectFile_insert(receiver->sapList, result);
-   }
+   muxDemuxTable_insert(&receiver->saps, newSAPI, result);
    printf_debug(DEBUG_MUX, "OUT\n");
 
    return result;
@@ -412,9 +473,8 @@ int muxDemuxReceiver_processPDU(void * rcv,
    struct muxDemuxReceiver_t       * receiver = (struct muxDemuxReceiver_t    *)rcv;
    struct muxDemuxReceiverSAP_t    * s;
    struct muxDemuxEncaps_t         * encaps;
-   struct ndesObjectFileIterator_t * i;
-   int sapi;
-   struct PDU_t * pdu;
+   unsigned int sapi;
+   struct PDU_t * pdu, * inner;
    int result;
 
    printf_debug(DEBUG_MUX, "IN\n");
@@ -429,25 +489,25 @@ int muxDemuxReceiver_processPDU(void * rcv,
    pdu = getPDU(source);
    printf_debug(DEBUG_MUX, "got the PDU\n");
 
-   // De-encapsulation
+   // De-encapsulation. The encapsulating PDU is no longer needed, it
+   // is released with the encapsulation
    encaps = (struct muxDemuxEncaps_t*)PDU_private(pdu);
    sapi = encaps->sapi;
+   inner = encaps->pdu;
+   encaps->pdu = NULL;
+   PDU_free(pdu);
 
    // Then we need to find the output SAP
-   i = ndesObjectFile_createIterator(receiver->sapList);
-   s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   while ((s != NULL) && (s->identifier != sapi)) {
-      s = (struct muxDemuxReceiverSAP_t *)ndesObjectFile_iteratorGetNext(i);
-   } 
-   ndesObjectFile_deleteIterator(i);
-
-   if ((s == NULL) || (s->identifier != sapi)) {
+   s = (struct muxDemuxReceiverSAP_t *)muxDemuxTable_lookup(&receiver->saps, sapi);
+
+   if (s == NULL) {
       motSim_error(MS_WARN, "SAPI not found\n");
+      PDU_free(inner);
       return 0;
    }
 
    // Prepare the context for getPDU
-   s->pdu = encaps->pdu;
+   s->pdu = inner;
 
    // Let the destination process the PDU
    printf_debug(DEBUG_MUX, "Let the destination process\n");
@@ -1,10 +1,44 @@
+#include <stdlib.h>    // free
+#include <stdio.h>     // printf
 #include <string.h>    // memset
+#include <assert.h>
  
 #include <ndesObject.h>
 #include <log.h>
 
 static int ndesObject_nb = 0;
 
+/*
+ * Les ndesObject sont alloués par blocs de NDESOBJECT_NB_PAR_BLOC et
+ * recyclés. Les ndesObject libres sont chaînés par leur champ data.
+ */
+#define NDESOBJECT_NB_PAR_BLOC 256
+
+static struct ndesObject_t * ndesObject_libres = NULL;
+
+/*
+ * Obtention d'un ndesObject libre
+ */
+static struct ndesObject_t * ndesObject_alloc()
+{
+   struct ndesObject_t * result;
+   int n;
+
+   if (ndesObject_libres == NULL) {
+      result = (struct ndesObject_t *)sim_malloc(NDESOBJECT_NB_PAR_BLOC*sizeof(struct ndesObject_t));
+      assert(result);
+      for (n = 0; n < NDESOBJECT_NB_PAR_BLOC - 1; n++) {
+         result[n].data = &(result[n + 1]);
+      }
+      result[NDESOBJECT_NB_PAR_BLOC - 1].data = NULL;
+      ndesObject_libres = result;
+   }
+   result = ndesObject_libres;
+   ndesObject_libres = (struct ndesObject_t *)result->data;
+
+   return result;
+}
+
 /*-----------------------------------------------------------------------
  * Les fonctions de manipulation des ndesObject
  *-----------------------------------------------------------------------
@@ -14,7 +48,7 @@ struct ndesObject_t * ndesObject_create(void * private,
 {
    struct ndesObject_t * result;
 
-   result = (struct ndesObject_t *)sim_malloc(sizeof(struct ndesObject_t));
+   result = ndesObject_alloc();
 
    result->id = ndesObject_nb++;
    result->name = NULL;
@@ -27,13 +61,29 @@ struct ndesObject_t * ndesObject_create(void * private,
 		result,
 		result->id,
                 result->type->name);
-   if (result->type != &ndesLogEntryType) {
-      ndesLog_logLineF(result, "TYPE %s", result->type->name);
-   };
+   ndesLog_trace(NDESLOG_OBJECT, result, ndesLog_type, 0);
 
    return result;
 }
 
+/**
+ * @brief Destruction d'un ndesObject.
+ *
+ * Le ndesObject est rendu au stock commun, il ne doit plus être
+ * utilisé.
+ */
+void ndesObject_free(struct ndesObject_t * ndesObject)
+{
+   if (ndesObject) {
+      printf_debug(DEBUG_OBJECT, "ndesObject %p (id %d) freed\n", ndesObject, ndesObject->id);
+      free(ndesObject->name);
+      ndesObject->name = NULL;
+      ndesObject->type = NULL;
+      ndesObject->data = ndesObject_libres;
+      ndesObject_libres = ndesObject;
+   }
+}
+
 /**
  * @brief Obtention de l'identifiant d'un ndesObject
  */
@@ -61,6 +111,60 @@ struct ndesObjectType_t * ndesObject_getType(struct ndesObject_t * ndesObject)
    return ndesObject->type;
 }
 
+/*-----------------------------------------------------------------------
+ * Le stock d'instances de chaque type
+ *-----------------------------------------------------------------------
+ */
+
+/**
+ * @brief Obtention d'une instance d'un type
+ *
+ * Les instances libres sont chaînées par leur premier champ.
+ */
+void * ndesObjectType_alloc(struct ndesObjectType_t * ndesObjectType)
+{
+   void * result;
+
+   if (ndesObjectType->next) {
+      result = ndesObjectType->next;
+      ndesObjectType->next = ((void **)result)[0];
+      ndesObjectType->nbFree--;
+   } else {
+      result = sim_malloc(ndesObjectType->size);
+      assert(result);
+      ndesObjectType->nbMalloc++;
+   }
+   ndesObjectType->nbInUse++;
+
+   return result;
+}
+
+/**
+ * @brief Libération d'une instance d'un type
+ */
+void ndesObjectType_release(struct ndesObjectType_t * ndesObjectType, void * ob)
+{
+   assert(ndesObjectType->nbInUse > 0);
+
+   ((void **)ob)[0] = ndesObjectType->next;
+   ndesObjectType->next = ob;
+   ndesObjectType->nbInUse--;
+   ndesObjectType->nbFree++;
+}
+
+/**
+ * @brief Affichage de l'occupation du stock d'un type
+ */
+void ndesObjectType_printStats(struct ndesObjectType_t * ndesObjectType)
+{
+   printf("[OBJCT] %s : %lu in use, %lu free, %lu mallocd (%lu bytes)\n",
+	  ndesObjectType->name,
+	  ndesObjectType->nbInUse,
+	  ndesObjectType->nbFree,
+	  ndesObjectType->nbMalloc,
+	  ndesObjectType->nbMalloc*ndesObjectType->size);
+}
+
 /*-----------------------------------------------------------------------
  * Les fonctions par défaut
  *-----------------------------------------------------------------------
@@ -75,12 +179,7 @@ void * ndesObject_defaultMalloc(struct ndesObjectType_t * ndesObjectType)
 
    printf_debug(DEBUG_OBJECT, "IN\n");
 
-   if (ndesObjectType->next){
-      printf("ERREUR Gestion de mémoire à faire ...\n");
-      exit(1);
-   } else {
-      result = sim_malloc(ndesObjectType->size);
-   }
+   result = ndesObjectType_alloc(ndesObjectType);
 
    printf_debug(DEBUG_OBJECT, "OUT\n");
 
@@ -111,10 +210,21 @@ void ndesObject_defaultInit(void * ob)
 
 /**
  * @brief Libération générique d'un objet
+ *
+ * Le ndesObject est rendu au stock commun et l'objet au stock de son
+ * type.
  */
 void ndesObject_defaultFree(void * ob)
 {
-   motSim_error(MS_FATAL, "pas implantée");
+   struct ndesObject_t * ndesObject = ndesObject_defaultGetObject(ob);
+   struct ndesObjectType_t * ndesObjectType = ndesObject->type;
+
+   printf_debug(DEBUG_OBJECT, "IN\n");
+
+   ndesObject_free(ndesObject);
+   ndesObjectType_release(ndesObjectType, ob);
+
+   printf_debug(DEBUG_OBJECT, "OUT\n");
 }
 
 /**
@@ -161,7 +271,7 @@ void * ndesObject_createObject(struct ndesObjectType_t * ndesObjectType)
    printf_debug(DEBUG_OBJECT, "IN\n");
 
    // Allocation avec la fonction spécifique
-   result = ndesObjectType->malloc(ndesObjectType->size);
+   result = ndesObjectType->malloc(ndesObjectType);
 
    // Création du ndesObject
    ndesObjectType->setObject(result,
@@ -176,6 +286,16 @@ void * ndesObject_createObject(struct ndesObjectType_t * ndesObjectType)
 }
 
 
+/**
+ * @brief Destruction d'un objet créé par ndesObject_createObject
+ */
+void ndesObject_freeObject(void * ob)
+{
+   struct ndesObject_t * ndesObject = ndesObject_defaultGetObject(ob);
+
+   ndesObject->type->free(ob);
+}
+
 /*
 void ndesObject_addType(char * name, struct ndesTypeHelper_t * helper)
 {
@@ -70,7 +70,7 @@ int PDUSink_processPDU(void * s, getPDU_t getPDU, void * source)
    }
 
    if (pdu) {
-      ndesLog_logLineF(PDU_getObject(pdu), "IN %d", PDUSink_getObjectId(s));
+      ndesLog_tracePDU(NDESLOG_SINK, pdu, ndesLog_in, PDUSink_getObjectId(s));
 
       PDU_free(pdu);
    }
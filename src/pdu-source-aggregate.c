@@ -0,0 +1,291 @@
+/**
+ * @file pdu-source-aggregate.c
+ *
+ * @brief Agrégat de sources de PDU.
+ *
+ *   Les prochaines dates des flots sont rangées dans un tas binaire
+ *   (le plus petit en tête). Seule la date de tête fait l'objet d'un
+ *   événement dans le simulateur. A chaque événement, le flot de tête
+ *   produit sa PDU, tire sa prochaine date et redescend dans le tas.
+ *
+ *   Comme pour la PDUSource, lorsqu'une PDU est produite, elle est
+ *   fournie immédiatement à la destination. Si celle-ci ne la consomme
+ *   pas, elle RESTE DISPONIBLE jusqu'à la production de la suivante.
+ */
+#include <stdlib.h>    // Malloc, NULL, exit...
+#include <assert.h>
+
+#include <event.h>
+#include <pdu-source-aggregate.h>
+
+#include <log.h>
+
+/**
+ * @brief Un flot de l'agrégat
+ */
+struct PDUSourceAggregateFlow_t {
+   struct dateGenerator_t * dateGen; //!< Le générateur de date du flot
+   motSimDate_t nextDate;   //!< Date de la prochaine PDU
+   unsigned long nbPDU;     //!< Nombre de PDUs produites
+   unsigned long volume;    //!< Volume produit (en octets)
+};
+
+/**
+ * @brief Un agrégat de sources de PDU
+ */
+struct PDUSourceAggregate_t {
+   declareAsNdesObject;  //!< C'est un ndesObject
+
+   int nbFlows;          //!< Nombre de flots
+   struct PDUSourceAggregateFlow_t * flow; //!< Les flots
+   int * heap;           //!< Tas des numéros de flots, par date croissante
+
+   struct randomGenerator_t * sizeGen;//!< Le générateur de taille
+
+   void * destination; //!< L'objet auquel sont destinées les PDUs
+   processPDU_t destProcessPDU; //!< La fonction permettant de signaler la présence de la PDU
+
+   struct probe_t *  PDUGenerationSizeProbe; //!< Une sonde sur la taille des PDU produites
+   struct PDU_t * pdu;   //!< La dernière PDU créée en cours d'émission
+   int currentFlow;      //!< Le flot de cette PDU
+};
+
+/**
+ * @brief Définition des fonctions spécifiques liées au ndesObject
+ */
+defineObjectFunctions(PDUSourceAggregate);
+struct ndesObjectType_t PDUSourceAggregateType = {
+  ndesObjectTypeDefaultValues(PDUSourceAggregate)
+};
+
+/*
+ * Le flot a est-il prioritaire sur le flot b ? A date égale, le plus
+ * petit numéro passe devant, pour que le résultat soit reproductible.
+ */
+#define flowBefore(agg, a, b)                                       \
+   (((agg)->flow[a].nextDate < (agg)->flow[b].nextDate)              \
+    || (((agg)->flow[a].nextDate == (agg)->flow[b].nextDate) && ((a) < (b))))
+
+/*
+ * Redescente de l'élément d'indice i dans le tas
+ */
+static void PDUSourceAggregate_siftDown(struct PDUSourceAggregate_t * agg, int i)
+{
+   int f = agg->heap[i];
+   int c;
+
+   while ((c = 2*i + 1) < agg->nbFlows) {
+      if ((c + 1 < agg->nbFlows) && flowBefore(agg, agg->heap[c+1], agg->heap[c])) {
+         c++;
+      }
+      if (!flowBefore(agg, agg->heap[c], f)) {
+         break;
+      }
+      agg->heap[i] = agg->heap[c];
+      i = c;
+   }
+   agg->heap[i] = f;
+}
+
+struct PDUSourceAggregate_t * PDUSourceAggregate_create(int nbFlows,
+                                     struct dateGenerator_t * dateGen,
+                                     void * destination,
+                                     processPDU_t destProcessPDU)
+{
+   struct PDUSourceAggregate_t * result = (struct PDUSourceAggregate_t *)
+              sim_malloc(sizeof(struct PDUSourceAggregate_t));
+   int f;
+
+   assert(nbFlows > 0);
+
+   ndesObjectInit(result, PDUSourceAggregate);
+
+   result->nbFlows = nbFlows;
+   result->flow = (struct PDUSourceAggregateFlow_t *)
+              sim_malloc(nbFlows*sizeof(struct PDUSourceAggregateFlow_t));
+   result->heap = (int *)sim_malloc(nbFlows*sizeof(int));
+   for (f = 0; f < nbFlows; f++) {
+      result->flow[f].dateGen = dateGen;
+      result->flow[f].nextDate = 0.0;
+      result->flow[f].nbPDU = 0;
+      result->flow[f].volume = 0;
+      result->heap[f] = f;
+   }
+
+   result->sizeGen = NULL;
+   result->destination = destination;
+   result->destProcessPDU = destProcessPDU;
+   result->PDUGenerationSizeProbe = NULL;
+   result->pdu = NULL;
+   result->currentFlow = -1;
+
+   // Ajout à la liste des choses à réinitialiser avant une prochaine simu
+   motsim_addToResetList(result, (void (*)(void *))PDUSourceAggregate_start);
+
+   printf_debug(DEBUG_SRC, "%d flows, dest=%p\n", nbFlows, destination);
+
+   return result;
+}
+
+/*
+ * Choix du générateur de date d'un flot
+ */
+void PDUSourceAggregate_setFlowDateGenerator(struct PDUSourceAggregate_t * agg,
+                                             int flow,
+                                             struct dateGenerator_t * dateGen)
+{
+   assert((flow >= 0) && (flow < agg->nbFlows));
+
+   agg->flow[flow].dateGen = dateGen;
+}
+
+/*
+ * Spécification du générateur de taille de PDU associé
+ */
+void PDUSourceAggregate_setPDUSizeGenerator(struct PDUSourceAggregate_t * agg,
+                                            struct randomGenerator_t * rg)
+{
+   agg->sizeGen = rg;
+}
+
+/*
+ * Positionnement d'une sonde sur la taille des PDUs produites
+ */
+void PDUSourceAggregate_addPDUGenerationSizeProbe(struct PDUSourceAggregate_t * agg,
+                                                  struct probe_t * probe)
+{
+   agg->PDUGenerationSizeProbe = probe_chain(probe, agg->PDUGenerationSizeProbe);
+}
+
+/*
+ * Programmation de l'événement correspondant à la tête du tas
+ */
+static void PDUSourceAggregate_scheduleNext(struct PDUSourceAggregate_t * agg);
+
+/** @brief Emission de la PDU du flot de tête
+ * 
+ * C'est cette fonction qui est invoquée par l'unique événement de
+ * l'agrégat. Le flot de tête produit sa PDU, on lui attribue sa
+ * prochaine date puis on programme l'événement de la nouvelle tête.
+ */
+static void PDUSourceAggregate_buildNewPDU(struct PDUSourceAggregate_t * agg)
+{
+   int f = agg->heap[0];
+   unsigned int size;
+
+   printf_debug(DEBUG_SRC, " IN (flow %d)\n", f);
+
+   // Suppression de la PDU précédente si pas consommée
+   if (agg->pdu) {
+      printf_debug(DEBUG_SRC, " Destruction de %d\n", PDU_id(agg->pdu));
+      PDU_free(agg->pdu);
+   }
+
+   size = agg->sizeGen?randomGenerator_getNextUInt(agg->sizeGen):0;
+   agg->pdu = PDU_create(size, NULL);
+   agg->currentFlow = f;
+
+   agg->flow[f].nbPDU++;
+   agg->flow[f].volume += size;
+
+   if (agg->PDUGenerationSizeProbe) {
+      probe_sample(agg->PDUGenerationSizeProbe, (double)size);
+   }
+
+   // Le flot tire sa prochaine date et reprend sa place dans le tas
+   agg->flow[f].nextDate = dateGenerator_nextDate(agg->flow[f].dateGen,
+                                                  motSim_getCurrentTime());
+   PDUSourceAggregate_siftDown(agg, 0);
+   PDUSourceAggregate_scheduleNext(agg);
+
+   // On passe la PDU au suivant  
+   if ((agg->destProcessPDU) && (agg->destination)) {
+      ndesLog_tracePDU(NDESLOG_SOURCE, agg->pdu,
+                       ndesLog_createdBy, PDUSourceAggregate_getObjectId(agg));
+      (void)agg->destProcessPDU(agg->destination,
+                                (getPDU_t)PDUSourceAggregate_getPDU,
+                                agg);
+   }
+
+   printf_debug(DEBUG_SRC, " OUT\n");
+}
+
+static void PDUSourceAggregate_scheduleNext(struct PDUSourceAggregate_t * agg)
+{
+   motSim_addEvent(event_create((eventAction_t)PDUSourceAggregate_buildNewPDU,
+                                agg,
+                                agg->flow[agg->heap[0]].nextDate));
+}
+
+/*
+ * The function used by the destination to actually get the next PDU
+ */
+struct PDU_t * PDUSourceAggregate_getPDU(void * src)
+{
+   struct PDUSourceAggregate_t * agg = (struct PDUSourceAggregate_t *)src;
+   struct PDU_t * pdu = agg->pdu;
+
+   agg->pdu = NULL;
+
+   printf_debug(DEBUG_SRC, "releasing PDU %d (flow %d)\n",
+                PDU_id(pdu), agg->currentFlow);
+
+   ndesLog_tracePDU(NDESLOG_SOURCE, pdu, ndesLog_out, PDUSourceAggregate_getObjectId(agg));
+
+   return pdu;
+}
+
+/*
+ * Démarrage (et reset) : chaque flot tire sa première date, puis le
+ * tas est construit.
+ */
+void PDUSourceAggregate_start(struct PDUSourceAggregate_t * agg)
+{
+   int f;
+
+   if (agg->pdu) {
+      PDU_free(agg->pdu);
+      agg->pdu = NULL;
+   }
+   agg->currentFlow = -1;
+
+   for (f = 0; f < agg->nbFlows; f++) {
+      assert(agg->flow[f].dateGen);
+      agg->flow[f].nextDate = dateGenerator_nextDate(agg->flow[f].dateGen,
+                                                     motSim_getCurrentTime());
+      agg->flow[f].nbPDU = 0;
+      agg->flow[f].volume = 0;
+      agg->heap[f] = f;
+   }
+   for (f = agg->nbFlows/2 - 1; f >= 0; f--) {
+      PDUSourceAggregate_siftDown(agg, f);
+   }
+
+   PDUSourceAggregate_scheduleNext(agg);
+}
+
+int PDUSourceAggregate_getNbFlows(struct PDUSourceAggregate_t * agg)
+{
+   return agg->nbFlows;
+}
+
+int PDUSourceAggregate_getCurrentFlow(struct PDUSourceAggregate_t * agg)
+{
+   return agg->currentFlow;
+}
+
+unsigned long PDUSourceAggregate_getFlowNbPDU(struct PDUSourceAggregate_t * agg,
+                                              int flow)
+{
+   assert((flow >= 0) && (flow < agg->nbFlows));
+
+   return agg->flow[flow].nbPDU;
+}
+
+unsigned long PDUSourceAggregate_getFlowVolume(struct PDUSourceAggregate_t * agg,
+                                               int flow)
+{
+   assert((flow >= 0) && (flow < agg->nbFlows));
+
+   return agg->flow[flow].volume;
+}
@@ -9,6 +9,10 @@
  *
  */
 #include <stdlib.h>    // Malloc, NULL, exit...
+#include <stdio.h>     // FILE, fread, ...
+#include <string.h>    // strchr
+
+#include <assert.h>
 
 #include <event.h>
 #include <pdu-source.h>
@@ -32,6 +36,42 @@ struct PDUSource_t {
 
    struct dateSize * sequence; //!< Pour le cas déterministe
    int detNextIdx; //!< Prochain indice dans le cas déterministe
+
+   struct PDUSourceTrace_t * trace; //!< Pour le rejeu d'une trace
+};
+
+/**
+ * @brief Nombre d'enregistrements lus à chaque accès au fichier
+ */
+#define PDU_SOURCE_TRACE_BUFFER_LENGTH 4096
+
+/**
+ * @brief Destination d'un flot de la trace
+ */
+struct PDUSourceFlowDest_t {
+   void * destination;
+   processPDU_t destProcessPDU;
+};
+
+/**
+ * @brief Le lecteur d'une trace
+ */
+struct PDUSourceTrace_t {
+   FILE * file;
+   int format;
+   struct PDUTraceRecord_t buffer[PDU_SOURCE_TRACE_BUFFER_LENGTH];
+   int pos;                 //!< Prochain enregistrement du tampon
+   int nb;                  //!< Nombre d'enregistrements du tampon
+
+   motSimDate_t firstDate;  //!< Date du premier enregistrement
+   motSimDate_t timeShift;  //!< Date d'émission du premier enregistrement
+   motSimDate_t loopPeriod; //!< Durée d'un tour (<= 0 : pas de boucle)
+   motSimDate_t offset;     //!< Décalage appliqué au tour courant
+
+   unsigned int nbFlows;    //!< Taille de la table des flots
+   struct PDUSourceFlowDest_t * flowDest; //!< Destinations par flot
+   unsigned int pduFlowId;  //!< Flot de la PDU courante
+   unsigned int nextFlowId; //!< Flot de la prochaine PDU
 };
 
 /**
@@ -62,6 +102,7 @@ struct PDUSource_t * PDUSource_create(struct dateGenerator_t * dateGen,
    // Pour les sources déterministes (à refaire un jour)
    result->sequence = NULL;
    result->detNextIdx = 0;
+   result->trace = NULL;
 
    // Ajout à la liste des choses à réinitialiser avant une prochaine simu
    motsim_addToResetList(result, (void (*)(void *))PDUSource_start);
@@ -124,6 +165,171 @@ struct PDUSource_t * PDUSource_createDeterministic(struct dateSize * sequence,
 
 }
 
+/*
+ * Remplissage du tampon de la trace. Renvoie le nombre
+ * d'enregistrements lus (0 en fin de fichier).
+ */
+static int PDUSourceTrace_fill(struct PDUSourceTrace_t * trace)
+{
+   char line[256];
+   char * c;
+
+   trace->pos = 0;
+   if (trace->format == PDUSourceTraceBinary) {
+      trace->nb = fread(trace->buffer, sizeof(struct PDUTraceRecord_t),
+                        PDU_SOURCE_TRACE_BUFFER_LENGTH, trace->file);
+   } else {
+      trace->nb = 0;
+      while ((trace->nb < PDU_SOURCE_TRACE_BUFFER_LENGTH)
+             && (fgets(line, sizeof(line), trace->file))) {
+         if (line[0] == '#') {
+            continue;
+         }
+         while ((c = strchr(line, ',')) != NULL) {
+            *c = ' ';
+         }
+         trace->buffer[trace->nb].flowId = 0;
+         if (sscanf(line, "%lf %u %u",
+                    &trace->buffer[trace->nb].date,
+                    &trace->buffer[trace->nb].size,
+                    &trace->buffer[trace->nb].flowId) >= 2) {
+            trace->nb++;
+         }
+      }
+   }
+   return trace->nb;
+}
+
+/*
+ * Lecture du prochain enregistrement de la trace. Renvoie 0 si la
+ * trace est épuisée.
+ */
+static int PDUSourceTrace_next(struct PDUSourceTrace_t * trace,
+                               struct PDUTraceRecord_t * record)
+{
+   if (trace->pos == trace->nb) {
+      if (PDUSourceTrace_fill(trace) == 0) {
+         if (trace->loopPeriod <= 0.0) {
+            return 0;
+         }
+         // On reprend au début pour un nouveau tour
+         rewind(trace->file);
+         trace->offset += trace->loopPeriod;
+         if (PDUSourceTrace_fill(trace) == 0) {
+            return 0;
+         }
+      }
+   }
+   *record = trace->buffer[trace->pos++];
+   record->date = record->date - trace->firstDate + trace->offset;
+
+   return 1;
+}
+
+/*
+ * Retour au début de la trace
+ */
+static void PDUSourceTrace_rewind(struct PDUSourceTrace_t * trace)
+{
+   rewind(trace->file);
+   trace->offset = trace->timeShift;
+   if (PDUSourceTrace_fill(trace)) {
+      trace->firstDate = trace->buffer[0].date;
+   }
+}
+
+/**
+ *  @brief Création d'une source rejouant une trace
+ * 
+ *  @param fileName Le fichier contenant la trace
+ *  @param format PDUSourceTraceBinary ou PDUSourceTraceText
+ *  @param destination L'entité aval par défaut
+ *  @param destProcessPDU La fonction de traitement de la destination
+ *  @result Un pointeur sur la source créée/initialisée
+ */
+struct PDUSource_t * PDUSource_createFromTrace(char * fileName,
+                                               int format,
+                                               void * destination,
+                                               processPDU_t destProcessPDU)
+{
+   struct PDUSource_t * result = PDUSource_create(NULL,
+						  destination,
+						  destProcessPDU);
+   struct PDUSourceTrace_t * trace = (struct PDUSourceTrace_t *)
+              sim_malloc(sizeof(struct PDUSourceTrace_t));
+
+   printf_debug(DEBUG_SRC, "IN, file=%s, dest=%p\n", fileName, destination);
+
+   trace->file = fopen(fileName, (format == PDUSourceTraceBinary)?"rb":"r");
+   if (trace->file == NULL) {
+      motSim_error(MS_FATAL, "Ouverture de \"%s\" impossible\n", fileName);
+   }
+   trace->format = format;
+   trace->pos = 0;
+   trace->nb = 0;
+   trace->firstDate = 0.0;
+   trace->timeShift = 0.0;
+   trace->loopPeriod = 0.0;
+   trace->offset = 0.0;
+   trace->nbFlows = 0;
+   trace->flowDest = NULL;
+   trace->pduFlowId = 0;
+   trace->nextFlowId = 0;
+
+   result->trace = trace;
+
+   printf_debug(DEBUG_SRC, "OUT\n");
+
+   return result;
+}
+
+/**
+ * @brief Décalage temporel de la trace
+ */
+void PDUSource_setTraceTimeShift(struct PDUSource_t * src,
+                                 motSimDate_t shift)
+{
+   assert(src->trace);
+   src->trace->timeShift = shift;
+}
+
+/**
+ * @brief Rejeu en boucle de la trace
+ */
+void PDUSource_setTraceLoop(struct PDUSource_t * src,
+                            motSimDate_t period)
+{
+   assert(src->trace);
+   src->trace->loopPeriod = period;
+}
+
+/**
+ * @brief Association d'une destination à un flot de la trace
+ */
+void PDUSource_setTraceFlowDestination(struct PDUSource_t * src,
+                                       unsigned int flowId,
+                                       void * destination,
+                                       processPDU_t destProcessPDU)
+{
+   struct PDUSourceTrace_t * trace = src->trace;
+   unsigned int f;
+
+   assert(trace);
+
+   if (flowId >= trace->nbFlows) {
+      trace->flowDest = realloc(trace->flowDest,
+                                (flowId + 1)*sizeof(struct PDUSourceFlowDest_t));
+      assert(trace->flowDest);
+      for (f = trace->nbFlows; f <= flowId; f++) {
+         trace->flowDest[f].destination = src->destination;
+         trace->flowDest[f].destProcessPDU = src->destProcessPDU;
+      }
+      trace->nbFlows = flowId + 1;
+   }
+   trace->flowDest[flowId].destination = destination;
+   trace->flowDest[flowId].destProcessPDU = destProcessPDU;
+}
+
 /*
  * Positionnement d'une sonde sur la taille des PDUs produites. Toutes
  * les PDUs créées sont concernées, même si elles ne sont pas
@@ -159,6 +365,9 @@ void PDUSource_buildNewPDU(struct PDUSource_t * source)
    motSimDate_t date;
    struct event_t * event;
    unsigned int size = 0; 
+   struct PDUTraceRecord_t record;
+   void * destination = source->destination;
+   processPDU_t destProcessPDU = source->destProcessPDU;
 
    printf_debug(DEBUG_SRC, " IN\n");
 
@@ -170,6 +379,16 @@ void PDUSource_buildNewPDU(struct PDUSource_t * source)
 
    // La prochaine devient la nouvelle
    source->pdu = source->nextPdu;
+   source->nextPdu = NULL;
+
+   // Choix de la destination selon le flot, dans le cas d'une trace
+   if (source->trace) {
+      source->trace->pduFlowId = source->trace->nextFlowId;
+      if (source->trace->pduFlowId < source->trace->nbFlows) {
+         destination = source->trace->flowDest[source->trace->pduFlowId].destination;
+         destProcessPDU = source->trace->flowDest[source->trace->pduFlowId].destProcessPDU;
+      }
+   }
 
    if (source->pdu) { // La première fois, c'est un coup à blanc
 
@@ -184,22 +403,32 @@ void PDUSource_buildNewPDU(struct PDUSource_t * source)
 
    printf_debug(DEBUG_SRC, " COUCOU\n");
       // On passe la PDU au suivant  
-      if ((source->destProcessPDU) && (source->destination)) {
+      if ((destProcessPDU) && (destination)) {
    printf_debug(DEBUG_SRC, " On passe\n");
          // On logue cet événement
- 	ndesLog_logLineF(PDU_getObject(source->pdu),
-                         "CREATED_BY %d", PDUSource_getObjectId(source));
-        (void)source->destProcessPDU(source->destination,
-                                     (getPDU_t)PDUSource_getPDU,
-                                     source);
+ 	ndesLog_tracePDU(NDESLOG_SOURCE, source->pdu,
+                         ndesLog_createdBy, PDUSource_getObjectId(source));
+        (void)destProcessPDU(destination,
+                             (getPDU_t)PDUSource_getPDU,
+                             source);
       }
    }
    // Maintenant on prépare la prochaine PDU
    printf_debug(DEBUG_SRC, " building next PDU ...\n");
 
+   // Rejeu d'une trace : une date passée (en fin de trace) arrête
+   // la source
+   if (source->trace) {
+      if (PDUSourceTrace_next(source->trace, &record)) {
+         date = record.date;
+         size = record.size;
+         source->trace->nextFlowId = record.flowId;
+      } else {
+         date = -1.0;
+      }
    // Gestion de la version "déterministe" par une valeur spéciale du
    // pointeur. Je n'aime pas ça, mais en attendant mieux, ...
-   if (source->dateGen == NULL) {
+   } else if (source->dateGen == NULL) {
       printf_debug(DEBUG_SRC, " deterministic source\n");
       printf_debug(DEBUG_SRC, " next idx is  %d\n", source->detNextIdx);
 
@@ -224,7 +453,7 @@ void PDUSource_buildNewPDU(struct PDUSource_t * source)
 
    // Un petit hack pour arrêter si une source déterministe a un {0.0, 0}
    if ((date >= motSim_getCurrentTime())
-       && ((size != 0) || (source->dateGen))
+       && ((size != 0) || (source->dateGen) || (source->trace))
       ) {
       // Création de la prochaine PDU
       source->nextPdu = PDU_create(size, NULL); 
@@ -259,7 +488,7 @@ struct PDU_t * PDUSource_getPDU(void * src)
 		PDU_id(pdu),
 		PDU_size(pdu));
 
-   ndesLog_logLineF(PDU_getObject(pdu), "OUT %d", PDUSource_getObjectId(source));
+   ndesLog_tracePDU(NDESLOG_SOURCE, pdu, ndesLog_out, PDUSource_getObjectId(source));
 
    return pdu;
 }
@@ -272,6 +501,15 @@ void PDUSource_start(struct PDUSource_t * source)
       source->pdu = NULL;
    }
 
+   // Une trace est rejouée depuis le début
+   if (source->trace) {
+      if (source->nextPdu) {
+         PDU_free(source->nextPdu);
+         source->nextPdu = NULL;
+      }
+      PDUSourceTrace_rewind(source->trace);
+   }
+
    // On lance la machine
    PDUSource_buildNewPDU(source);
 
@@ -14,10 +14,11 @@ struct PDU_t {
    declareAsNdesObject;
 
    int      id;    // Un identifiant général
+   int      taille ; // Voisin de id pour ne pas perdre de place
    motSimDate_t  creationDate;
 
    void   * data;  // Des donnees privées
-   int      taille ;
+   PDU_privateFree_t freePrivate; // Libération des données privées
 
    // Les pointeurs suivants sont à la discrétion du propriétaire de la PDU
    // WARNING c'est une horreur à virer
@@ -30,10 +31,48 @@ struct PDU_t {
  */
 declareObjectFunctions(PDU);
 
+/**
+ * @brief Les PDU sont des ndesObject
+ */
+struct ndesObjectType_t PDUType = {
+  ndesObjectTypeDefaultValues(PDU),
+  .getObject = (struct ndesObject_t * (*)(void *))PDU_getObject
+};
+
 /**
  * @brief Définition des fonctions spécifiques liées au ndesObject
+ *
+ * Le ndesObject d'une PDU n'est créé que lorsqu'on en a besoin (en
+ * pratique pour la tracer), il est rendu lors de la libération de la
+ * PDU.
  */
-defineObjectFunctions(PDU);
+struct ndesObject_t * PDU_getObject(struct PDU_t * o)
+{
+   if (o->ndesObject == NULL) {
+      ndesObjectInit(o, PDU);
+   }
+   return o->ndesObject;
+}
+
+void PDU_setObject(struct PDU_t * o, struct ndesObject_t * ndesObject)
+{
+   o->ndesObject = ndesObject;
+}
+
+int PDU_getObjectId(struct PDU_t * o)
+{
+   return PDU_getObject(o)->id;
+}
+
+void PDU_setName(struct PDU_t * o, const char * n)
+{
+   PDU_getObject(o)->name = strdup(n);
+}
+
+char * PDU_getName(struct PDU_t * o)
+{
+   return PDU_getObject(o)->name;
+}
 
 static int pduNB = 0;
 
@@ -43,15 +82,6 @@ struct probe_t * PDU_reuseProbe;
 struct probe_t * PDU_mallocProbe;
 struct probe_t * PDU_releaseProbe;
 
-// Pointeur sur une PDU libre (pour accélerer alloc/free)
-struct PDU_t * firstFreePDU = NULL;
-
-/**
- * @brief Les entrées de log sont des ndesObject
- */
-struct ndesObjectType_t PDUType = {
-  ndesObjectTypeDefaultValues(PDU)
-};
 
 int PDU_size(struct PDU_t * PDU){
    return PDU->taille;
@@ -73,21 +103,20 @@ struct PDU_t * PDU_create(int size, void * private)
 {
    struct PDU_t * PDU ;
 
-   if (firstFreePDU){
-      PDU = firstFreePDU;
-      firstFreePDU = PDU->next;
-      assert(PDU);
+   // Les PDU libérées sont conservées dans le stock de leur type
+   if (PDUType.next){
+      PDU = (struct PDU_t *)ndesObjectType_alloc(&PDUType);
       probe_sample(PDU_reuseProbe, (double)PDU->id);
    } else {
-      PDU = (struct PDU_t *)sim_malloc(sizeof(struct PDU_t));
-      assert(PDU);
+      PDU = (struct PDU_t *)ndesObjectType_alloc(&PDUType);
       probe_sample(PDU_mallocProbe, (double)PDU->id);
    }
 
-   ndesObjectInit(PDU, PDU);
+   PDU->ndesObject = NULL;
    PDU->taille = size;
    PDU->id = pduNB ++;
    PDU->data = private;
+   PDU->freePrivate = NULL;
    PDU->creationDate = motSim_getCurrentTime();
    PDU->next = NULL;
    PDU->prev = NULL;
@@ -99,17 +128,38 @@ struct PDU_t * PDU_create(int size, void * private)
    return PDU;
 }
 
+/*
+ * Choix de la fonction de libération des données privées
+ */
+void PDU_setPrivateFree(struct PDU_t * PDU, PDU_privateFree_t freePrivate)
+{
+   PDU->freePrivate = freePrivate;
+}
+
+/*
+ * La fonction de libération des données privées (NULL si aucune)
+ */
+PDU_privateFree_t PDU_getPrivateFree(struct PDU_t * PDU)
+{
+   return PDU->freePrivate;
+}
+
 /*
  * Destruction d'une PDU. Les donnees privees doivent avoir
- * ete detruites par l'appelant.
+ * ete detruites par l'appelant, sauf si une fonction de liberation
+ * a ete fournie.
  */
 void PDU_free(struct PDU_t * pdu)
 {
    if (pdu != NULL) {
       probe_sample(PDU_releaseProbe, (double)pdu->id);
 
-      pdu->next = firstFreePDU;
-      firstFreePDU = pdu;
+      if (pdu->freePrivate) {
+         pdu->freePrivate(pdu->data);
+      }
+
+      ndesObject_free(pdu->ndesObject);
+      ndesObjectType_release(&PDUType, pdu);
    }
 }
 
@@ -98,8 +98,76 @@ struct randomGenerator_t {
    // Une sonde sur les valeurs gÃ©nÃ©rÃ©es
    struct probe_t * valueProbe;
 
+   // Enregistrement/rejeu dans un fichier (NULL si inutilisé)
+   struct randomGeneratorTrace_t * trace;
 };
 
+/*
+ * Trace binaire des valeurs produites par la source. Les valeurs sont
+ * écrites/lues séquentiellement par blocs de RG_TRACE_BUFFER_LENGTH
+ * afin de garder une empreinte mémoire constante quelle que soit la
+ * longueur de la simulation.
+ */
+#define RG_TRACE_BUFFER_LENGTH 4096
+
+struct randomGeneratorTrace_t {
+   FILE * file;
+   int    recording;  //!< Vrai tant qu'on est en phase d'enregistrement
+   int    pos;        //!< Position dans le tampon
+   int    nb;         //!< Nombre de valeurs valides dans le tampon (rejeu)
+   unsigned long nbValues; //!< Nombre de valeurs dans le fichier
+   double buffer[RG_TRACE_BUFFER_LENGTH];
+   struct randomGeneratorTrace_t * next; //!< Chaînage des traces ouvertes
+};
+
+/*
+ * Les traces ouvertes, afin de vider celles en cours d'enregistrement
+ * à la fin du processus
+ */
+static struct randomGeneratorTrace_t * randomGenerator_traces = NULL;
+
+/*
+ * Vidange du tampon d'enregistrement dans le fichier
+ */
+static void randomGenerator_traceFlush(struct randomGeneratorTrace_t * t)
+{
+   if ((t->pos > 0)
+       && (fwrite(t->buffer, sizeof(double), t->pos, t->file) != t->pos)) {
+      motSim_error(MS_FATAL, "Ecriture de la trace impossible\n");
+   }
+   t->nbValues += t->pos;
+   t->pos = 0;
+}
+
+/*
+ * Vidange de toutes les traces en cours d'enregistrement, invoquée à
+ * la fin du processus : sans cela, le dernier bloc d'une simulation
+ * qui se termine sans reset serait perdu.
+ */
+static void randomGenerator_traceFlushAll()
+{
+   struct randomGeneratorTrace_t * t;
+
+   for (t = randomGenerator_traces; t; t = t->next) {
+      if (t->recording) {
+         randomGenerator_traceFlush(t);
+         fflush(t->file);
+      }
+   }
+}
+
+/*
+ * Enregistrement d'une valeur dans la trace
+ */
+static inline void randomGenerator_traceRecord(struct randomGeneratorTrace_t * t,
+                                               double v)
+{
+   t->buffer[t->pos++] = v;
+   if (t->pos == RG_TRACE_BUFFER_LENGTH) {
+      randomGenerator_traceFlush(t);
+   }
+}
+
 /*==========================================================================*/
 /*       Les fonctions liÃ©es aux sources.                                   */
 /*==========================================================================*/
@@ -114,6 +182,9 @@ inline double randomGenerator_erand48GetNext(struct randomGenerator_t * rg)
    if (rg->values)
       probe_sample(rg->values, result);
 
+   if (rg->trace)
+      randomGenerator_traceRecord(rg->trace, result);
+
    return result;
 }
 
@@ -150,6 +221,42 @@ void randomGenerator_replayInit(struct randomGenerator_t * rg)
    rg->aleaGetNext = randomGenerator_replayGetNext;
 }
 
+/*
+ * Next value with file replay
+ */
+double randomGenerator_fileReplayGetNext(struct randomGenerator_t * rg)
+{
+   struct randomGeneratorTrace_t * t = rg->trace;
+
+   if (t->pos == t->nb) {
+      t->nb = fread(t->buffer, sizeof(double), RG_TRACE_BUFFER_LENGTH, t->file);
+      t->pos = 0;
+      if (t->nb == 0) {
+         motSim_error(MS_FATAL, "Fin de la trace atteinte (%lu valeurs)\n", t->nbValues);
+      }
+   }
+   return t->buffer[t->pos++];
+}
+
+/*
+ * Initialisation of file replay : on repart du début du fichier
+ */
+void randomGenerator_fileReplayInit(struct randomGenerator_t * rg)
+{
+   struct randomGeneratorTrace_t * t = rg->trace;
+
+   assert(rg->source == rGSourceFileReplay);
+
+   if (t->recording) {
+      randomGenerator_traceFlush(t);
+      t->recording = 0;
+   }
+   rewind(t->file);
+   t->pos = 0;
+   t->nb = 0;
+   rg->aleaGetNext = randomGenerator_fileReplayGetNext;
+}
+
 
 /*==========================================================================*/
 /*       Les fonctions liÃ©es aux distributions.                             */
@@ -361,6 +468,45 @@ double randomGenerator_getNextDouble(struct randomGenerator_t * rg)
 
 }
 
+/*
+ * Production de n valeurs d'un coup. Les cas les plus fréquents
+ * (loi exponentielle sur erand48, valeur unique) sont traités par une
+ * boucle sans indirection, les autres reviennent au cas général.
+ */
+void randomGenerator_getNextDoubles(struct randomGenerator_t * rg,
+                                    int n, double * values)
+{
+   int i;
+   double lambda;
+
+   if ((rg->valueType == rGTypeDouble)
+       && (rg->distribution == rGDistExponential)
+       && (rg->aleaGetNext == randomGenerator_erand48GetNext)
+       && (rg->values == NULL) && (rg->trace == NULL)) {
+      lambda = rg->distParam.d.lambda;
+      for (i = 0; i < n; i++) {
+         values[i] = - log(erand48(rg->aleaSrc.xsubi)) / lambda;
+      }
+   } else if ((rg->valueType == rGTypeDoubleEnum)
+              && (rg->param.dd.nbValues == 1)) {
+      for (i = 0; i < n; i++) {
+         values[i] = rg->param.dd.value[0];
+      }
+   } else {
+      for (i = 0; i < n; i++) {
+         values[i] = randomGenerator_getNextDouble(rg);
+      }
+      return; // Les valeurs ont déjà été sondées
+   }
+
+   // On probe éventuellement
+   if (rg->valueProbe) {
+      for (i = 0; i < n; i++) {
+         probe_sample(rg->valueProbe, values[i]);
+      }
+   }
+}
+
 double randomGenerator_UIntDiscreteGetExpectation(struct randomGenerator_t * rg)
 {
    double result = 0.0;
@@ -402,7 +548,10 @@ void randomGenerator_reset(struct randomGenerator_t * rg)
 {
    printf_debug(DEBUG_GENE, "IN\n");
    // Gestion du "record then replay"
-   if (rg->values) {
+   if (rg->trace) {
+      rg->source = rGSourceFileReplay;
+      randomGenerator_fileReplayInit(rg);
+   } else if (rg->values) {
       rg->source = rGSourceReplay;
       randomGenerator_replayInit(rg);
    }
@@ -422,6 +571,7 @@ struct randomGenerator_t * randomGenerator_createRaw()
           = sim_malloc(sizeof(struct randomGenerator_t ));
 
    result->values = NULL;
+   result->trace = NULL;
 
    result->distribution = rGDistNoDist; //WARNING on doit pouvoir en
 					//mettre une ...
@@ -663,6 +813,20 @@ struct randomGenerator_t * randomGenerator_createFromProbe(struct probe_t * p)
  */
 void randomGenerator_delete(struct randomGenerator_t * rg)
 {
+   struct randomGeneratorTrace_t ** t;
+
+   // La trace doit être complète et fermée
+   if (rg->trace) {
+      if (rg->trace->recording) {
+         randomGenerator_traceFlush(rg->trace);
+      }
+      fclose(rg->trace->file);
+      for (t = &randomGenerator_traces; *t != rg->trace; t = &((*t)->next));
+      *t = rg->trace->next;
+      free(rg->trace);
+      rg->trace = NULL;
+   }
+
    printf_debug(DEBUG_TBD, "Pas encore implantÃ© !!!\n");
 }
 
@@ -820,6 +984,60 @@ void randomGenerator_recordThenReplay(struct randomGenerator_t * rg)
    probe_setPersistent(rg->values);
 }
 
+/*
+ * Allocation d'une trace sur le fichier fileName
+ */
+static struct randomGeneratorTrace_t * randomGenerator_traceCreate(char * fileName,
+                                                                   char * mode)
+{
+   static int atexitEnregistre = 0;
+   struct randomGeneratorTrace_t * result
+          = sim_malloc(sizeof(struct randomGeneratorTrace_t));
+
+   result->file = fopen(fileName, mode);
+   if (result->file == NULL) {
+      motSim_error(MS_FATAL, "Ouverture de \"%s\" impossible\n", fileName);
+   }
+   result->recording = 0;
+   result->pos = 0;
+   result->nb = 0;
+   result->nbValues = 0;
+
+   if (!atexitEnregistre) {
+      atexit(randomGenerator_traceFlushAll);
+      atexitEnregistre = 1;
+   }
+   result->next = randomGenerator_traces;
+   randomGenerator_traces = result;
+
+   return result;
+}
+
+/*
+ * Prepare for record values in a file in order to replay on each reset
+ */
+void randomGenerator_recordThenReplayToFile(struct randomGenerator_t * rg,
+                                            char * fileName)
+{
+   assert(rg->trace == NULL);
+
+   rg->trace = randomGenerator_traceCreate(fileName, "w+b");
+   rg->trace->recording = 1;
+}
+
+/*
+ * Replay values previously recorded in a file
+ */
+void randomGenerator_replayFromFile(struct randomGenerator_t * rg,
+                                    char * fileName)
+{
+   assert(rg->trace == NULL);
+
+   rg->trace = randomGenerator_traceCreate(fileName, "rb");
+   rg->source = rGSourceFileReplay;
+   randomGenerator_fileReplayInit(rg);
+}
+
 /*==========================================================================*/
 /*   Probes                                                                 */ 
 /*==========================================================================*/
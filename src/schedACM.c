@@ -4,7 +4,12 @@
  *
  */
 #include <math.h>      // exp, pow, ...
-#include <string.h>    // strcat
+#include <stdlib.h>    // posix_memalign
+#include <string.h>    // strcat, memcpy, memset
+
+#ifdef NDES_PTHREAD
+#include <pthread.h>
+#endif
 
 #include <schedACM.h>
 
@@ -33,6 +38,7 @@ struct schedACM_t {
    // bon de les utiliser de faÃ§on cohÃ©rente avec le modÃ¨le I/O
    struct filePDU_t *** files;  //!< Les files d'attentes
    t_qosMgt          ** qos;
+   struct schedACM_etatFile_t ** etats; //!< État dérivé de chaque file
    int                  declassement;
 
    // La destination est forcément un lien DVBS2, mais il serait 
@@ -40,6 +46,9 @@ struct schedACM_t {
    // De plus, on pourra gÃ©nÃ©raliser sans trop de difficultÃ©s (?)
    // Ã  un ACM
    struct DVBS2ll_t * dvbs2ll; // Le lien sur lequel on transmet
+   double * tpsEmission;       //!< Durée d'une BBFRAME de chaque MODCOD
+   double * facteurEMA;        //!< Coefficient de l'EMA des débits par MODCOD
+   unsigned int versionModcods; //!< Version des MODCODs du lien utilisée
 
    struct probe_t **** pqFromMQinMC;
    //!< pqFromMQinMC[m][q][mc] est une probe qui compte la taille et le nombre de
@@ -49,6 +58,12 @@ struct schedACM_t {
 
    int paquetsEnAttente; //!< Ai-je au moins un pq en attente ?
 
+   int nbTramesAvance;   //!< Nombre de BBFRAMEs remises d'un coup au lien
+
+   // Tampon des paquets extraits lors de la construction d'une BBFRAME
+   struct PDU_t ** paquetsExtraits;
+   int             nbPaquetsExtraitsMax;
+
    // Dans la version la plus simple, l'algorithme d'ordonnancenemt
    // doit déterminer un remplissage pour la prochaine BBFRAME. Il
    // place alors sa solution dans le champ suivant
@@ -74,10 +89,97 @@ struct schedACM_t {
    int nbEpoch;
    int nbEpochStarvation;
 
+   // Résolution des sous-problèmes par MODCOD
+   int nbThreads; //!< Nombre d'exécutants (1 : séquentiel)
+#ifdef NDES_PTHREAD
+   struct schedACM_pool_t * pool; //!< Les exécutants, créés au besoin
+#endif
+
    // Données privées
    void * private;
 };
 
+/**
+ * @brief État dérivé d'une file d'entrée
+ *
+ * Cet état est tenu à jour à chaque insertion/extraction (la file
+ * nous notifie, voir filePDU_setObserver) plutôt que recalculé en
+ * parcourant la file à chaque ordonnancement. Les tailles sont
+ * stockées sous forme de cumuls depuis le début de la simulation :
+ * cumul[(debut + i) & (capacite - 1)] est le volume entré dans la
+ * file jusqu'au (i+1)-ème paquet présent inclus, sorti le volume
+ * déjà extrait. La taille des n premiers paquets s'obtient donc en
+ * temps constant.
+ */
+struct schedACM_etatFile_t {
+   struct schedACM_t * sched;
+   int m, q;
+
+   unsigned long * cumul;
+   int             capacite;     //!< Taille de cumul (puissance de 2)
+   int             debut;        //!< Indice du premier paquet
+   int             nombre;       //!< Nombre de paquets présents
+   unsigned long   entre;        //!< Volume total inséré
+   unsigned long   sorti;        //!< Volume total extrait
+
+   // La dérivée de l'utilité au débit courant n'est recalculée que
+   // si le débit (ou la QoS) a changé depuis, de même que le gain
+   // par octet émis dans une BBFRAME de chaque MODCOD (le gain d'un
+   // paquet est proportionnel à sa taille)
+   double          derivee;
+   double        * gainParOctet;
+   int             deriveeAJour;
+};
+
+#define SCHEDACM_CUMUL_CAPACITE_INIT 16
+
+#ifdef NDES_PTHREAD
+/**
+ * @brief Un pool persistant d'exécutants pour la résolution par MODCOD
+ *
+ * Les exécutants attendent un lot (une invocation de
+ * schedACM_solveAllModcods) puis se partagent ses MODCODs. Le thread
+ * appelant participe au lot avec le numéro 0.
+ */
+struct schedACM_pool_t {
+   pthread_mutex_t    mutex;
+   pthread_cond_t     nouveauLot;  //!< Un lot est disponible
+   pthread_cond_t     lotTermine;  //!< Tous les MODCODs sont traités
+   int                generation;  //!< Numéro du lot courant
+
+   // Le lot courant
+   schedACM_solveMC_t solve;
+   void             * private;
+   t_remplissage    * remplissages;
+   int                nbModCod;
+   int                prochain;    //!< Prochain MODCOD à attribuer
+   int                nbTraites;   //!< Nombre de MODCODs terminés
+};
+
+struct schedACM_executant_t {
+   struct schedACM_pool_t * pool;
+   int                      numero;
+};
+#endif
+
+/*
+ * Calcul de ce qui ne dépend que des MODCODs du lien : durée d'une
+ * BBFRAME et coefficient de l'EMA des débits. Le nombre de MODCODs ne
+ * peut pas changer une fois l'ordonnanceur créé.
+ */
+static void schedACM_calculerModcods(struct schedACM_t * sched)
+{
+   int mc;
+
+   assert(DVBS2ll_nbModcod(sched->dvbs2ll) == sched->nbModCod);
+
+   for (mc = 0; mc < sched->nbModCod; mc++) {
+      sched->tpsEmission[mc] = DVBS2ll_bbframeTransmissionTime(sched->dvbs2ll, mc);
+      sched->facteurEMA[mc] = pow(alpha, 1000.0*sched->tpsEmission[mc]);
+   }
+   sched->versionModcods = DVBS2ll_modcodVersion(sched->dvbs2ll);
+}
+
 /**
  * @brief Création d'un scheduler avec sa "destination"
  * Cette derniÃ¨re doit
@@ -99,22 +201,37 @@ struct schedACM_t * schedACM_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int d
    result->dvbs2ll = dvbs2ll;
 
    // La destination doit nous connaitre
-   DVBS2ll_setSource(dvbs2ll, result, (getPDU_t)schedACM_getPDU);
+   DVBS2ll_setFrameSource(dvbs2ll, result, (DVBS2ll_provideFrames_t)schedACM_provideFrames);
+   result->nbTramesAvance = 1;
 
    result->nbQoS = nbQoS;
    result->nbModCod = DVBS2ll_nbModcod(dvbs2ll);
 
+   // Ce qui ne dépend que des MODCODs n'est recalculé que lorsque
+   // ceux du lien changent (cf schedACM_majModcods)
+   result->tpsEmission = (double *)sim_malloc(sizeof(double)*result->nbModCod);
+   assert(result->tpsEmission);
+   result->facteurEMA = (double *)sim_malloc(sizeof(double)*result->nbModCod);
+   assert(result->facteurEMA);
+   schedACM_calculerModcods(result);
+   result->paquetsExtraits = NULL;
+   result->nbPaquetsExtraitsMax = 0;
+
    // Allocation des tableaux de files, qos et paramÃ¨tres
    result->files = (struct filePDU_t ***)sim_malloc(sizeof(struct filePDU_t **)*result->nbModCod);
    assert(result->files);
    result->qos = (t_qosMgt **)sim_malloc(sizeof(t_qosMgt *)*result->nbModCod);
    assert(result->qos);
+   result->etats = (struct schedACM_etatFile_t **)sim_malloc(sizeof(struct schedACM_etatFile_t *)*result->nbModCod);
+   assert(result->etats);
 
    for (i = 0; i < result->nbModCod; i++) {
       result->files[i] = (struct filePDU_t **)sim_malloc(sizeof(struct filePDU_t *)*result->nbQoS);
       assert(result->files[i]);
       result->qos[i] = (t_qosMgt *)sim_malloc(sizeof(t_qosMgt)*result->nbQoS);
       assert(result->qos[i]);
+      result->etats[i] = (struct schedACM_etatFile_t *)sim_malloc(sizeof(struct schedACM_etatFile_t)*result->nbQoS);
+      assert(result->etats[i]);
       for (j = 0; j < nbQoS; j++) {
          result->files[i][j] = NULL;
 	 result->qos[i][j].typeQoS = -1;  // WARNING bof
@@ -127,6 +244,20 @@ struct schedACM_t * schedACM_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int d
 					      // ou dérivées n'y sont
 					      // pas définies !!)
          result->qos[i][j].bwProbe = NULL;
+
+         result->etats[i][j].sched = result;
+         result->etats[i][j].m = i;
+         result->etats[i][j].q = j;
+         result->etats[i][j].capacite = SCHEDACM_CUMUL_CAPACITE_INIT;
+         result->etats[i][j].cumul = (unsigned long *)sim_malloc(SCHEDACM_CUMUL_CAPACITE_INIT*sizeof(unsigned long));
+         assert(result->etats[i][j].cumul);
+         result->etats[i][j].debut = 0;
+         result->etats[i][j].nombre = 0;
+         result->etats[i][j].entre = 0;
+         result->etats[i][j].sorti = 0;
+         result->etats[i][j].gainParOctet = (double *)sim_malloc(result->nbModCod*sizeof(double));
+         assert(result->etats[i][j].gainParOctet);
+         result->etats[i][j].deriveeAJour = 0;
       }
    }
 
@@ -157,6 +288,11 @@ struct schedACM_t * schedACM_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int d
    result->declassement = declOK;
    result->private = NULL;
 
+   result->nbThreads = 1;
+#ifdef NDES_PTHREAD
+   result->pool = NULL;
+#endif
+
    result->func = func;
    printf_debug(DEBUG_ACM, "%p created (link : %p)\n", result, result->dvbs2ll);
 
@@ -207,6 +343,51 @@ void schedACM_setPqFromMQinMC(struct schedACM_t * sched, int m, int q, int mc, s
    sched->pqFromMQinMC[m][q][mc] = pr;
 }
 
+/*
+ * Ajout d'un paquet de taille donnée en queue de l'état d'une file
+ */
+static void schedACM_etatFileAjouter(struct schedACM_etatFile_t * etat, int taille)
+{
+   unsigned long * cumul;
+   int i;
+
+   // On double la capacité si besoin, en remettant le premier
+   // paquet en tête
+   if (etat->nombre == etat->capacite) {
+      cumul = (unsigned long *)sim_malloc(2*etat->capacite*sizeof(unsigned long));
+      assert(cumul);
+      for (i = 0; i < etat->nombre; i++) {
+         cumul[i] = etat->cumul[(etat->debut + i) & (etat->capacite - 1)];
+      }
+      free(etat->cumul);
+      etat->cumul = cumul;
+      etat->capacite *= 2;
+      etat->debut = 0;
+   }
+   etat->entre += taille;
+   etat->cumul[(etat->debut + etat->nombre) & (etat->capacite - 1)] = etat->entre;
+   etat->nombre++;
+}
+
+/*
+ * Notification par une file d'entrée d'une insertion ou d'une
+ * extraction (les PDUs sortent toujours en tête)
+ */
+static void schedACM_notifierFile(void * observer, struct PDU_t * pdu, int insertion)
+{
+   struct schedACM_etatFile_t * etat = (struct schedACM_etatFile_t *)observer;
+
+   if (insertion) {
+      schedACM_etatFileAjouter(etat, PDU_size(pdu));
+   } else {
+      assert(etat->nombre > 0);
+      etat->sorti = etat->cumul[etat->debut];
+      etat->debut = (etat->debut + 1) & (etat->capacite - 1);
+      etat->nombre--;
+   }
+   assert(etat->sorti + filePDU_size(etat->sched->files[etat->m][etat->q]) == etat->entre);
+}
+
 /*
  * Attribution des files d'attente d'entrÃ©e pour un MODCOD donnÃ© dans
  * le paramÃ¨tre mc. Le paramÃ¨tre files est un tableau de pointeurs sur
@@ -215,11 +396,27 @@ void schedACM_setPqFromMQinMC(struct schedACM_t * sched, int m, int q, int mc, s
  */
 void schedACM_setInputQueues(struct schedACM_t * sched, int mc, struct filePDU_t * files[])
 {
-   int j;
+   int j, n;
+   struct schedACM_etatFile_t * etat;
 
    for (j = 0; j < sched->nbQoS; j++) {
       assert(files[j] != NULL);
+      if (sched->files[mc][j]) {
+         filePDU_setObserver(sched->files[mc][j], NULL, NULL);
+      }
       sched->files[mc][j] = files[j];
+
+      // L'état dérivé repart du contenu actuel de la file, puis suit
+      // ses évolutions
+      etat = &(sched->etats[mc][j]);
+      etat->debut = 0;
+      etat->nombre = 0;
+      etat->entre = 0;
+      etat->sorti = 0;
+      for (n = 1; n <= filePDU_length(files[j]); n++) {
+         schedACM_etatFileAjouter(etat, filePDU_size_PDU_n(files[j], n));
+      }
+      filePDU_setObserver(files[j], etat, schedACM_notifierFile);
    }
 }
 
@@ -242,6 +439,7 @@ void schedACM_setFileQoSType(struct schedACM_t * sched, int mc, int qos, int qos
    sched->qos[mc][qos].typeQoS = qosType; 
    sched->qos[mc][qos].beta = beta;
    sched->qos[mc][qos].rmin = rmin;
+   sched->etats[mc][qos].deriveeAJour = 0;
 }
 
 /*
@@ -292,6 +490,127 @@ inline struct DVBS2ll_t * schedACM_getACMLink(struct schedACM_t * sched)
    return sched->dvbs2ll;
 }
 
+/*
+ * Taille du n-ième paquet (n >= 1) de la file (m, q)
+ */
+int schedACM_getPDUSize(struct schedACM_t * sched, int m, int q, int n)
+{
+   struct schedACM_etatFile_t * etat = &(sched->etats[m][q]);
+
+   assert((n >= 1) && (n <= etat->nombre));
+
+   return (int)(etat->cumul[(etat->debut + n - 1) & (etat->capacite - 1)]
+		- ((n > 1)?etat->cumul[(etat->debut + n - 2) & (etat->capacite - 1)]:etat->sorti));
+}
+
+/*
+ * Taille cumulée des n premiers paquets (n >= 0) de la file (m, q)
+ */
+int schedACM_getCumulatedSize(struct schedACM_t * sched, int m, int q, int n)
+{
+   struct schedACM_etatFile_t * etat = &(sched->etats[m][q]);
+
+   assert((n >= 0) && (n <= etat->nombre));
+
+   if (n == 0) {
+      return 0;
+   }
+   return (int)(etat->cumul[(etat->debut + n - 1) & (etat->capacite - 1)] - etat->sorti);
+}
+
+/*
+ * Cumuls des tailles des premiers paquets de la file (m, q), avec
+ * la même sémantique que filePDU_cumulatedSizes
+ */
+int schedACM_cumulatedSizes(struct schedACM_t * sched, int m, int q, int maxSize, int maxNb, int * cumul)
+{
+   struct schedACM_etatFile_t * etat = &(sched->etats[m][q]);
+   int k = 0;
+   unsigned long c;
+
+   cumul[0] = 0;
+   while ((k < etat->nombre) && (k < maxNb)) {
+      c = etat->cumul[(etat->debut + k) & (etat->capacite - 1)] - etat->sorti;
+      if (c > (unsigned long)maxSize) {
+         break;
+      }
+      cumul[k+1] = (int)c;
+      k++;
+   }
+
+   return k;
+}
+
+/*
+ * Dérivée de la fonction d'utilité de la file (m, q) en son débit
+ * courant
+ */
+double schedACM_getDerivee(struct schedACM_t * sched, int m, int q)
+{
+   if (sched->etats[m][q].deriveeAJour) {
+      return sched->etats[m][q].derivee;
+   }
+   return utiliteDerivee(&(sched->qos[m][q]), sched->qos[m][q].debit, sched->dvbs2ll);
+}
+
+/*
+ * Gain d'utilité de l'émission d'un paquet de la file (m, q) dans une
+ * BBFRAME du MODCOD mc
+ */
+double schedACM_gainUtilite(struct schedACM_t * sched, int m, int q, int taillePaquet, int mc)
+{
+   if (sched->etats[m][q].deriveeAJour) {
+      return sched->etats[m][q].gainParOctet[mc]*taillePaquet;
+   }
+   return schedACM_getDerivee(sched, m, q)/sched->tpsEmission[mc]*taillePaquet;
+}
+
+/*
+ * Si un MODCOD du lien a été modifié (DVBS2ll_setModcod) depuis le
+ * dernier ordonnancement, les durées d'émission et les gains par
+ * octet qui en découlent doivent être recalculés
+ */
+static void schedACM_majModcods(struct schedACM_t * sched)
+{
+   int m, q;
+
+   if (sched->versionModcods == DVBS2ll_modcodVersion(sched->dvbs2ll)) {
+      return;
+   }
+   schedACM_calculerModcods(sched);
+   for (m = 0; m < sched->nbModCod; m++) {
+      for (q = 0; q < sched->nbQoS; q++) {
+         sched->etats[m][q].deriveeAJour = 0;
+      }
+   }
+}
+
+/*
+ * Mise à jour des dérivées (et des gains qui en découlent) des files
+ * dont le débit a changé depuis le dernier ordonnancement. On le
+ * fait ici, avant la résolution (éventuellement parallèle) par
+ * MODCOD, pour que schedACM_getDerivee et schedACM_gainUtilite ne
+ * fassent ensuite que des lectures.
+ */
+static void schedACM_majDerivees(struct schedACM_t * sched)
+{
+   int m, q, mc;
+   struct schedACM_etatFile_t * etat;
+
+   for (m = 0; m < sched->nbModCod; m++) {
+      for (q = 0; q < sched->nbQoS; q++) {
+         etat = &(sched->etats[m][q]);
+         if ((!etat->deriveeAJour) && (sched->files[m][q])) {
+            etat->derivee = utiliteDerivee(&(sched->qos[m][q]), sched->qos[m][q].debit, sched->dvbs2ll);
+            for (mc = 0; mc < sched->nbModCod; mc++) {
+               etat->gainParOctet[mc] = etat->derivee/sched->tpsEmission[mc];
+            }
+            etat->deriveeAJour = 1;
+         }
+      }
+   }
+}
+
 /*
  * Obtention d'un pointeur vers une sonde
  */
@@ -323,7 +642,11 @@ t_sequence * schedACM_getSequenceChoisie(struct schedACM_t * sched)
  */
 void schedACM_tryingNewSolution(struct schedACM_t * sched)
 {
+#ifdef NDES_PTHREAD
+   __sync_fetch_and_add(&sched->nbSol, 1); // Invoquée par les exécutants
+#else
    sched->nbSol++;
+#endif
 }
 
 /*
@@ -343,6 +666,147 @@ int schedACM_getNbSolutions(struct schedACM_t * sched)
   return sched->nbSol;
 };
 
+#ifdef NDES_PTHREAD
+/*
+ * Traitement des MODCODs du lot courant par l'exécutant numero. Le
+ * mutex du pool doit être pris, il l'est encore au retour.
+ */
+static void schedACM_poolTraiterLot(struct schedACM_pool_t * pool, int numero)
+{
+   int mc;
+
+   while (pool->prochain < pool->nbModCod) {
+      mc = pool->prochain++;
+      pthread_mutex_unlock(&pool->mutex);
+      pool->solve(pool->private, mc, &(pool->remplissages[mc]), numero);
+      pthread_mutex_lock(&pool->mutex);
+      pool->nbTraites++;
+      if (pool->nbTraites == pool->nbModCod) {
+         pthread_cond_signal(&pool->lotTermine);
+      }
+   }
+}
+
+/*
+ * La boucle d'un exécutant
+ */
+static void * schedACM_poolExecutant(void * arg)
+{
+   struct schedACM_executant_t * exec = (struct schedACM_executant_t *)arg;
+   struct schedACM_pool_t * pool = exec->pool;
+   int generation = 0;
+
+   pthread_mutex_lock(&pool->mutex);
+   while (1) {
+      while (pool->generation == generation) {
+         pthread_cond_wait(&pool->nouveauLot, &pool->mutex);
+      }
+      generation = pool->generation;
+      schedACM_poolTraiterLot(pool, exec->numero);
+   }
+
+   return NULL;
+}
+
+/*
+ * Création des nbThreads - 1 exécutants (l'appelant est le numéro 0)
+ */
+static struct schedACM_pool_t * schedACM_poolCreate(int nbThreads)
+{
+   struct schedACM_pool_t * pool = (struct schedACM_pool_t *)sim_malloc(sizeof(struct schedACM_pool_t));
+   struct schedACM_executant_t * exec;
+   pthread_t thread;
+   int n;
+
+   assert(pool);
+   pthread_mutex_init(&pool->mutex, NULL);
+   pthread_cond_init(&pool->nouveauLot, NULL);
+   pthread_cond_init(&pool->lotTermine, NULL);
+   pool->generation = 0;
+   pool->nbModCod = 0;
+   pool->prochain = 0;
+   pool->nbTraites = 0;
+
+   for (n = 1; n < nbThreads; n++) {
+      exec = (struct schedACM_executant_t *)sim_malloc(sizeof(struct schedACM_executant_t));
+      assert(exec);
+      exec->pool = pool;
+      exec->numero = n;
+      if (pthread_create(&thread, NULL, schedACM_poolExecutant, exec)) {
+         motSim_error(MS_FATAL, "pthread_create\n");
+      }
+      pthread_detach(thread);
+   }
+
+   return pool;
+}
+#endif
+
+/*
+ * Nombre d'exécutants pour la résolution par MODCOD
+ */
+void schedACM_setNbThreads(struct schedACM_t * sched, int nb)
+{
+   assert(nb >= 1);
+#ifdef NDES_PTHREAD
+   // Le pool est créé une seule fois, à la première demande
+   assert((sched->pool == NULL) || (nb == sched->nbThreads));
+   sched->nbThreads = nb;
+#else
+   if (nb > 1) {
+      motSim_error(MS_WARN, "NDES compiled without NDES_PTHREAD, %d threads ignored\n", nb);
+   }
+   sched->nbThreads = 1;
+#endif
+}
+
+int schedACM_getNbThreads(struct schedACM_t * sched)
+{
+   return sched->nbThreads;
+}
+
+/*
+ * Résolution indépendante de chaque MODCOD. Chaque remplissage est
+ * mis à zéro et reçoit son MODCOD avant l'appel à solve.
+ */
+void schedACM_solveAllModcods(struct schedACM_t * sched, schedACM_solveMC_t solve, t_remplissage * remplissages)
+{
+   int mc;
+
+   for (mc = 0; mc < sched->nbModCod; mc++) {
+      remplissage_raz(&(remplissages[mc]), sched->nbModCod, sched->nbQoS);
+      remplissages[mc].modcod = mc;
+   }
+
+#ifdef NDES_PTHREAD
+   if (sched->nbThreads > 1) {
+      if (sched->pool == NULL) {
+         sched->pool = schedACM_poolCreate(sched->nbThreads);
+      }
+      pthread_mutex_lock(&sched->pool->mutex);
+      sched->pool->solve = solve;
+      sched->pool->private = sched->private;
+      sched->pool->remplissages = remplissages;
+      sched->pool->nbModCod = sched->nbModCod;
+      sched->pool->prochain = 0;
+      sched->pool->nbTraites = 0;
+      sched->pool->generation++;
+      pthread_cond_broadcast(&sched->pool->nouveauLot);
+
+      schedACM_poolTraiterLot(sched->pool, 0);
+      while (sched->pool->nbTraites < sched->pool->nbModCod) {
+         pthread_cond_wait(&sched->pool->lotTermine, &sched->pool->mutex);
+      }
+      pthread_mutex_unlock(&sched->pool->mutex);
+      return;
+   }
+#endif
+
+   for (mc = 0; mc < sched->nbModCod; mc++) {
+      solve(sched->private, mc, &(remplissages[mc]), 0);
+   }
+}
+
 /**
  * @brief Choix de la longueur maximale d'une séquence
  */
@@ -463,6 +927,9 @@ void schedACM_schedule(struct schedACM_t * sched)
 
    sched->nbSol = 0;
 
+   schedACM_majModcods(sched);
+   schedACM_majDerivees(sched);
+
    if (sched->func && sched->func->schedule) {
       printf_debug(DEBUG_ACM, "calling dedicated facility ...\n");
       sched->func->schedule(sched->private);
@@ -485,9 +952,9 @@ void schedACM_schedule(struct schedACM_t * sched)
  */
 struct PDU_t * schedACM_buildBBRFRAMEFromRemplissage(struct schedACM_t * sched, t_remplissage * solution)
 {
-   int q, m, p, vol, s;
-   double alphaMaaike;
+   int q, m, p, vol, s, nb;
    struct PDU_t * pdu = NULL;
+   struct probe_t * pq;
 
    // Si on trouve au moins un paquet à envoyer
    if (solution->volumeTotal) {
@@ -496,12 +963,27 @@ struct PDU_t * schedACM_buildBBRFRAMEFromRemplissage(struct schedACM_t * sched,
          for (m = 0; m < schedACM_getNbModCod(sched); m++) {
             for (q = 0; q < schedACM_getNbQoS(sched); q++) {
                s = 0;
-               for (p = 0 ; p < solution->nbrePaquets[m][q]; p++){
-                  pdu = filePDU_extract(schedACM_getInputQueue(sched, m, q));
-                  s += PDU_size(pdu);
-	          printf_debug(DEBUG_ACM, "Sortie du paquet %d de taille %d de la file (%d, %d)\n", PDU_id(pdu), PDU_size(pdu), m, q);
-		  probe_sample(schedACM_getPqFromMQinMC(sched, m, q, solution->modcod), PDU_size(pdu));
-                  PDU_free(pdu);
+               if (solution->nbrePaquets[m][q]) {
+                  if (solution->nbrePaquets[m][q] > sched->nbPaquetsExtraitsMax) {
+                     sched->nbPaquetsExtraitsMax = 2*solution->nbrePaquets[m][q];
+                     sched->paquetsExtraits = (struct PDU_t **)realloc(sched->paquetsExtraits,
+								       sched->nbPaquetsExtraitsMax*sizeof(struct PDU_t *));
+                     assert(sched->paquetsExtraits);
+                  }
+                  // Les paquets sont extraits d'un coup
+                  nb = filePDU_extractN(schedACM_getInputQueue(sched, m, q), solution->nbrePaquets[m][q],
+					sched->paquetsExtraits);
+                  assert(nb == solution->nbrePaquets[m][q]);
+                  pq = schedACM_getPqFromMQinMC(sched, m, q, solution->modcod);
+                  for (p = 0 ; p < nb; p++){
+                     pdu = sched->paquetsExtraits[p];
+                     s += PDU_size(pdu);
+	             printf_debug(DEBUG_ACM, "Sortie du paquet %d de taille %d de la file (%d, %d)\n", PDU_id(pdu), PDU_size(pdu), m, q);
+		     if (pq) {
+		        probe_sample(pq, PDU_size(pdu));
+		     }
+                     PDU_free(pdu);
+                  }
                }
 	       vol += s;
                // Mise à jour des débits (utilisés pour le calcul du
@@ -510,12 +992,10 @@ struct PDU_t * schedACM_buildBBRFRAMEFromRemplissage(struct schedACM_t * sched,
                // la file elle-même (en environnement réel, ce n'est
                // pas disponible), c'est le scheduler qui doit le
                // calculer. 
-               alphaMaaike = pow(alpha, 1000.0*DVBS2ll_bbframeTransmissionTime(schedACM_getACMLink(sched),
-									       solution->modcod));
 	       schedACM_getQoS(sched, m, q)->debit = calculeEMA(schedACM_getQoS(sched, m, q)->debit,
-						   8.0*s/DVBS2ll_bbframeTransmissionTime(schedACM_getACMLink(sched),
-											 solution->modcod),
-						   alphaMaaike); 
+						   8.0*s/sched->tpsEmission[solution->modcod],
+						   sched->facteurEMA[solution->modcod]); 
+	       sched->etats[m][q].deriveeAJour = 0;
 	       if (schedACM_getQoS(sched, m, q)->bwProbe)
                   probe_sample(schedACM_getQoS(sched, m, q)->bwProbe, schedACM_getQoS(sched, m, q)->debit);
 
@@ -534,10 +1014,9 @@ struct PDU_t * schedACM_buildBBRFRAMEFromRemplissage(struct schedACM_t * sched,
          assert(solution->modcod >= 0);
          assert(solution->modcod < schedACM_getNbModCod(sched));
 
-         // Attention, on passe l'indice du MODCOD en champs privé de la PDU
-         // récupéré en particulier dans DVBS2ll_sendPDU. C'est pas
-         // top, il  faudra plutôt faire une file par MODCOD
-         pdu = PDU_create(vol, (void *)(long)solution->modcod);
+         // Le MODCOD (solution->modcod) accompagne la trame jusqu'au
+         // lien, cf schedACM_provideFrames
+         pdu = PDU_create(vol, NULL);
       }
       return pdu;
 }
@@ -548,7 +1027,7 @@ struct PDU_t * schedACM_buildBBRFRAMEFromRemplissage(struct schedACM_t * sched,
  * Construction d'une BBFRAME avec les paquets en attente dans les
  * files s'il y en a suffisemment. Sinon, un pointeur NULL est retourné.
  */
-struct PDU_t * schedACM_buildBBFRAMEGeneric(struct schedACM_t * sched)
+struct PDU_t * schedACM_buildBBFRAMEGeneric(struct schedACM_t * sched, int * modcod)
 {
   /*
    int q, m, p, vol, s;
@@ -571,6 +1050,7 @@ struct PDU_t * schedACM_buildBBFRAMEGeneric(struct schedACM_t * sched)
       // solutionChoisie. On construit une PDU fondée sur cette
       // solution
       pdu = schedACM_buildBBRFRAMEFromRemplissage(sched, &sched->solutionChoisie);
+      *modcod = sched->solutionChoisie.modcod;
        
       /*
       // Si on trouve au moins un paquet à envoyer
@@ -634,7 +1114,7 @@ struct PDU_t * schedACM_buildBBFRAMEGeneric(struct schedACM_t * sched)
  * Construction d'une BBFRAME avec les paquets en attente dans les
  * files s'il y en a suffisemment. Sinon, un pointeur NULL est retourné.
  */
-struct PDU_t * schedACM_buildBBFRAMEGenericBatch(struct schedACM_t * sched)
+struct PDU_t * schedACM_buildBBFRAMEGenericBatch(struct schedACM_t * sched, int * modcod)
 {
    struct PDU_t * pdu = NULL;
    int r;
@@ -676,6 +1156,7 @@ struct PDU_t * schedACM_buildBBFRAMEGenericBatch(struct schedACM_t * sched)
    if (sched->sequenceChoisie.nextFrameToSend < sched->sequenceChoisie.positionActuelle) {
       printf_debug(DEBUG_ACM, "There is one ...\n");
       pdu = schedACM_buildBBRFRAMEFromRemplissage(sched, &(sched->sequenceChoisie.remplissages[sched->sequenceChoisie.nextFrameToSend]));
+      *modcod = sched->sequenceChoisie.remplissages[sched->sequenceChoisie.nextFrameToSend].modcod;
       printf_debug(DEBUG_ACM, "On incremente pour plus tard ...\n");
       sched->sequenceChoisie.nextFrameToSend++;
       // Si on vient de consommer la dernière, il faut invalider la
@@ -699,19 +1180,53 @@ struct PDU_t * schedACM_buildBBFRAMEGenericBatch(struct schedACM_t * sched)
  * Construction d'une BBFRAME avec les paquets en attente dans les
  * files s'il y en a suffisemment. Sinon, un pointeur NULL est retournÃ©.
  */
-struct PDU_t * schedACM_buildBBFRAME(struct schedACM_t * sched)
+struct PDU_t * schedACM_buildBBFRAME(struct schedACM_t * sched, int * modcod)
 {
    if (sched->func && sched->func->buildBBFRAME) {
       printf_debug(DEBUG_ACM, "calling dedicated facility ...\n");
-      return sched->func->buildBBFRAME(sched->private);
+      return sched->func->buildBBFRAME(sched->private, modcod);
    } else {
       if (sched->func->batch) {
          printf_debug(DEBUG_ACM, "calling generic batch facility ...\n");
-         return schedACM_buildBBFRAMEGenericBatch(sched);
+         return schedACM_buildBBFRAMEGenericBatch(sched, modcod);
       } else {
          printf_debug(DEBUG_ACM, "calling generic facility ...\n");
-         return schedACM_buildBBFRAMEGeneric(sched);
+         return schedACM_buildBBFRAMEGeneric(sched, modcod);
+      }
+   }
+}
+
+/*
+ * Remise au lien d'au plus nbTramesAvance BBFRAMEs, dans la limite de
+ * ce qu'il peut accepter. Fonction invoquée par le lien lorsqu'il n'a
+ * plus rien à émettre.
+ */
+void schedACM_provideFrames(struct schedACM_t * sched)
+{
+   struct PDU_t * pdu;
+   int n, mc;
+
+   for (n = 0; (n < sched->nbTramesAvance)
+	   && (DVBS2ll_framesFree(schedACM_getACMLink(sched)) > 0); n++) {
+      pdu = schedACM_getPDU(sched, &mc);
+      if (pdu == NULL) {
+         break;
       }
+      DVBS2ll_sendFrame(schedACM_getACMLink(sched), pdu, mc);
+   }
+}
+
+/*
+ * Nombre de BBFRAMEs construites d'avance
+ */
+void schedACM_setFramesAhead(struct schedACM_t * sched, int n)
+{
+   assert(n > 0);
+
+   sched->nbTramesAvance = n;
+   // Le lien doit pouvoir les garder, en plus de celle en cours
+   if (n > 1) {
+      DVBS2ll_setFrameQueueLength(schedACM_getACMLink(sched), n);
    }
 }
 
@@ -726,8 +1241,6 @@ struct PDU_t * schedACM_buildBBFRAME(struct schedACM_t * sched)
 int schedACM_processPDUGeneric(struct schedACM_t * sched,
                                 getPDU_t getPDU, void * source)
 {
-   struct PDU_t * pdu;
-
    // Si c'est juste pour tester si je suis pret
    if ((getPDU == NULL) || (source == NULL)) {
       printf_debug(DEBUG_ALWAYS, "getPDU/source should not be NULL\n");
@@ -741,12 +1254,16 @@ int schedACM_processPDUGeneric(struct schedACM_t * sched,
    // Si par hasard le support est dispo, il faut prendre l'initiative
    if (DVBS2ll_available(schedACM_getACMLink(sched))) {
       printf_debug(DEBUG_ACM, "Support libre\n");
-      pdu = schedACM_buildBBFRAME(sched);
-      // WARNING TBD remplacer par le modÃ¨le classique (destination, ...)
-      DVBS2ll_sendPDU(schedACM_getACMLink(sched), pdu);
+      schedACM_provideFrames(sched);
+      // Rien à émettre : on lance tout de même le support (DUMMY)
+      if (DVBS2ll_available(schedACM_getACMLink(sched))) {
+         DVBS2ll_sendFrame(schedACM_getACMLink(sched), NULL, 0);
+      }
    } else { // Je me le note pour êre prêt lorsque le support sera dispo
       sched->paquetsEnAttente = 1;    //WARNING, pourquoi uniquement dans ce cas !?
       printf_debug(DEBUG_ACM, "Support occupe\n");
+      // S'il est inactif, il doit se réveiller pour nous solliciter
+      DVBS2ll_wakeUp(schedACM_getACMLink(sched));
    }
    return 0; // ?
 }
@@ -764,14 +1281,14 @@ int schedACM_processPDUGeneric(struct schedACM_t * sched,
  * Elle se contente de faire appel à la fonction de création d'une
  * BBFRAME.
  */
-struct PDU_t * schedACM_getPDUGeneric(struct schedACM_t * sched)
+struct PDU_t * schedACM_getPDUGeneric(struct schedACM_t * sched, int * modcod)
 {
    struct PDU_t * result;
 
    printf_debug(DEBUG_ACM, "Le destinataire veut une BBFRAME\n");
 
    // L'ordonnanceur nous en produit-il une ?
-   result = schedACM_buildBBFRAME(sched);
+   result = schedACM_buildBBFRAME(sched, modcod);
 
    return result;
 }
@@ -781,14 +1298,20 @@ struct PDU_t * schedACM_getPDUGeneric(struct schedACM_t * sched)
  * Fonction Ã  invoquer lorsque le support est libre afin de solliciter
  * la construction d'une nouvelle BBFRAME
  */
-struct PDU_t * schedACM_getPDU(struct schedACM_t * sched)
+struct PDU_t * schedACM_getPDU(struct schedACM_t * sched, int * modcod)
 {
+   int mc;
+
+   // Le MODCOD peut ne pas intéresser l'appelant
+   if (modcod == NULL) {
+      modcod = &mc;
+   }
    if (sched->func && sched->func->getPDU) {
       printf_debug(DEBUG_ACM, "calling dedicated facility ...\n");
-      return sched->func->getPDU(sched->private);
+      return sched->func->getPDU(sched->private, modcod);
    } else {
       printf_debug(DEBUG_ACM, "calling generic facility ...\n");
-      return schedACM_getPDUGeneric(sched);
+      return schedACM_getPDUGeneric(sched, modcod);
    }
 }
 
@@ -830,7 +1353,7 @@ void schedACM_afficherFiles(struct schedACM_t * sched, int mc)
 	printf_debug(DEBUG_SCHED, "    QoS %d (%d PDUs)\n", q, filePDU_length(schedACM_getInputQueue(sched, m, q)));
 	 for (n = 1; n <= filePDU_length(schedACM_getInputQueue(sched, m, q)); n++) {
             id = filePDU_id_PDU_n(schedACM_getInputQueue(sched, m, q), n);
-            taille = filePDU_size_PDU_n(schedACM_getInputQueue(sched, m, q), n);
+            taille = schedACM_getPDUSize(sched, m, q, n);
             printf_debug(DEBUG_SCHED, "      [%d] : PDU %d (taille %d)\n", n, id, 
 			 taille);
          }
@@ -864,24 +1387,71 @@ void schedACM_printFilesSummary(struct schedACM_t * sched)
 /*   Gestion des remplissages                                                     */
 /**********************************************************************************/
 
+/*
+ * Les nombres de paquets d'un tableau de remplissages sont stockés
+ * dans un bloc unique, aligné sur une ligne de cache : les nbR
+ * matrices (nbModCod x nbQoS) s'y suivent. Le champ nbrePaquets de
+ * chaque remplissage pointe sur ses lignes, on peut donc toujours
+ * écrire nbrePaquets[m][q], mais copies et remises à zéro se font
+ * d'un seul memcpy/memset.
+ *
+ * Les blocs libérés sont conservés dans une liste (comme les PDUs)
+ * et réutilisés par les allocations suivantes de mêmes dimensions,
+ * typiquement d'une époque à l'autre.
+ */
+#define REMPLISSAGE_ALIGNEMENT 64
+
+struct remplissage_bloc_t {
+   int    nbR, nbModCod, nbQoS;
+   int ** lignes;   //!< nbR*nbModCod pointeurs de lignes
+   int  * paquets;  //!< nbR*nbModCod*nbQoS entiers, alignés
+   struct remplissage_bloc_t * suivant; //!< Dans la liste des blocs libres
+};
+
+static struct remplissage_bloc_t * premierBlocLibre = NULL;
+
+/*
+ * Obtention d'un bloc, recyclé si possible
+ */
+static struct remplissage_bloc_t * remplissage_blocAlloc(int nbR, int nbModCod, int nbQoS)
+{
+   struct remplissage_bloc_t * bloc;
+   struct remplissage_bloc_t ** prec;
+   void * paquets = NULL;
+
+   for (prec = &premierBlocLibre; *prec; prec = &((*prec)->suivant)) {
+      bloc = *prec;
+      if ((bloc->nbR == nbR) && (bloc->nbModCod == nbModCod) && (bloc->nbQoS == nbQoS)) {
+         *prec = bloc->suivant;
+         return bloc;
+      }
+   }
+
+   bloc = (struct remplissage_bloc_t *)sim_malloc(sizeof(struct remplissage_bloc_t));
+   bloc->nbR = nbR;
+   bloc->nbModCod = nbModCod;
+   bloc->nbQoS = nbQoS;
+   bloc->lignes = (int **)sim_malloc(nbR*nbModCod*sizeof(int *));
+   if (posix_memalign(&paquets, REMPLISSAGE_ALIGNEMENT, nbR*nbModCod*nbQoS*sizeof(int))) {
+      motSim_error(MS_FATAL, "Allocation de %d remplissages impossible\n", nbR);
+   }
+   bloc->paquets = (int *)paquets;
+
+   return bloc;
+}
+
 /*
  * Remise Ã  zÃ©ro. On doit pouvoir faire plus efficace (tout n'est pas utilisÃ©)
  */
 void remplissage_raz(t_remplissage * tr, int nbModCod, int nbQoS)
 {
-   int  m, q;
-
    tr->modcod = -1;
    tr->volumeTotal = 0;
    tr->interet = 0.0;
    tr->nbChoix = 1;
    tr->casTraite = 0;
 
-   for (m = 0; m < nbModCod; m++) {
-      for (q = 0; q < nbQoS; q++) {
-         tr->nbrePaquets[m][q] = 0;
-      }
-   }
+   memset(tr->nbrePaquets[0], 0, nbModCod*nbQoS*sizeof(int));
 }
 
 /*
@@ -889,35 +1459,13 @@ void remplissage_raz(t_remplissage * tr, int nbModCod, int nbQoS)
  */
 void remplissage_init(t_remplissage * tr, int nbModCod, int nbQoS)
 {
-   int  m;
-
-   //printf_debug(DEBUG_KS, "m/c = %d/%d\n", nbModCod, nbQoS);
-
-   nbRemplissageAlloc++;
-
-   assert(tr);
-
-   tr->nbrePaquets = (int **)sim_malloc(nbModCod*sizeof(int *));
-   assert(tr->nbrePaquets);
-
-   for (m = 0; m < nbModCod; m++) {
-      tr->nbrePaquets[m] = (int *)sim_malloc(nbQoS*sizeof(int));
-      assert(tr->nbrePaquets[m]);
-   }
-
-   remplissage_raz(tr, nbModCod, nbQoS);
-
-   //printf_debug(DEBUG_KS, "m/c = %d/%d done\n", nbModCod, nbQoS);
+   tabRemplissage_init(tr, 1, nbModCod, nbQoS);
 }
 
 
 void remplissage_free(t_remplissage * tr, int nbModCod)
 {
-   int  m;
-   nbRemplissageFree ++;
-   for (m = 0; m < nbModCod; m++) {
-      free( tr->nbrePaquets[m]);
-   }
+   tabRemplissage_free(tr, 1);
 }
 
 
@@ -938,20 +1486,57 @@ int remplissage_nbPackets(t_remplissage * tr, int m, int q)
  */
 void tabRemplissage_init(t_remplissage * tr, int nbR, int nbModCod, int nbQoS)
 {
-   int r;
+   struct remplissage_bloc_t * bloc = remplissage_blocAlloc(nbR, nbModCod, nbQoS);
+   int r, l;
+
+   nbRemplissageAlloc += nbR;
 
+   for (l = 0; l < nbR*nbModCod; l++) {
+      bloc->lignes[l] = bloc->paquets + l*nbQoS;
+   }
    for (r = 0; r < nbR; r++) {
-      remplissage_init(tr + r, nbModCod, nbQoS);
+      tr[r].nbrePaquets = bloc->lignes + r*nbModCod;
+      tr[r].bloc = bloc;
    }
+
+   tabRemplissage_raz(tr, nbR, nbModCod, nbQoS);
 }
 
+/*
+ * Remise à zéro des nbR premiers remplissages d'un tableau
+ */
 void tabRemplissage_raz(t_remplissage * tr, int nbR, int nbModCod, int nbQoS)
 {
    int r;
 
+   if (nbR <= 0) {
+      return;
+   }
    for (r = 0; r < nbR; r++) {
-      remplissage_raz(&tr[r], nbModCod, nbQoS);
+      tr[r].modcod = -1;
+      tr[r].volumeTotal = 0;
+      tr[r].interet = 0.0;
+      tr[r].nbChoix = 1;
+      tr[r].casTraite = 0;
    }
+   // Les matrices d'un même tableau sont contigües
+   assert(tr[nbR-1].nbrePaquets[0] == tr[0].nbrePaquets[0] + (nbR-1)*nbModCod*nbQoS);
+   memset(tr[0].nbrePaquets[0], 0, nbR*nbModCod*nbQoS*sizeof(int));
+}
+
+/*
+ * Libération d'un tableau de solutions, dont le bloc est conservé
+ * pour une allocation ultérieure
+ */
+void tabRemplissage_free(t_remplissage * tr, int nbR)
+{
+   struct remplissage_bloc_t * bloc = tr[0].bloc;
+
+   assert(bloc->nbR == nbR);
+   nbRemplissageFree += nbR;
+
+   bloc->suivant = premierBlocLibre;
+   premierBlocLibre = bloc;
 }
 
 /*
@@ -960,25 +1545,14 @@ void tabRemplissage_raz(t_remplissage * tr, int nbR, int nbModCod, int nbQoS)
  */
 void remplissage_copy(t_remplissage * src, t_remplissage * dst, int nbModCod, int nbQoS)
 {
-   int m, q;
-
-   //   printf_debug(DEBUG_SCHED, "IN\n");
    dst->modcod = src->modcod;
    dst->volumeTotal = src->volumeTotal;
    dst->interet = src->interet;
    dst->nbChoix = src->nbChoix;   // Attention au piège
    dst->casTraite = src->casTraite;
-   for (m = 0; m < nbModCod; m++) {
-     //      printf_debug(DEBUG_SCHED, "  m = %d\n", m);
-      assert(src->nbrePaquets[m]);
-      assert(dst->nbrePaquets[m]);
-      for (q = 0; q < nbQoS; q++) {
-	//         printf_debug(DEBUG_SCHED, "     q = %d\n", q);
-         dst->nbrePaquets[m][q] = src->nbrePaquets[m][q];
-      }
-   }
-   //   printf_debug(DEBUG_SCHED, "OUT\n");
+   memcpy(dst->nbrePaquets[0], src->nbrePaquets[0], nbModCod*nbQoS*sizeof(int));
 }
+
 /**
  * @brief Initialisation d'une séquence
  */
@@ -991,6 +1565,15 @@ void sequence_init(t_sequence * seq, int lgMax, int nbModCod, int nbQoS)
    tabRemplissage_init(seq->remplissages, lgMax, nbModCod, nbQoS);
 }
 
+/**
+ * @brief Libération d'une séquence
+ */
+void sequence_free(t_sequence * seq)
+{
+   tabRemplissage_free(seq->remplissages, seq->longueur);
+   free(seq->remplissages);
+}
+
 /**
  * @brief Remise à zéro d'une séquence
  */
@@ -1018,21 +1601,20 @@ void sequence_copy(t_sequence * src, t_sequence * dst, int nbModCod, int nbQoS)
 {
    int r;
 
-   //   printf_debug(DEBUG_SCHED, "IN\n");
    dst->longueur = src->longueur;
    dst->positionActuelle = src->positionActuelle;
-   /*
-   printf_debug(DEBUG_SCHED, "l%d, p%d (m%d, q%d)\n",
-		dst->longueur,
-		dst->positionActuelle,
-		nbModCod,
-		nbQoS);
-   */
    for (r = 0 ; r < dst->positionActuelle ; r++) {
-     //      printf_debug(DEBUG_SCHED, "copie de %d\n", r);
-      remplissage_copy(&(src->remplissages[r]), &(dst->remplissages[r]), nbModCod, nbQoS);
-   }   
-   //   printf_debug(DEBUG_SCHED, "OUT\n");
+      dst->remplissages[r].modcod = src->remplissages[r].modcod;
+      dst->remplissages[r].volumeTotal = src->remplissages[r].volumeTotal;
+      dst->remplissages[r].interet = src->remplissages[r].interet;
+      dst->remplissages[r].nbChoix = src->remplissages[r].nbChoix;
+      dst->remplissages[r].casTraite = src->remplissages[r].casTraite;
+   }
+   // Les matrices des remplissages d'une séquence sont contigües
+   if (dst->positionActuelle > 0) {
+      memcpy(dst->remplissages[0].nbrePaquets[0], src->remplissages[0].nbrePaquets[0],
+	     dst->positionActuelle*nbModCod*nbQoS*sizeof(int));
+   }
 }
 
 /**
@@ -1139,7 +1721,7 @@ int sequence_getTotalSize(t_sequence * seq, struct schedACM_t * sched)
       for (q = 0; q < sched->nbQoS; q++) {
 	// 	printf_debug(DEBUG_SCHED, "   [q%d]\n", q);
 	// 	printf_debug(DEBUG_SCHED, "     + (%d, %d) (nb %d)\n", m, q, sequence_nbPackets(seq, m, q));
-         result += filePDU_size_n_PDU(sched->files[m][q], sequence_nbPackets(seq, m, q));
+         result += schedACM_getCumulatedSize(sched, m, q, sequence_nbPackets(seq, m, q));
 	 // 	printf_debug(DEBUG_SCHED, "     -> %d\n", result);
       }
    }
@@ -1159,7 +1741,7 @@ int sequence_getTotalSize(t_sequence * seq, struct schedACM_t * sched)
  */ 
 int sequence_getFileSize(t_sequence * seq, struct schedACM_t * sched, int m, int q)
 {
-   return filePDU_size_n_PDU(sched->files[m][q], sequence_nbPackets(seq, m, q));
+   return schedACM_getCumulatedSize(sched, m, q, sequence_nbPackets(seq, m, q));
 }
 
 /**
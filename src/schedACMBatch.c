@@ -19,6 +19,10 @@
 struct schedACMBatch_t {
    struct schedACM_t * schedACM;
    int mode;
+
+   // Les tableaux de travail (nbModCod x nbQoS) de l'algorithme
+   double ** poids;
+   int    ** deficitBitSize;
 };
 
 /*
@@ -47,8 +51,8 @@ void schedulerBatchOnePass(struct schedACMBatch_t * sched, int mode)
 
    int qb, qbBase, qbIdx;
 
-   double poids[NB_MODCOD_MAX][3];   // WARNING
-   int  deficitBitSize[NB_MODCOD_MAX][3];   // WARNING
+   double ** poids = sched->poids;
+   int    ** deficitBitSize = sched->deficitBitSize;
    int cumulSurMC; // Pour evalue le nombre de trames
    double  nbTrames;		     // nécessaires sur un MC (à supprimer)
    double sommePoids;
@@ -65,11 +69,6 @@ void schedulerBatchOnePass(struct schedACMBatch_t * sched, int mode)
    // travailler directement sur celle de l'ordonnanceur
    sequence = schedACM_getSequenceChoisie(sched->schedACM);
 
-   if ((schedACM_getNbModCod(sched->schedACM)> NB_MODCOD_MAX) 
-     || (schedACM_getNbQoS(sched->schedACM) > 3)) {
-       motSim_error(MS_FATAL, "ERREUR DE DIMENSIONNEMENT");
-   }
-
    // 1 - On commence par calculer le poids de chaque file, qui
    // provient directement de l'utilité
    sommePoids = 0.0;
@@ -79,15 +78,11 @@ void schedulerBatchOnePass(struct schedACMBatch_t * sched, int mode)
       for (q = 0; q < schedACM_getNbQoS(sched->schedACM); q++) {
          if ( filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)) > 0) {
             printf_debug(DEBUG_SCHED, "derivee[%d, %d] = %f (débit = %lf)\n", m, q,
-		      utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-				     schedACM_getQoS(sched->schedACM, m, q)->debit,
-				     schedACM_getACMLink(sched->schedACM)),
+		      schedACM_getDerivee(sched->schedACM, m, q),
 		      schedACM_getQoS(sched->schedACM, m, q)->debit);
 
             if (mode == schedBatchModeUtil){
-               poids[m][q] = utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-				      schedACM_getQoS(sched->schedACM, m, q)->debit,
-				      schedACM_getACMLink(sched->schedACM));
+               poids[m][q] = schedACM_getDerivee(sched->schedACM, m, q);
 	    } else if (mode == schedBatchModeLength) {
                poids[m][q] = filePDU_size(schedACM_getInputQueue(sched->schedACM, m, q));
 	    } else if (mode == schedBatchModeDuration) {
@@ -209,21 +204,18 @@ void schedulerBatchOnePass(struct schedACMBatch_t * sched, int mode)
 			      (sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
 			       + sequence_nbPackets(sequence, m, qb)+1
 			       > filePDU_length(schedACM_getInputQueue(sched->schedACM, m, qb))?0
-			       :(filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, qb),
-						    sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
+			       :(schedACM_getPDUSize(sched->schedACM, m, qb, sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
 						    + sequence_nbPackets(sequence, m, qb)+1))),
 			       DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), m)/8 - sequence->remplissages[sequence->positionActuelle].volumeTotal);
 		 while ((sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
                  + sequence_nbPackets(sequence, m, qb)
 			 < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, qb)))
-			&& (filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, qb),
-                                     sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
+			&& (schedACM_getPDUSize(sched->schedACM, m, qb, sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
 					       + sequence_nbPackets(sequence, m, qb)+1)
 			    + sequence->remplissages[sequence->positionActuelle].volumeTotal
                             <= DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), m)/8))
 		   {
-                      taille = filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, qb),
-                                     sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
+                      taille = schedACM_getPDUSize(sched->schedACM, m, qb, sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]
 						  + sequence_nbPackets(sequence, m, qb)+1);
                       // Je place le paquet dans le remplissage
                       sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][qb]++;
@@ -258,8 +250,7 @@ void schedulerBatchOnePass(struct schedACMBatch_t * sched, int mode)
 	  ){
          printf_debug(DEBUG_SCHED, "Nous allons prendre un paquet pour m=%d, q=%d (deficit %d)\n", m, q,  deficitBitSize[m][q]);
          // Je détermine la taille du prochain paquet à prendre
-         taille = filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-                                     sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][q]
+         taille = schedACM_getPDUSize(sched->schedACM, m, q, sequence->remplissages[sequence->positionActuelle].nbrePaquets[m][q]
                                    + sequence_nbPackets(sequence, m, q)+1);
          printf_debug(DEBUG_SCHED, "Taille du paquet : %d\n", taille);
 
@@ -380,6 +371,8 @@ static struct schedACM_func_t schedACMBatch_func = {
 struct schedACM_t * schedACMBatch_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, int declOK, int seqLgMax, int mode)
 {
    struct schedACMBatch_t * result = (struct schedACMBatch_t * ) sim_malloc(sizeof(struct schedACMBatch_t));
+   int m;
+
    assert(result);
    assert(declOK == 0);
 
@@ -388,6 +381,16 @@ struct schedACM_t * schedACMBatch_create(struct DVBS2ll_t * dvbs2ll, int nbQoS,
    schedACM_setPrivate(result->schedACM, result);
    schedACM_setSeqLgMax(result->schedACM, seqLgMax);
 
+   // Les tableaux de travail sont dimensionnés selon le lien
+   result->poids = (double **)sim_malloc(DVBS2ll_nbModcod(dvbs2ll)*sizeof(double *));
+   result->deficitBitSize = (int **)sim_malloc(DVBS2ll_nbModcod(dvbs2ll)*sizeof(int *));
+   assert(result->poids && result->deficitBitSize);
+   for (m = 0; m < DVBS2ll_nbModcod(dvbs2ll); m++) {
+      result->poids[m] = (double *)sim_malloc(nbQoS*sizeof(double));
+      result->deficitBitSize[m] = (int *)sim_malloc(nbQoS*sizeof(int));
+      assert(result->poids[m] && result->deficitBitSize[m]);
+   }
+
    printf_debug(DEBUG_SCHED, "%p created (in schedACM %p)\n", result, result->schedACM);
 
    return result->schedACM;
@@ -29,8 +29,65 @@
  */
 struct schedUtility_t {
    struct schedACM_t * schedACM;
+
+   // Chaque MODCOD est traité indépendamment (voir
+   // schedACM_solveAllModcods) : il a son propre remplissage et son
+   // propre générateur pour le choix aléatoire de la première file
+   t_remplissage  * remplissages;
+   unsigned short * graines;      //!< 3 par MODCOD, pour nrand48
+
+   // poids[mc] est la matrice (nbModCod x nbQoS) des poids utilisée
+   // lors de la recherche sur le MODCOD mc
+   double        *** poids;
 };
 
+/*
+ * Allocation des matrices de poids, dimensionnées par le nombre de
+ * MODCODs et de QoS de l'ordonnanceur
+ */
+static void schedUtility_initPoids(struct schedUtility_t * sched)
+{
+   int nbModCod = schedACM_getNbModCod(sched->schedACM);
+   int mc, m;
+
+   sched->poids = (double ***)sim_malloc(nbModCod*sizeof(double **));
+   assert(sched->poids);
+   for (mc = 0; mc < nbModCod; mc++) {
+      sched->poids[mc] = (double **)sim_malloc(nbModCod*sizeof(double *));
+      assert(sched->poids[mc]);
+      for (m = 0; m < nbModCod; m++) {
+         sched->poids[mc][m] = (double *)sim_malloc(schedACM_getNbQoS(sched->schedACM)*sizeof(double));
+         assert(sched->poids[mc][m]);
+      }
+   }
+}
+
+/*
+ * Allocation des données utilisées par MODCOD
+ */
+static void schedUtility_initMC(struct schedUtility_t * sched)
+{
+   int nbModCod = schedACM_getNbModCod(sched->schedACM);
+
+   sched->remplissages = (t_remplissage *)sim_malloc(nbModCod*sizeof(t_remplissage));
+   assert(sched->remplissages);
+   tabRemplissage_init(sched->remplissages, nbModCod, nbModCod, schedACM_getNbQoS(sched->schedACM));
+   sched->graines = (unsigned short *)sim_malloc(3*nbModCod*sizeof(unsigned short));
+   assert(sched->graines);
+}
+
+/*
+ * Tirage (séquentiel, donc reproductible) des graines de chaque MODCOD
+ */
+static void schedUtility_tirerGraines(struct schedUtility_t * sched)
+{
+   int i;
+
+   for (i = 0; i < 3*schedACM_getNbModCod(sched->schedACM); i++) {
+      sched->graines[i] = (unsigned short)random();
+   }
+}
+
 void schedulerUtility(struct schedUtility_t * sched);
 
 /**
@@ -61,6 +118,8 @@ struct schedACM_t * schedUtility_create(struct DVBS2ll_t * dvbs2ll, int nbQoS, i
 
    result->schedACM = schedACM_create(dvbs2ll, nbQoS, declOK, &schedUtility_func);
    schedACM_setPrivate(result->schedACM, result);
+   schedUtility_initMC(result);
+   schedUtility_initPoids(result);
 
    printf_debug(DEBUG_SCHED, "%p created (in schedACM %p)\n", result, result->schedACM);
 
@@ -83,10 +142,8 @@ void schedUtil_afficherFiles(struct schedUtility_t * sched, int mc)
 	printf_debug(DEBUG_ALWAYS, "    QoS %d (%d PDUs)\n", q, filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)));
 	 for (n = 1; n <= filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)); n++) {
             id = filePDU_id_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), n);
-            taille = filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), n);
-	    deriv = utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-						  schedACM_getQoS(sched->schedACM, m, q)->debit,
-				   schedACM_getACMLink(sched->schedACM));
+            taille = schedACM_getPDUSize(sched->schedACM, m, q, n);
+	    deriv = schedACM_getDerivee(sched->schedACM, m, q);
             printf_debug(DEBUG_ALWAYS, "      [%d] : PDU %d (taille %d, deriv %e)\n", n, id, 
 			 taille, 
 			 deriv);
@@ -103,6 +160,7 @@ void schedUtil_afficherFiles(struct schedUtility_t * sched, int mc)
  * ordonnancenment
  * @param remplissage (out) Le remplisssage de BBFRAME proposé par
  * cette fonction
+ * @param executant Le numéro de l'exécutant (inutilisé)
  * 
  * L'algorithme est le suivant. On cherche la file avec la plus forte
  * contribution à l'utilité globale et on envoie tout ce que l'on peut
@@ -112,7 +170,7 @@ void schedUtil_afficherFiles(struct schedUtility_t * sched, int mc)
  * qui est prise en compte, puisque elle n'est pas multipliée par la
  * taille de la file. On ne favorise donc pas les gros débits.
  */
-void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * remplissage)
+void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * remplissage, int executant)
 {
    int bestQoS = 0;   
    int bestMC = mc;
@@ -131,7 +189,7 @@ void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * r
 
          // On démarre la boucle aléatoirement pour éviter un biais en
          // cas d'égalité
-         qb = random()%schedACM_getNbQoS(sched->schedACM);
+         qb = nrand48(sched->graines + 3*mc)%schedACM_getNbQoS(sched->schedACM);
          for (qa = 0; qa < schedACM_getNbQoS(sched->schedACM); qa++) {
             q = (qa + qb)%schedACM_getNbQoS(sched->schedACM);
 
@@ -142,35 +200,27 @@ void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * r
 			 remplissage->nbrePaquets[m][q],
 			 filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)),
 			 schedACM_getQoS(sched->schedACM, m, q)->debit,
-			 utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-					schedACM_getQoS(sched->schedACM, m, q)->debit,
-					schedACM_getACMLink(sched->schedACM)));
+			 schedACM_getDerivee(sched->schedACM, m, q));
 
             // Cette file peut-elle fournir au moins un paquet
             // (première clause) qui tienne (deuxième) ?
             if ((remplissage->nbrePaquets[m][q] < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))) // Il en reste un
-		&& (remplissage->volumeTotal + filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1)
+		&& (remplissage->volumeTotal + schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1)
                     <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))) {
 	      schedACM_tryingNewSolution(sched->schedACM); // On compte les solutions envisagées
 	       // Si oui, est-elle la première ou, sinon, plus intéressante que la plus
 	       // intéressante ?
 	       if ((paquetDispo == 0)
-                || (remplissage->interet < utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-						  schedACM_getQoS(sched->schedACM, m, q)->debit,
-						  schedACM_getACMLink(sched->schedACM)))){
+                || (remplissage->interet < schedACM_getDerivee(sched->schedACM, m, q))){
                   paquetDispo = 1;
       		  bestMC = m;
 		  bestQoS = q;
 
   		  printf_debug(DEBUG_NEVER, "Meilleur interet pour le moment : %f (was %f)\n",
-			 utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-					schedACM_getQoS(sched->schedACM, m, q)->debit,
-					schedACM_getACMLink(sched->schedACM)),
+			 schedACM_getDerivee(sched->schedACM, m, q),
 			 remplissage->interet);
 
-		  remplissage->interet = utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-						schedACM_getQoS(sched->schedACM, m, q)->debit,
-						schedACM_getACMLink(sched->schedACM));
+		  remplissage->interet = schedACM_getDerivee(sched->schedACM, m, q);
 	       }
 	    }
 	 }
@@ -180,12 +230,10 @@ void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * r
       //      printf_debug(DEBUG_SCHED, "On rempli ...\n");
       while ((remplissage->nbrePaquets[bestMC][bestQoS]
                < filePDU_length(schedACM_getInputQueue(sched->schedACM, bestMC, bestQoS))) // Il en reste un
-	  && (remplissage->volumeTotal + filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, bestMC, bestQoS),
-							   remplissage->nbrePaquets[bestMC][bestQoS]+1)
+	  && (remplissage->volumeTotal + schedACM_getPDUSize(sched->schedACM, bestMC, bestQoS, remplissage->nbrePaquets[bestMC][bestQoS]+1)
                     <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))) {
 	 remplissage->volumeTotal += 
-            filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM,
-						      bestMC, bestQoS), remplissage->nbrePaquets[bestMC][bestQoS]+1);
+            schedACM_getPDUSize(sched->schedACM, bestMC, bestQoS, remplissage->nbrePaquets[bestMC][bestQoS]+1);
          remplissage->nbrePaquets[bestMC][bestQoS]++;
       } 
       //      printf("%d pq de [%d][%d] (vol %d)\n", remplissage->nbrePaquets[bestMC][bestQoS], bestMC, bestQoS, remplissage->volumeTotal);
@@ -198,34 +246,35 @@ void schedulerUtilityMC(struct schedUtility_t * sched, int mc, t_remplissage * r
  */
 void schedulerUtility(struct schedUtility_t * sched)
 {
-   t_remplissage remplissage; // Le remplissage construit ici
+   t_remplissage * remplissage; // Le remplissage construit pour chaque MODCOD
    int m;
 
-   remplissage_init(&remplissage, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+   // Chaque MODCOD est traité indépendamment, puis les solutions
+   // sont comparées dans l'ordre des MODCODs
+   schedUtility_tirerGraines(sched);
+   schedACM_solveAllModcods(sched->schedACM, (schedACM_solveMC_t)schedulerUtilityMC, sched->remplissages);
 
    for (m = 0; m < schedACM_getNbModCod(sched->schedACM) ; m++){
-      remplissage_raz(&remplissage, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
-      remplissage.modcod = m;
+      remplissage = &(sched->remplissages[m]);
 
-      printf_debug(DEBUG_SCHED, "Cherchons sur le modcod %d, avec les files suivantes\n", m);
+      printf_debug(DEBUG_SCHED, "Solution sur le modcod %d, avec les files suivantes\n", m);
 #ifdef DEBUG_NDES
       if (debug_mask&DEBUG_SCHED)
         schedUtil_afficherFiles(sched,  m);
 #endif
-      schedulerUtilityMC(sched, m, &remplissage);
 
       // N'a qqchose ?
-      if (remplissage.volumeTotal) {
+      if (remplissage->volumeTotal) {
 
          // C'est mieux si au moins une des affirmations suivantes est vraie
          //    on n'avait rien pour le moment (volumeTotal nul)
          //    l'interet de la nouvelle proposition est meilleur
 	 //    l'interet est le même, mais avec un plus gros volume
          if (   (schedACM_getSolution(sched->schedACM)->volumeTotal == 0)
-	       || (remplissage.interet > schedACM_getSolution(sched->schedACM)->interet)
-	       || (   (remplissage.interet == schedACM_getSolution(sched->schedACM)->interet)
-		 && (remplissage.volumeTotal > schedACM_getSolution(sched->schedACM)->volumeTotal))) {
-            remplissage_copy(&remplissage, schedACM_getSolution(sched->schedACM),
+	       || (remplissage->interet > schedACM_getSolution(sched->schedACM)->interet)
+	       || (   (remplissage->interet == schedACM_getSolution(sched->schedACM)->interet)
+		 && (remplissage->volumeTotal > schedACM_getSolution(sched->schedACM)->volumeTotal))) {
+            remplissage_copy(remplissage, schedACM_getSolution(sched->schedACM),
 		       schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
             schedACM_getSolution(sched->schedACM)->modcod = m;
          }
@@ -245,6 +294,7 @@ void schedulerUtility(struct schedUtility_t * sched)
  * @param mc Le MODCOD à étudier dans cette fonction
  * @param remplissage La solution trouvée par cette fonction (en
  * entrée il doit avoir été mis à zéro, sauf son MODCOD).
+ * @param executant Le numéro de l'exécutant (inutilisé)
  *
  * Cette fonction recherche donc, pour un MODCOD donné, le "meilleur"
  * remplissage possible. Elle place son résultat dans la variable
@@ -254,22 +304,16 @@ void schedulerUtility(struct schedUtility_t * sched)
  * paquets entiers, on complète marginalement en ajoutant dans une
  * seconde phase des paquets depuis les files prises dans l'ordre.
  */
-void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage * remplissage)
+void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage * remplissage, int executant)
 {
    int bestQoS = 0;   
    int bestMC = mc;
-   double poids[NB_MODCOD_MAX][3];   // WARNING
+   double ** poids = sched->poids[mc];
    double sommePoids;
    double meilleurPoids=0.0;
    int m, qa, qb, q, ma, mb; // Indices des boucles
 
    printf_debug(DEBUG_SCHED, "IN\n");
-
-   if ((schedACM_getNbModCod(sched->schedACM)> NB_MODCOD_MAX) 
-     || (schedACM_getNbQoS(sched->schedACM) > 3)) {
-       printf("***\nERREUR DE DIM\n");
-       exit(1);  
-   }
    //   printf_debug(DEBUG_SCHED, "1 ... \n");
 
    // 1 - On commence par calculer l'utilité sur chaque file
@@ -278,9 +322,7 @@ void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage
    for (m = mc; m < (schedACM_getReclassification(sched->schedACM)?schedACM_getNbModCod(sched->schedACM):(mc+1)); m++) {
       //    Pour chaque file du modcod
       for (q = 0; q < schedACM_getNbQoS(sched->schedACM); q++) {
-         poids[m][q] = utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-				      schedACM_getQoS(sched->schedACM, m, q)->debit,
-				      schedACM_getACMLink(sched->schedACM));
+         poids[m][q] = schedACM_getDerivee(sched->schedACM, m, q);
 	 //         printf_debug(DEBUG_SCHED, "Poids[%d, %d] = %f (débit = %lf)\n", m, q,  poids[m][q], schedACM_getQoS(sched->schedACM, m, q)->debit);
 	 assert(poids[m][q]>=0);
          sommePoids += poids[m][q];
@@ -309,7 +351,7 @@ void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage
    for (m = mc; m < (schedACM_getReclassification(sched->schedACM)?schedACM_getNbModCod(sched->schedACM):(mc+1)); m++) {
      //      printf_debug(DEBUG_SCHED, "Lets try m = %d ...\n", m);
       //    Pour chaque file du modcod
-      qb = random()%schedACM_getNbQoS(sched->schedACM);
+      qb = nrand48(sched->graines + 3*mc)%schedACM_getNbQoS(sched->schedACM);
       for (qa = 0; qa < schedACM_getNbQoS(sched->schedACM); qa++) {
          q = (qa + qb)%schedACM_getNbQoS(sched->schedACM);
 	/*
@@ -317,39 +359,38 @@ void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage
          printf_debug(DEBUG_SCHED, "remplissage->nbrePaquets[m][q] = %d ...\n", remplissage->nbrePaquets[m][q]);
          printf_debug(DEBUG_SCHED, "filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)) = %d ...\n", filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)));
 	 if (filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))) {
-            printf_debug(DEBUG_SCHED, "filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1) = %d ...\n", filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1));
+            printf_debug(DEBUG_SCHED, "schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1) = %d ...\n", schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1));
             printf_debug(DEBUG_SCHED, "poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8) = %f ...\n", poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
-            printf_debug(DEBUG_SCHED, "remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1) = %d ...\n", remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1));
+            printf_debug(DEBUG_SCHED, "remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1) = %d ...\n", remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1));
             printf_debug(DEBUG_SCHED, "DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8 = %d ...\n", (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
 	 }
 	*/
          // Tant que (1) il reste un paquet  (2) qui tient dans la trame (3) que j'ai le droit d'émettre
 
 	while ((remplissage->nbrePaquets[m][q] < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))) // (1)
-               &&  (remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1) // (2)
+               &&  (remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1) // (2)
 		    <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))
 	       &&  // (3)
 	       (
 		 (   (propMod == propModDirect) 
 		 )||((propMod == propModProp) && (
-                     (filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1)
+                     (schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1)
                      <= poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8)) 
 						  )
 		 )
 		)){
 	  remplissage->nbrePaquets[m][q]++;
-          remplissage->volumeTotal += filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]);
+          remplissage->volumeTotal += schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]);
 	  /*
           printf_debug(DEBUG_SCHED, "   %d pq de %d/%d (volume %d -> cumul %d, reste %d sur %d)\n",
 		       remplissage->nbrePaquets[m][q],
 		       m, q,
-		       filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-					  remplissage->nbrePaquets[m][q]),
+		       schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]),
 		       remplissage->volumeTotal,
 		       (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8) - remplissage->volumeTotal,
 		       (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
 	  */
-	  remplissage->interet += (double)(filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q])) * poids[m][q]*sommePoids;
+	  remplissage->interet += (double)(schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q])) * poids[m][q]*sommePoids;
 	}
       }
    }
@@ -373,12 +414,10 @@ void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage
 
          while ((remplissage->nbrePaquets[m][q]
 		 < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))) // Il en reste un
-	  && (remplissage->volumeTotal + filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-							   remplissage->nbrePaquets[m][q]+1)
+	  && (remplissage->volumeTotal + schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1)
                     <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))) {
 	    remplissage->volumeTotal += 
-            filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM,
-						      m, q), remplissage->nbrePaquets[m][q]+1);
+            schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1);
             remplissage->nbrePaquets[m][q]++;
          }
       }
@@ -394,34 +433,35 @@ void schedulerUtilityMCProp(struct schedUtility_t * sched, int mc, t_remplissage
  */
 void schedulerUtilityProp(struct schedUtility_t * sched)
 {
-   t_remplissage remplissage; // Le remplissage construit ici
+   t_remplissage * remplissage; // Le remplissage construit pour chaque MODCOD
    int m,q;
 
-   remplissage_init(&remplissage, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+   // Chaque MODCOD est traité indépendamment, puis les solutions
+   // sont comparées dans l'ordre des MODCODs
+   schedUtility_tirerGraines(sched);
+   schedACM_solveAllModcods(sched->schedACM, (schedACM_solveMC_t)schedulerUtilityMCProp, sched->remplissages);
 
    for (m = 0; m < schedACM_getNbModCod(sched->schedACM) ; m++){
-      remplissage_raz(&remplissage, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
-      remplissage.modcod = m;
+      remplissage = &(sched->remplissages[m]);
 
-      printf_debug(DEBUG_SCHED, "Cherchons sur le modcod %d, avec les files suivantes\n", m);
+      printf_debug(DEBUG_SCHED, "Solution sur le modcod %d, avec les files suivantes\n", m);
 #ifdef DEBUG_NDES
       if (debug_mask&DEBUG_SCHED)
       schedUtil_afficherFiles(sched,  m);
 #endif
-      schedulerUtilityMCProp(sched, m, &remplissage);
 
       // N'a qqchose ?
-      if (remplissage.volumeTotal) {
+      if (remplissage->volumeTotal) {
 
          // C'est mieux si au moins une des affirmations suivantes est vraie
          //    on n'avait rien pour le moment (volumeTotal nul)
          //    l'interet de la nouvelle proposition est meilleur
 	 //    l'interet est le même, mais avec un plus gros volume
          if (   (schedACM_getSolution(sched->schedACM)->volumeTotal == 0)
-	       || (remplissage.interet > schedACM_getSolution(sched->schedACM)->interet)
-	       || (   (remplissage.interet == schedACM_getSolution(sched->schedACM)->interet)
-		 && (remplissage.volumeTotal > schedACM_getSolution(sched->schedACM)->volumeTotal))) {
-            remplissage_copy(&remplissage, schedACM_getSolution(sched->schedACM),
+	       || (remplissage->interet > schedACM_getSolution(sched->schedACM)->interet)
+	       || (   (remplissage->interet == schedACM_getSolution(sched->schedACM)->interet)
+		 && (remplissage->volumeTotal > schedACM_getSolution(sched->schedACM)->volumeTotal))) {
+            remplissage_copy(remplissage, schedACM_getSolution(sched->schedACM),
 		       schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
             schedACM_getSolution(sched->schedACM)->modcod = m;
          }
@@ -463,6 +503,8 @@ struct schedACM_t * schedUtilityProp_create(struct DVBS2ll_t * dvbs2ll, int nbQo
 
    result->schedACM = schedACM_create(dvbs2ll, nbQoS, declOK, &schedUtilityProp_func);
    schedACM_setPrivate(result->schedACM, result);
+   schedUtility_initMC(result);
+   schedUtility_initPoids(result);
 
    printf_debug(DEBUG_SCHED, "%p created (in schedACM %p)\n", result, result->schedACM);
 
@@ -495,19 +537,13 @@ void schedulerUtilityMCPropBatch(struct schedUtility_t * sched, int mc, t_sequen
 {
    int bestQoS = 0;   
    int bestMC = mc;
-   double poids[NB_MODCOD_MAX][3];   // WARNING
+   double ** poids = sched->poids[mc];
    double sommePoids;
    double meilleurPoids=0.0;
    int m, qa, qb, q, ma, mb; // Indices des boucles
    t_remplissage * remplissage = &sequence->remplissages[sequence->positionActuelle];
 
    printf_debug(DEBUG_SCHED, "IN\n");
-
-   if ((schedACM_getNbModCod(sched->schedACM)> NB_MODCOD_MAX) 
-     || (schedACM_getNbQoS(sched->schedACM) > 3)) {
-       printf("***\nERREUR DE DIM\n");
-       exit(1);  
-   }
    //   printf_debug(DEBUG_SCHED, "1 ... \n");
 
    // 1 - On commence par calculer l'utilité sur chaque file
@@ -516,9 +552,7 @@ void schedulerUtilityMCPropBatch(struct schedUtility_t * sched, int mc, t_sequen
    for (m = mc; m < (schedACM_getReclassification(sched->schedACM)?schedACM_getNbModCod(sched->schedACM):(mc+1)); m++) {
       //    Pour chaque file du modcod
       for (q = 0; q < schedACM_getNbQoS(sched->schedACM); q++) {
-         poids[m][q] = utiliteDerivee(schedACM_getQoS(sched->schedACM, m, q),
-				      schedACM_getQoS(sched->schedACM, m, q)->debit,
-				      schedACM_getACMLink(sched->schedACM));
+         poids[m][q] = schedACM_getDerivee(sched->schedACM, m, q);
 	 //         printf_debug(DEBUG_SCHED, "Poids[%d, %d] = %f (débit = %lf)\n", m, q,  poids[m][q], schedACM_getQoS(sched->schedACM, m, q)->debit);
 	 assert(poids[m][q]>=0);
          sommePoids += poids[m][q];
@@ -555,35 +589,34 @@ void schedulerUtilityMCPropBatch(struct schedUtility_t * sched, int mc, t_sequen
          printf_debug(DEBUG_SCHED, "remplissage->nbrePaquets[m][q] = %d ...\n", remplissage->nbrePaquets[m][q]);
          printf_debug(DEBUG_SCHED, "filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)) = %d ...\n", filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)));
 	 if (filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))) {
-            printf_debug(DEBUG_SCHED, "filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1) = %d ...\n", filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1));
+            printf_debug(DEBUG_SCHED, "schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1) = %d ...\n", schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1));
             printf_debug(DEBUG_SCHED, "poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8) = %f ...\n", poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
-            printf_debug(DEBUG_SCHED, "remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1) = %d ...\n", remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+1));
+            printf_debug(DEBUG_SCHED, "remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1) = %d ...\n", remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+1));
             printf_debug(DEBUG_SCHED, "DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8 = %d ...\n", (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
 	 }
 	*/
 
         // Tant que (1) il reste un paquet  (2) qui tient dans la trame (3) que j'ai le droit d'émettre
 	while ((remplissage->nbrePaquets[m][q] < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)) - sequence_nbPackets(sequence, m, q)) // (1)
-               &&  (remplissage->volumeTotal +filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1) // (2)
+               &&  (remplissage->volumeTotal +schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1) // (2)
 		    <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))
 	       &&  // (3)
 	       (
 		 (   (propMod == propModDirect) 
 		 )||((propMod == propModProp) && (
-                     (filePDU_size_n_PDU(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1)
+                     (schedACM_getCumulatedSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1)
                      <= poids[m][q]*(DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8)) 
 						  )
 		 )
 		)){
 	  remplissage->nbrePaquets[m][q]++;
-          remplissage->volumeTotal += filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q));
-	  remplissage->interet += (double)(filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q))) * poids[m][q]*sommePoids;
+          remplissage->volumeTotal += schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q));
+	  remplissage->interet += (double)(schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q))) * poids[m][q]*sommePoids;
 	  /*
           printf_debug(DEBUG_SCHED, "   %d pq de %d/%d (volume %d -> cumul %d, reste %d sur %d)\n",
 		       remplissage->nbrePaquets[m][q],
 		       m, q,
-		       filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-					  remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)),
+		       schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)),
 		       remplissage->volumeTotal,
 		       (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8) - remplissage->volumeTotal,
 		       (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8));
@@ -611,12 +644,10 @@ void schedulerUtilityMCPropBatch(struct schedUtility_t * sched, int mc, t_sequen
 
          while ((remplissage->nbrePaquets[m][q]
 		 < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)) - sequence_nbPackets(sequence, m, q)) // Il en reste un
-	  && (remplissage->volumeTotal + filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-							   remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1)
+	  && (remplissage->volumeTotal + schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1)
                     <= (DVBS2ll_bbframePayloadBitSize(schedACM_getACMLink(sched->schedACM), mc)/8))) {
 	 remplissage->volumeTotal += 
-            filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q),
-			       remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1);
+            schedACM_getPDUSize(sched->schedACM, m, q, remplissage->nbrePaquets[m][q]+sequence_nbPackets(sequence, m, q)+1);
          remplissage->nbrePaquets[m][q]++;
          }
       }
@@ -657,6 +688,8 @@ void schedulerUtilityPropBatch(struct schedUtility_t * sched)
    // ordonnancer !
    if (sequence_filesVides(&sequence, sched->schedACM)) {
       printf_debug(DEBUG_SCHED, "empty files, aborting ...\n");
+      sequence_free(&sequence);
+      sequence_free(&sequenceChoisie);
       return ;
    };
 
@@ -796,6 +829,10 @@ void schedulerUtilityPropBatch(struct schedUtility_t * sched)
 		 schedACM_getSequenceChoisie(sched->schedACM),
 		 schedACM_getNbModCod(sched->schedACM),
 		 schedACM_getNbQoS(sched->schedACM));
+
+   // Leur stockage servira à l'époque suivante
+   sequence_free(&sequence);
+   sequence_free(&sequenceChoisie);
    printf_debug(DEBUG_SCHED, "OUT with :\n");
    if (DEBUG_SCHED&debug_mask) {
       schedACM_printSequenceSummary(sched->schedACM, schedACM_getSequenceChoisie(sched->schedACM));
@@ -830,6 +867,9 @@ struct schedACM_t * schedUtilityPropBatch_create(struct DVBS2ll_t * dvbs2ll, int
 
    result->schedACM = schedACM_create(dvbs2ll, nbQoS, declOK, &schedUtilityPropBatch_func);
    schedACM_setPrivate(result->schedACM, result);
+   result->remplissages = NULL;
+   result->graines = NULL;
+   schedUtility_initPoids(result);
    schedACM_setSeqLgMax(result->schedACM, seqLgMax);
 
    printf_debug(DEBUG_SCHED, "%p created (in schedACM %p)\n", result, result->schedACM);
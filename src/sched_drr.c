@@ -1,15 +1,22 @@
 /** @file sched_drr.c
  *  @brief Un ordonnanceur Deficit Round Robin élémentaire
  *
- * Pas encore pret  tre utilis
- * 
  * Cette implantation se fonde aussi largement que possible sur le
  * papier qui a introduit cette technique [1].
+ *
+ * Les entres actives (celles dont la file n'est pas vide) forment une
+ * liste FIFO. L'entre de tte reoit son quantum lorsqu'elle y
+ * arrive, met tant que son dficit le permet, puis est remise en
+ * queue (ou retire si sa file est vide, avec un dficit nul). Le
+ * cot d'un ordonnancement est donc en O(1) quel que soit le nombre
+ * d'entres, pourvu que chaque quantum soit au moins gal  la taille
+ * maximale des PDU, comme dans [1].
  * 
  *   [1] M. Shreedhar, G. Varghese - "Efficient Fair Queueing using
  *   Deficit Round Robin". SIGCOMM '95.
  */
-#include <limits.h>
+#include <stdlib.h>    // realloc, free
+#include <stdint.h>    // uintptr_t
 
 #include <sched_drr.h>
 #include <file_pdu.h>
@@ -17,6 +24,11 @@
 #include <ndesObject.h>
 #include <log.h>
 
+/**
+ * Taille initiale de la table d'index des entrées
+ */
+#define SCHED_DRR_INDEX_INIT 16
+
 /**
  * Chaque entre d'un Deficit Round Robin est caractrise par un
  * certain nombre de paramtres.
@@ -29,10 +41,10 @@ struct schedDRRInput_t {
 			    //les PDU de la source
    unsigned long quantum;         //!< Le quantum attribu  chaque tour (cf [1])
    unsigned long deficitCounter ; //!< Le deficit (cf [1])
-   int           nbToursSupp;     //!< Combien de tours lui faut-il
-				  //!avant de pouvoir mettre ?
-   struct schedDRRInput_t * next ; //!< On chaine les sources
-   struct schedDRRInput_t * prev ; //!< On chaine les sources
+   int           active;          //!< Est-elle dans la liste active ?
+   int           enTour;          //!< A-t-elle dj reu le quantum
+				  //!du passage en cours ?
+   struct schedDRRInput_t * next ; //!< On chaine les sources actives
 };
 
 /**
@@ -43,11 +55,15 @@ struct schedDRR_t {
    void         * destination;    //!< La destination (typiquement un lien)
    processPDU_t   destProcessPDU;   //!< Fonction de rception de la destination
 
-   struct schedDRRInput_t  * unactiveSourceList; //!< La liste des
-						 //sources inactives
-   struct schedDRRInput_t  * activeSourceList;   //!< La liste des
-						 //sources actives
-   struct schedDRRInput_t  * nextInput;   //!< Prochaine source  servir
+   struct schedDRRInput_t  * activeHead; //!< La prochaine entre
+					 //active  servir
+   struct schedDRRInput_t  * activeTail; //!< La dernire entre active
+
+   int                       nbInputs;   //!< Nombre d'entres
+   int                       indexSize;  //!< Taille de la table
+					 //d'index (au moins le double)
+   struct schedDRRInput_t ** index;      //!< Les entres, indexes
+					 //par leur source
 };
 
 /**
@@ -58,6 +74,43 @@ struct ndesObjectType_t schedDRRType = {
   ndesObjectTypeDefaultValues(schedDRR)
 };
 
+/*
+ * Position d'une source dans la table d'index (adressage ouvert) :
+ * soit la case de son entrée, soit la case vide où l'insérer
+ */
+static int schedDRR_slot(struct schedDRR_t * sched, void * source)
+{
+   unsigned int h = (unsigned int)(((uintptr_t)source >> 4) * 2654435761u);
+   int s = h & (sched->indexSize - 1);
+
+   while ((sched->index[s] != NULL) && (sched->index[s]->source != source)) {
+      s = (s + 1) & (sched->indexSize - 1);
+   }
+   return s;
+}
+
+/*
+ * Doublement de la table d'index
+ */
+static void schedDRR_growIndex(struct schedDRR_t * sched)
+{
+   struct schedDRRInput_t ** old = sched->index;
+   int oldSize = sched->indexSize;
+   int n;
+
+   sched->indexSize = 2*oldSize;
+   sched->index = (struct schedDRRInput_t **)sim_malloc(sched->indexSize*sizeof(struct schedDRRInput_t *));
+   for (n = 0; n < sched->indexSize; n++) {
+      sched->index[n] = NULL;
+   }
+   for (n = 0; n < oldSize; n++) {
+      if (old[n]) {
+         sched->index[schedDRR_slot(sched, old[n]->source)] = old[n];
+      }
+   }
+   free(old);
+}
+
 /**
  * Création d'une instance de l'ordonnanceur avec la destination en
  * paramètre 
@@ -69,6 +122,7 @@ struct schedDRR_t * schedDRR_create(void * destination,
 				  processPDU_t destProcessPDU)
 {
    struct schedDRR_t * result = (struct schedDRR_t * )sim_malloc(sizeof(struct schedDRR_t));
+   int n;
 
    printf_debug(DEBUG_SCHED, "in\n");
    ndesObjectInit(result, schedDRR);
@@ -78,9 +132,14 @@ struct schedDRR_t * schedDRR_create(void * destination,
    result->destProcessPDU = destProcessPDU;
 
    // Pas de source définie
-   result->unactiveSourceList = NULL;
-   result->activeSourceList = NULL;
-   result->nextInput = NULL;
+   result->activeHead = NULL;
+   result->activeTail = NULL;
+   result->nbInputs = 0;
+   result->indexSize = SCHED_DRR_INDEX_INIT;
+   result->index = (struct schedDRRInput_t **)sim_malloc(SCHED_DRR_INDEX_INIT*sizeof(struct schedDRRInput_t *));
+   for (n = 0; n < SCHED_DRR_INDEX_INIT; n++) {
+      result->index[n] = NULL;
+   }
 
    printf_debug(DEBUG_SCHED, "out\n");
 
@@ -100,6 +159,8 @@ void schedDRR_addSource(struct schedDRR_t * sched,
 
    printf_debug(DEBUG_SCHED, "in\n");
 
+   assert(quantum > 0);
+
    // On cre une structure dfinissant cette source
    input->source = source;
    input->getPDU = getPDU;
@@ -109,15 +170,17 @@ void schedDRR_addSource(struct schedDRR_t * sched,
 
    input->quantum = quantum;
    input->deficitCounter = 0;
-   input->nbToursSupp = 0;
+   input->active = 0;
+   input->enTour = 0;
+   input->next = NULL;
 
-   // On l'insre  la fin de la liste des sources inactives
-   input->next = sched->unactiveSourceList;
-   input->prev = NULL;
-   if (input->next != NULL) {
-      input->next->prev = input;
+   // On la range dans la table d'index, garde  moiti vide au plus
+   if (2*(sched->nbInputs + 1) > sched->indexSize) {
+      schedDRR_growIndex(sched);
    }
-   sched->unactiveSourceList = input;
+   assert(sched->index[schedDRR_slot(sched, source)] == NULL);
+   sched->index[schedDRR_slot(sched, source)] = input;
+   sched->nbInputs++;
 
    printf_debug(DEBUG_SCHED, "input %p : source %p, file %p (length %d)\n",
 		input, input->source, input->file, filePDU_length(input->file));
@@ -125,6 +188,35 @@ void schedDRR_addSource(struct schedDRR_t * sched,
 
 }
 
+/*
+ * Ajout d'une entrée en queue de la liste active
+ */
+static void schedDRR_append(struct schedDRR_t * sched, struct schedDRRInput_t * input)
+{
+   input->next = NULL;
+   if (sched->activeTail) {
+      sched->activeTail->next = input;
+   } else {
+      sched->activeHead = input;
+   }
+   sched->activeTail = input;
+}
+
+/*
+ * Retrait de l'entrée de tête de la liste active
+ */
+static struct schedDRRInput_t * schedDRR_popHead(struct schedDRR_t * sched)
+{
+   struct schedDRRInput_t * input = sched->activeHead;
+
+   sched->activeHead = input->next;
+   if (sched->activeHead == NULL) {
+      sched->activeTail = NULL;
+   }
+   input->next = NULL;
+   return input;
+}
+
 /*
  * La fonction permettant de demander une PDU à notre scheduler
  * C'est ici qu'est implanté l'algorithme
@@ -133,139 +225,61 @@ struct PDU_t * schedDRR_getPDU(void * s)
 {
    struct schedDRR_t      * sched = (struct schedDRR_t * )s;
    struct PDU_t           * result = NULL;
-   struct schedDRRInput_t * currentInput, *cINext;
-   unsigned long nbToursSup = ULONG_MAX;
+   struct schedDRRInput_t * currentInput;
 
    printf_debug(DEBUG_SCHED, "in\n");
 
-   // Si on n'a pas de nextInput, c'est qu'il faut dmarrer un
-   // tour. La premire phase consiste  avancer autant que ncessaire
-   // (en faisant ventuellement des tours  vide) pour qu'une source
-   // active puisse mettre.
-   do {
-      if (sched->nextInput == NULL) {
-	 printf_debug(DEBUG_SCHED, "Starting a new round\n");
-         // On va chercher la premire source active
-         if (sched->activeSourceList == NULL) {
-            printf_debug(DEBUG_SCHED, "No active source, aborting\n");
-            return NULL; // Si pas de source active, pas de PDU  fournir !
-         }
-         // On parcourt la liste des sources actives jusqu' en trouver une
-         // qui puisse envoyer au moins un paquet. Le problme, c'est qu'il
-         // sera peut-tre ncessaire de faire plusieurs tours afin de
-         // cumuler un dficit suffisant pour envoyer ce paquet. Du coup on
-         // compte pour chaque file active le nombre de tours dont elle a
-         // besoin avant d'mettre.
-         currentInput = sched->activeSourceList;
-         do {
-	/* Si le dficit est suffisant, on peut mettre de suite, sinon
-	 * le nombre de tours  faire dpend de la taille du prochain
-	 * paquet et du quantum
-	 */
-	    currentInput->nbToursSupp = (currentInput->deficitCounter 
-				      >= filePDU_size_n_PDU(currentInput->file, 1)) ?
-	      0:((filePDU_size_n_PDU(currentInput->file, 1)-currentInput->deficitCounter-1)/currentInput->quantum+1);
-            nbToursSup = min(nbToursSup, currentInput->nbToursSupp);
- 	    printf_debug(DEBUG_SCHED, "current input %p (source %p, file %p) : %d PDU (first size %d), deficit %ld, quantum %ld, needs %d rounds\n",
-			 currentInput,
-			 currentInput->source, currentInput->file,
-			 filePDU_length(currentInput->file),
-			 filePDU_size_n_PDU(currentInput->file, 1),
-			 currentInput->deficitCounter,
-			 currentInput->quantum,
-		  	currentInput->nbToursSupp );
-
-            currentInput = currentInput->next;
-         } while (currentInput);
-         
-        /* On connait maintenant le nombre minimal de tours  faire pour
-         * que quelqu'un puisse mettre. Le deuxime phase consiste donc
-         *  appliquer la consquence de ces tours sur les dficits
-         */
-	 printf_debug(DEBUG_SCHED, "Fast forwarding %ld rounds\n",
-		      nbToursSup);
-         currentInput = sched->activeSourceList;
-         do {
-            currentInput->deficitCounter += nbToursSup*currentInput->quantum;
-  	    printf_debug(DEBUG_SCHED, "current input %p (source %p, file %p) : %d PDU (first size %d), deficit %ld, quantum %ld\n",
-			 currentInput,
-			 currentInput->source, currentInput->file,
-			 filePDU_length(currentInput->file),
-			 filePDU_size_n_PDU(currentInput->file, 1),
-			 currentInput->deficitCounter,
- 			 currentInput->quantum);
-           currentInput = currentInput->next;
-         } while (currentInput);
-      
-         /* Maintenant que tout le monde a obtenu le dficit du tour, on
-          * commence effectivement le tour. C'est la troisime phase.
-          */
-         sched->nextInput = sched->activeSourceList;
+   while (result == NULL) {
+      currentInput = sched->activeHead;
+      if (currentInput == NULL) {
+         printf_debug(DEBUG_SCHED, "No active source, aborting\n");
+         return NULL; // Si pas de source active, pas de PDU  fournir !
       }
-      printf_debug(DEBUG_SCHED, "Proceeding current round ...\n");
-
-      // Tant qu'on n'a pas fini le tour actuel (que l'on dbute
-      // ventuellement, si le code prcdent a t excut), on sert la
-      // prochaine source  servir
-      currentInput = sched->nextInput;
-      do {
-         // Si la source en cours n'a pas t intgralement servie, on
-         // envoie le prochain de ses paquets. On ne change pas
-         // ncessairement nextInput car elle pourra ventuellement
-         // encore tre servie au prochain tour 
-         if (filePDU_size_n_PDU(currentInput->file, 1) <= currentInput->deficitCounter) {
-            result = filePDU_extract(currentInput->file);
-	    assert(result != NULL);
-            currentInput->deficitCounter -= PDU_size(result);
-            // Si c'est le dernier paquet de la source, elle n'est
-            // plus active, il faut donc la sortir (avec un dficit
-            // nul) et passer  l'ventuelle prochaine
-            if (filePDU_length(currentInput->file) == 0) {
-               cINext = currentInput->next;
-               currentInput->deficitCounter = 0;
-
-	       // On met  jour la liste active ( laquelle elle appartient)
-               if (currentInput->prev) {
-                  currentInput->prev->next = currentInput->next;
-	       } else { // Le cas de la premire
-                  sched->activeSourceList = currentInput->next;
-	       }
-               if (currentInput->next) {
-                  currentInput->next->prev = currentInput->prev;
-	       }
-               // On met  jour la liste inactive (dans laquelle elle
-               // va)
-	       currentInput->next = sched->unactiveSourceList;
-	       sched->unactiveSourceList = currentInput;
-	       currentInput->prev = NULL;
-               if (currentInput->next) {
-                  currentInput->next->prev = currentInput;
-	       }
-               // Puisque cette source n'a plus rien  donner, on
-               // passe  la suivante
-	       currentInput = cINext;
-               printf_debug(DEBUG_SCHED, "Next input now %p ...\n", currentInput);
-	    }
-         } else {
-            // Si la source en cours ne peut pas mettre (pas assez cumul
-            // de dficit), alors on passe  la suivante
-            printf_debug(DEBUG_SCHED, "Not enough deficit for input %p ...\n", currentInput);
-            currentInput =  currentInput->next;
-         }
-      } while ((result == NULL) && (currentInput != NULL));
 
-      // Si on a trouv quelquechose, on est content ! On arrte l aprs
-      // avoir not o on en est dans le tour actuel
-      // Si on n'a rien trouv, ici, c'est qu'on vient de finir un tour,
-      // il faut donc en entamer un nouveau
-      sched->nextInput = currentInput;
-   } while (result == NULL);
+      // Une entre qui arrive en tte reoit son quantum pour ce
+      // passage
+      if (!currentInput->enTour) {
+         currentInput->deficitCounter += currentInput->quantum;
+         currentInput->enTour = 1;
+      }
+
+      printf_debug(DEBUG_SCHED, "current input %p (source %p, file %p) : %d PDU, deficit %ld, quantum %ld\n",
+		   currentInput,
+		   currentInput->source, currentInput->file,
+		   filePDU_length(currentInput->file),
+		   currentInput->deficitCounter,
+		   currentInput->quantum);
+
+      if (filePDU_size_PDU_n(currentInput->file, 1) <= currentInput->deficitCounter) {
+         // Le dficit suffit : on met, et l'entre reste en tte
+         // pour la suite de son passage
+         result = filePDU_extract(currentInput->file);
+         assert(result != NULL);
+         currentInput->deficitCounter -= PDU_size(result);
+
+         // Si c'est le dernier paquet de la source, elle n'est plus
+         // active, il faut donc la sortir (avec un dficit nul)
+         if (filePDU_length(currentInput->file) == 0) {
+            schedDRR_popHead(sched);
+            currentInput->deficitCounter = 0;
+            currentInput->active = 0;
+            currentInput->enTour = 0;
+         }
+      } else {
+         // Pas assez de dficit : fin du passage, l'entre repart en
+         // queue avec son dficit
+         printf_debug(DEBUG_SCHED, "Not enough deficit for input %p ...\n", currentInput);
+         schedDRR_popHead(sched);
+         currentInput->enTour = 0;
+         schedDRR_append(sched, currentInput);
+      }
+   }
 
    printf_debug(DEBUG_SCHED, "scheduling PDU %d (size %d)\n", 
                 PDU_id(result),
                 PDU_size(result));
 
-   ndesLog_logLineF(PDU_getObject(result), "OUT %d", schedDRR_getObjectId(sched));
+   ndesLog_tracePDU(NDESLOG_SCHED, result, ndesLog_out, schedDRR_getObjectId(sched));
 
    return result;
 }
@@ -279,7 +293,7 @@ int schedDRR_processPDU(void *s,
 {
    int                      result;
    struct schedDRR_t      * sched = (struct schedDRR_t *)s;
-   struct schedDRRInput_t * src, *unknownSource = NULL;
+   struct schedDRRInput_t * src;
    struct PDU_t           * pdu;
 
    printf_debug(DEBUG_SCHED, "in\n");
@@ -290,56 +304,23 @@ int schedDRR_processPDU(void *s,
       printf_debug(DEBUG_SCHED, "c'etait juste un test\n");
       result = 1;
    } else {
-      // On cherche la source dans la liste des sources inactives
-      src = sched->unactiveSourceList;
-      while (( src != NULL)  && (src->source != source) ){
-         src = src->next;
-      }
-      assert((src == NULL)||(src->source == source));
-
-      // Si on l'a trouv, il faut l'extraire et la mettre dans la
-      // liste des sources actives
-      if ((src != NULL) && (src->source == source)) {
-         // On met  jour la liste inactive ( laquelle elle appartient)
-         if (src->prev) {
-            src->prev->next = src->next;
-         } else { // Le cas de la premire
-            sched->unactiveSourceList = src->next;
-         }
-         if (src->next) {
-            src->next->prev = src->prev;
-         }
-
-         // On met  jour la liste inactive (dans laquelle elle va)
-         src->next = sched->activeSourceList;
-         sched->activeSourceList = src;
-         src->prev = NULL;
-         if (src->next) {
-            src->next->prev = src;
-         }
-      }
-
-      // On va maintenant la chercher dans les sources actives (elle y
-      // est forcment)
-      if (src == NULL) {
-         src = sched->activeSourceList;
-         while (( src != NULL)  && (src->source != source) ){
-            src = src->next;
-         }
-         assert((src == NULL)||(src->source == source));
-      }
+      // On cherche l'entre de la source, qui doit tre connue
+      src = sched->index[schedDRR_slot(sched, source)];
+      assert(src != NULL);
 
-      // Si on ne l'a pas trouv, il y a un problme, car elle est
-      // donc inconnue !
-      assert(src != unknownSource);
-
-      // Une fois qu'on a trouv la source (qui est ncessairement
-      // active), on prend le paquet et on le met dans la file
-      // correspondante 
+      // On prend le paquet et on le met dans la file correspondante
       pdu = src->getPDU(src->source);
       assert(pdu != NULL);
       filePDU_insert(src->file, pdu);
 
+      // Si la source tait inactive, elle rejoint la fin de la liste
+      // active
+      if (!src->active) {
+         src->active = 1;
+         src->enTour = 0;
+         schedDRR_append(sched, src);
+      }
+
       // Si l'aval est dispo, on lui dit de venir chercher une PDU, ce
       // qui déclanchera l'ordonnancement
       printf_debug(DEBUG_SCHED, "on signale que la PDU %d (size %d) est dispo\n",
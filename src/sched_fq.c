@@ -0,0 +1,669 @@
+/** @file sched_fq.c
+ *  @brief Les ordonnanceurs équitables à temps virtuel (WFQ, WF2Q+,
+ *  SCFQ)
+ *
+ *  Les étiquettes (dates virtuelles de début et de fin des PDU) sont
+ *  exprimées en octets par unité de poids : une PDU de taille L d'une
+ *  source de poids w occupe L/w de temps virtuel.
+ *
+ *  Les sources sont rangées dans des tas binaires indexés (chaque
+ *  entrée connaît sa position dans chaque tas, ce qui permet de la
+ *  déplacer ou de la retirer en O(log N)) :
+ *   - le tas de sélection contient les sources candidates, ordonnées
+ *     par l'étiquette de fin de leur PDU de tête ;
+ *   - pour WF2Q+, le tas d'attente contient les sources non encore
+ *     éligibles, ordonnées par l'étiquette de début de leur PDU de
+ *     tête ;
+ *   - pour WFQ, le tas GPS contient les sources encore actives dans le
+ *     système fluide, ordonnées par l'étiquette de fin de leur
+ *     dernière PDU.
+ */
+#include <stdlib.h>    // realloc, free
+#include <stdint.h>    // uintptr_t
+
+#include <sched_fq.h>
+#include <file_pdu.h>
+
+#include <ndesObject.h>
+#include <log.h>
+
+/**
+ * Les tas d'un ordonnanceur
+ */
+#define SCHED_FQ_SELECT  0  //!< Sources candidates, par fin
+#define SCHED_FQ_WAIT    1  //!< Sources non éligibles (WF2Q+), par début
+#define SCHED_FQ_GPS     2  //!< Sources actives en fluide (WFQ), par fin
+#define SCHED_FQ_NB_TAS  3
+
+/**
+ * Position d'une entrée absente d'un tas
+ */
+#define SCHED_FQ_HORS_TAS (-1)
+
+/**
+ * Tailles initiales des tableaux
+ */
+#define SCHED_FQ_INDEX_INIT 16
+#define SCHED_FQ_TAS_INIT   16
+#define SCHED_FQ_TAGS_INIT   4
+
+/**
+ * Les variantes implantées
+ */
+enum schedFQ_algo_t {
+   schedFQ_WFQ,
+   schedFQ_WF2QPlus,
+   schedFQ_SCFQ
+};
+
+/**
+ * Chaque entrée est caractérisée par son poids et ses étiquettes
+ */
+struct schedFQInput_t {
+   void * source ;    //!< La source elle-même
+   getPDU_t getPDU;   //!< Sa fonction fournissant une PDU
+
+   struct filePDU_t * file;  //!< La file dans laquelle sont placées
+			     //les PDU de la source
+   double weight;            //!< Son poids
+   int    num;               //!< Son numéro, pour départager les
+			     //ex-aequo
+
+   double key[SCHED_FQ_NB_TAS]; //!< Sa clé dans chaque tas
+   int    pos[SCHED_FQ_NB_TAS]; //!< Sa position dans chaque tas
+
+   double lastFinish;        //!< Etiquette de fin de la dernière PDU
+			     //étiquetée
+
+   //! Etiquettes de fin des PDU en attente (WFQ et SCFQ), en file
+   //! circulaire
+   double * tags;
+   int      tagFirst;
+   int      tagNb;
+   int      tagSize;
+};
+
+/**
+ * Un tas binaire d'entrées
+ */
+struct schedFQHeap_t {
+   int id;                         //!< Le numéro du tas (clé et position)
+   int nb;                         //!< Nombre d'entrées dans le tas
+   int size;                       //!< Taille du tableau
+   struct schedFQInput_t ** elts;  //!< Les entrées
+};
+
+/**
+ * Structure définissant notre ordonanceur
+ */
+struct schedFQ_t {
+   declareAsNdesObject;
+   void         * destination;    //!< La destination (typiquement un lien)
+   processPDU_t   destProcessPDU; //!< Fonction de réception de la destination
+
+   enum schedFQ_algo_t algo;      //!< La variante
+   double virtualTime;            //!< Le temps virtuel
+   double totalWeight;            //!< La somme des poids des sources
+
+   // Le système fluide (WFQ)
+   double       throughput;       //!< Le débit du lien (octets/s)
+   double       gpsWeight;        //!< Somme des poids des sources actives
+   motSimDate_t gpsDate;          //!< Date de calcul du temps virtuel
+
+   struct schedFQHeap_t heap[SCHED_FQ_NB_TAS]; //!< Les tas
+
+   int                      nbInputs;   //!< Nombre d'entrées
+   int                      indexSize;  //!< Taille de la table
+					//d'index (au moins le double)
+   struct schedFQInput_t ** index;      //!< Les entrées, indexées
+					//par leur source
+};
+
+/**
+ * @brief Définition des fonctions spécifiques liées au ndesObject
+ */
+defineObjectFunctions(schedFQ);
+struct ndesObjectType_t schedFQType = {
+  ndesObjectTypeDefaultValues(schedFQ)
+};
+
+/*----------------------------------------------------------------------*/
+/*   Les tas                                                            */
+/*----------------------------------------------------------------------*/
+
+/*
+ * a doit-elle passer avant b ?
+ */
+static inline int schedFQ_less(struct schedFQHeap_t * h,
+			       struct schedFQInput_t * a,
+			       struct schedFQInput_t * b)
+{
+   return (a->key[h->id] < b->key[h->id])
+      || ((a->key[h->id] == b->key[h->id]) && (a->num < b->num));
+}
+
+static inline void schedFQ_place(struct schedFQHeap_t * h,
+				 struct schedFQInput_t * in,
+				 int p)
+{
+   h->elts[p] = in;
+   in->pos[h->id] = p;
+}
+
+static void schedFQ_siftUp(struct schedFQHeap_t * h, int p)
+{
+   struct schedFQInput_t * in = h->elts[p];
+
+   while ((p > 0) && (schedFQ_less(h, in, h->elts[(p - 1)/2]))) {
+      schedFQ_place(h, h->elts[(p - 1)/2], p);
+      p = (p - 1)/2;
+   }
+   schedFQ_place(h, in, p);
+}
+
+static void schedFQ_siftDown(struct schedFQHeap_t * h, int p)
+{
+   struct schedFQInput_t * in = h->elts[p];
+   int c;
+
+   while ((c = 2*p + 1) < h->nb) {
+      if ((c + 1 < h->nb) && (schedFQ_less(h, h->elts[c + 1], h->elts[c]))) {
+         c++;
+      }
+      if (!schedFQ_less(h, h->elts[c], in)) {
+         break;
+      }
+      schedFQ_place(h, h->elts[c], p);
+      p = c;
+   }
+   schedFQ_place(h, in, p);
+}
+
+static void schedFQ_heapInit(struct schedFQHeap_t * h, int id)
+{
+   h->id = id;
+   h->nb = 0;
+   h->size = SCHED_FQ_TAS_INIT;
+   h->elts = (struct schedFQInput_t **)sim_malloc(SCHED_FQ_TAS_INIT*sizeof(struct schedFQInput_t *));
+}
+
+static void schedFQ_heapInsert(struct schedFQHeap_t * h, struct schedFQInput_t * in)
+{
+   assert(in->pos[h->id] == SCHED_FQ_HORS_TAS);
+
+   if (h->nb == h->size) {
+      h->size *= 2;
+      h->elts = (struct schedFQInput_t **)realloc(h->elts, h->size*sizeof(struct schedFQInput_t *));
+      assert(h->elts != NULL);
+   }
+   h->elts[h->nb++] = in;
+   schedFQ_siftUp(h, h->nb - 1);
+}
+
+static void schedFQ_heapRemove(struct schedFQHeap_t * h, struct schedFQInput_t * in)
+{
+   int p = in->pos[h->id];
+   struct schedFQInput_t * last = h->elts[--h->nb];
+
+   assert(p != SCHED_FQ_HORS_TAS);
+
+   in->pos[h->id] = SCHED_FQ_HORS_TAS;
+   if (last != in) {
+      schedFQ_place(h, last, p);
+      schedFQ_siftUp(h, p);
+      schedFQ_siftDown(h, last->pos[h->id]);
+   }
+}
+
+/*
+ * Repositionnement d'une entrée dont la clé a changé
+ */
+static void schedFQ_heapUpdate(struct schedFQHeap_t * h, struct schedFQInput_t * in)
+{
+   schedFQ_siftUp(h, in->pos[h->id]);
+   schedFQ_siftDown(h, in->pos[h->id]);
+}
+
+#define schedFQ_heapTop(h) (((h)->nb > 0)?(h)->elts[0]:NULL)
+
+/*----------------------------------------------------------------------*/
+/*   Les étiquettes des PDU en attente                                  */
+/*----------------------------------------------------------------------*/
+
+static void schedFQ_pushTag(struct schedFQInput_t * in, double tag)
+{
+   double * tags;
+   int n;
+
+   if (in->tagNb == in->tagSize) {
+      tags = (double *)sim_malloc(2*in->tagSize*sizeof(double));
+      for (n = 0; n < in->tagNb; n++) {
+         tags[n] = in->tags[(in->tagFirst + n)%in->tagSize];
+      }
+      free(in->tags);
+      in->tags = tags;
+      in->tagFirst = 0;
+      in->tagSize *= 2;
+   }
+   in->tags[(in->tagFirst + in->tagNb++)%in->tagSize] = tag;
+}
+
+static double schedFQ_popTag(struct schedFQInput_t * in)
+{
+   double tag = in->tags[in->tagFirst];
+
+   assert(in->tagNb > 0);
+
+   in->tagFirst = (in->tagFirst + 1)%in->tagSize;
+   in->tagNb--;
+   return tag;
+}
+
+#define schedFQ_headTag(in) ((in)->tags[(in)->tagFirst])
+
+/*----------------------------------------------------------------------*/
+/*   La table d'index des sources                                       */
+/*----------------------------------------------------------------------*/
+
+/*
+ * Position d'une source dans la table d'index (adressage ouvert) :
+ * soit la case de son entrée, soit la case vide où l'insérer
+ */
+static int schedFQ_slot(struct schedFQ_t * sched, void * source)
+{
+   unsigned int h = (unsigned int)(((uintptr_t)source >> 4) * 2654435761u);
+   int s = h & (sched->indexSize - 1);
+
+   while ((sched->index[s] != NULL) && (sched->index[s]->source != source)) {
+      s = (s + 1) & (sched->indexSize - 1);
+   }
+   return s;
+}
+
+/*
+ * Doublement de la table d'index
+ */
+static void schedFQ_growIndex(struct schedFQ_t * sched)
+{
+   struct schedFQInput_t ** old = sched->index;
+   int oldSize = sched->indexSize;
+   int n;
+
+   sched->indexSize = 2*oldSize;
+   sched->index = (struct schedFQInput_t **)sim_malloc(sched->indexSize*sizeof(struct schedFQInput_t *));
+   for (n = 0; n < sched->indexSize; n++) {
+      sched->index[n] = NULL;
+   }
+   for (n = 0; n < oldSize; n++) {
+      if (old[n]) {
+         sched->index[schedFQ_slot(sched, old[n]->source)] = old[n];
+      }
+   }
+   free(old);
+}
+
+/*----------------------------------------------------------------------*/
+/*   Le temps virtuel                                                   */
+/*----------------------------------------------------------------------*/
+
+/*
+ * Avancée du système fluide (WFQ) jusqu'à la date courante. Le temps
+ * virtuel croît à la vitesse throughput/gpsWeight, et chaque source
+ * quitte le système lorsqu'il atteint l'étiquette de fin de sa
+ * dernière PDU.
+ */
+static void schedFQ_updateGPS(struct schedFQ_t * sched)
+{
+   motSimDate_t now = motSim_getCurrentTime();
+   struct schedFQInput_t * in;
+   double dt;
+
+   while ((in = schedFQ_heapTop(&sched->heap[SCHED_FQ_GPS])) != NULL) {
+      // Durée avant que cette source ne termine dans le système fluide
+      dt = (in->lastFinish - sched->virtualTime)*sched->gpsWeight/sched->throughput;
+      if (sched->gpsDate + dt > now) {
+         sched->virtualTime += (now - sched->gpsDate)*sched->throughput/sched->gpsWeight;
+         break;
+      }
+      sched->virtualTime = in->lastFinish;
+      sched->gpsDate += dt;
+      schedFQ_heapRemove(&sched->heap[SCHED_FQ_GPS], in);
+      sched->gpsWeight -= in->weight;
+   }
+   if (sched->heap[SCHED_FQ_GPS].nb == 0) {
+      sched->gpsWeight = 0.0;
+   }
+   sched->gpsDate = now;
+}
+
+/*
+ * Etiquetage d'une PDU à son arrivée (WFQ et SCFQ)
+ */
+static double schedFQ_tagArrival(struct schedFQ_t * sched,
+				 struct schedFQInput_t * in,
+				 unsigned int size)
+{
+   double start = (in->lastFinish > sched->virtualTime)?in->lastFinish:sched->virtualTime;
+
+   in->lastFinish = start + size/in->weight;
+   schedFQ_pushTag(in, in->lastFinish);
+
+   return in->lastFinish;
+}
+
+/*
+ * Etiquetage de la PDU de tête (WF2Q+) et rangement de la source
+ * selon son éligibilité
+ */
+static void schedFQ_tagHead(struct schedFQ_t * sched,
+			    struct schedFQInput_t * in,
+			    double start,
+			    unsigned int size)
+{
+   in->lastFinish = start + size/in->weight;
+   in->key[SCHED_FQ_SELECT] = in->lastFinish;
+   in->key[SCHED_FQ_WAIT] = start;
+   if (start <= sched->virtualTime) {
+      schedFQ_heapInsert(&sched->heap[SCHED_FQ_SELECT], in);
+   } else {
+      schedFQ_heapInsert(&sched->heap[SCHED_FQ_WAIT], in);
+   }
+}
+
+/*----------------------------------------------------------------------*/
+/*   Création                                                           */
+/*----------------------------------------------------------------------*/
+
+static struct schedFQ_t * schedFQ_create(void * destination,
+					 processPDU_t destProcessPDU,
+					 enum schedFQ_algo_t algo)
+{
+   struct schedFQ_t * result = (struct schedFQ_t * )sim_malloc(sizeof(struct schedFQ_t));
+   int n;
+
+   printf_debug(DEBUG_SCHED, "in\n");
+   ndesObjectInit(result, schedFQ);
+
+   // Gestion de la destination
+   result->destination = destination;
+   result->destProcessPDU = destProcessPDU;
+
+   result->algo = algo;
+   result->virtualTime = 0.0;
+   result->totalWeight = 0.0;
+
+   result->throughput = 0.0;
+   result->gpsWeight = 0.0;
+   result->gpsDate = motSim_getCurrentTime();
+
+   for (n = 0; n < SCHED_FQ_NB_TAS; n++) {
+      schedFQ_heapInit(&result->heap[n], n);
+   }
+
+   // Pas de source définie
+   result->nbInputs = 0;
+   result->indexSize = SCHED_FQ_INDEX_INIT;
+   result->index = (struct schedFQInput_t **)sim_malloc(SCHED_FQ_INDEX_INIT*sizeof(struct schedFQInput_t *));
+   for (n = 0; n < SCHED_FQ_INDEX_INIT; n++) {
+      result->index[n] = NULL;
+   }
+
+   printf_debug(DEBUG_SCHED, "out\n");
+
+   return result;
+}
+
+/*
+ * Création d'un ordonnanceur WFQ
+ */
+struct schedFQ_t * schedWFQ_create(void * destination,
+				   processPDU_t destProcessPDU,
+				   unsigned long throughput)
+{
+   struct schedFQ_t * result = schedFQ_create(destination, destProcessPDU, schedFQ_WFQ);
+
+   assert(throughput > 0);
+   result->throughput = throughput/8.0;
+
+   return result;
+}
+
+/*
+ * Création d'un ordonnanceur WF2Q+
+ */
+struct schedFQ_t * schedWF2QPlus_create(void * destination,
+					processPDU_t destProcessPDU)
+{
+   return schedFQ_create(destination, destProcessPDU, schedFQ_WF2QPlus);
+}
+
+/*
+ * Création d'un ordonnanceur SCFQ
+ */
+struct schedFQ_t * schedSCFQ_create(void * destination,
+				    processPDU_t destProcessPDU)
+{
+   return schedFQ_create(destination, destProcessPDU, schedFQ_SCFQ);
+}
+
+/*
+ * Ajout d'une source
+ */
+void schedFQ_addSource(struct schedFQ_t * sched,
+		       double weight,
+		       void * source,
+		       getPDU_t getPDU)
+{
+   struct schedFQInput_t  *  input =
+     (struct schedFQInput_t  *)sim_malloc(sizeof(struct schedFQInput_t));
+   int n;
+
+   printf_debug(DEBUG_SCHED, "in\n");
+
+   assert(weight > 0.0);
+
+   input->source = source;
+   input->getPDU = getPDU;
+   input->file = filePDU_create(NULL, NULL);
+   input->weight = weight;
+   input->num = sched->nbInputs;
+   for (n = 0; n < SCHED_FQ_NB_TAS; n++) {
+      input->key[n] = 0.0;
+      input->pos[n] = SCHED_FQ_HORS_TAS;
+   }
+   input->lastFinish = 0.0;
+
+   // Seuls WFQ et SCFQ étiquettent les PDU dès leur arrivée
+   if (sched->algo != schedFQ_WF2QPlus) {
+      input->tagSize = SCHED_FQ_TAGS_INIT;
+      input->tags = (double *)sim_malloc(SCHED_FQ_TAGS_INIT*sizeof(double));
+   } else {
+      input->tagSize = 0;
+      input->tags = NULL;
+   }
+   input->tagFirst = 0;
+   input->tagNb = 0;
+
+   sched->totalWeight += weight;
+
+   // On la range dans la table d'index, gardée à moitié vide au plus
+   if (2*(sched->nbInputs + 1) > sched->indexSize) {
+      schedFQ_growIndex(sched);
+   }
+   assert(sched->index[schedFQ_slot(sched, source)] == NULL);
+   sched->index[schedFQ_slot(sched, source)] = input;
+   sched->nbInputs++;
+
+   printf_debug(DEBUG_SCHED, "input %p : source %p, weight %f\n",
+		input, input->source, input->weight);
+   printf_debug(DEBUG_SCHED, "out\n");
+}
+
+/*
+ * Le temps virtuel courant
+ */
+double schedFQ_getVirtualTime(struct schedFQ_t * sched)
+{
+   if (sched->algo == schedFQ_WFQ) {
+      schedFQ_updateGPS(sched);
+   }
+   return sched->virtualTime;
+}
+
+/*----------------------------------------------------------------------*/
+/*   L'ordonnancement                                                   */
+/*----------------------------------------------------------------------*/
+
+/*
+ * La fonction permettant de demander une PDU à notre scheduler
+ * C'est ici qu'est implanté l'algorithme
+ */
+struct PDU_t * schedFQ_getPDU(void * s)
+{
+   struct schedFQ_t      * sched = (struct schedFQ_t * )s;
+   struct PDU_t          * result;
+   struct schedFQInput_t * in;
+   double                  finish;
+
+   printf_debug(DEBUG_SCHED, "in\n");
+
+   if (sched->algo == schedFQ_WF2QPlus) {
+      // Si aucune source n'est éligible, le temps virtuel rattrape la
+      // plus petite étiquette de début
+      in = schedFQ_heapTop(&sched->heap[SCHED_FQ_WAIT]);
+      if ((sched->heap[SCHED_FQ_SELECT].nb == 0) && (in != NULL)
+	  && (in->key[SCHED_FQ_WAIT] > sched->virtualTime)) {
+         sched->virtualTime = in->key[SCHED_FQ_WAIT];
+      }
+      // Les sources devenues éligibles sont candidates
+      while (((in = schedFQ_heapTop(&sched->heap[SCHED_FQ_WAIT])) != NULL)
+	     && (in->key[SCHED_FQ_WAIT] <= sched->virtualTime)) {
+         schedFQ_heapRemove(&sched->heap[SCHED_FQ_WAIT], in);
+         schedFQ_heapInsert(&sched->heap[SCHED_FQ_SELECT], in);
+      }
+   }
+
+   // La candidate de plus petite étiquette de fin
+   in = schedFQ_heapTop(&sched->heap[SCHED_FQ_SELECT]);
+   if (in == NULL) {
+      printf_debug(DEBUG_SCHED, "No active source, aborting\n");
+      return NULL;
+   }
+
+   result = filePDU_extract(in->file);
+   assert(result != NULL);
+
+   printf_debug(DEBUG_SCHED, "input %p (source %p) : finish %f, virtual time %f\n",
+		in, in->source, in->key[SCHED_FQ_SELECT], sched->virtualTime);
+
+   if (sched->algo == schedFQ_WF2QPlus) {
+      // Le temps virtuel avance du travail effectué, puis la PDU
+      // suivante commence à la fin de celle-ci
+      sched->virtualTime += PDU_size(result)/sched->totalWeight;
+      schedFQ_heapRemove(&sched->heap[SCHED_FQ_SELECT], in);
+      if (filePDU_length(in->file) > 0) {
+         schedFQ_tagHead(sched, in, in->lastFinish, filePDU_size_PDU_n(in->file, 1));
+      }
+   } else {
+      finish = schedFQ_popTag(in);
+      // Pour SCFQ, le temps virtuel est l'étiquette de la PDU servie
+      if (sched->algo == schedFQ_SCFQ) {
+         sched->virtualTime = finish;
+      }
+      if (filePDU_length(in->file) > 0) {
+         in->key[SCHED_FQ_SELECT] = schedFQ_headTag(in);
+         schedFQ_heapUpdate(&sched->heap[SCHED_FQ_SELECT], in);
+      } else {
+         schedFQ_heapRemove(&sched->heap[SCHED_FQ_SELECT], in);
+      }
+   }
+
+   printf_debug(DEBUG_SCHED, "scheduling PDU %d (size %d)\n",
+                PDU_id(result),
+                PDU_size(result));
+
+   ndesLog_tracePDU(NDESLOG_SCHED, result, ndesLog_out, schedFQ_getObjectId(sched));
+
+   return result;
+}
+
+/*
+ * La fonction de soumission d'un paquet à notre ordonnanceur
+ */
+int schedFQ_processPDU(void *s,
+		       getPDU_t getPDU,
+		       void * source)
+{
+   int                     result;
+   struct schedFQ_t      * sched = (struct schedFQ_t *)s;
+   struct schedFQInput_t * src;
+   struct PDU_t          * pdu;
+   int                     wasEmpty;
+   double                  finish;
+
+   printf_debug(DEBUG_SCHED, "in\n");
+
+   // Si c'est un test de dispo, je suis prêt !
+   if ((getPDU == NULL) || (source == NULL)) {
+      printf_debug(DEBUG_ALWAYS, "getPDU/source should not be NULL\n");
+      result = 1;
+   } else {
+      // On cherche l'entrée de la source, qui doit être connue
+      src = sched->index[schedFQ_slot(sched, source)];
+      assert(src != NULL);
+
+      // On prend le paquet et on le met dans la file correspondante
+      pdu = src->getPDU(src->source);
+      assert(pdu != NULL);
+      wasEmpty = (filePDU_length(src->file) == 0);
+      filePDU_insert(src->file, pdu);
+
+      switch (sched->algo) {
+         case schedFQ_WFQ :
+            // Le système fluide est amené à la date d'arrivée, la
+            // source y est (ou reste) active
+            schedFQ_updateGPS(sched);
+            finish = schedFQ_tagArrival(sched, src, PDU_size(pdu));
+            src->key[SCHED_FQ_GPS] = finish;
+            if (src->pos[SCHED_FQ_GPS] == SCHED_FQ_HORS_TAS) {
+               schedFQ_heapInsert(&sched->heap[SCHED_FQ_GPS], src);
+               sched->gpsWeight += src->weight;
+            } else {
+               schedFQ_heapUpdate(&sched->heap[SCHED_FQ_GPS], src);
+            }
+            if (wasEmpty) {
+               src->key[SCHED_FQ_SELECT] = finish;
+               schedFQ_heapInsert(&sched->heap[SCHED_FQ_SELECT], src);
+            }
+         break;
+         case schedFQ_SCFQ :
+            finish = schedFQ_tagArrival(sched, src, PDU_size(pdu));
+            if (wasEmpty) {
+               src->key[SCHED_FQ_SELECT] = finish;
+               schedFQ_heapInsert(&sched->heap[SCHED_FQ_SELECT], src);
+            }
+         break;
+         case schedFQ_WF2QPlus :
+            // Seule la PDU de tête est étiquetée
+            if (wasEmpty) {
+               schedFQ_tagHead(sched, src,
+			       (src->lastFinish > sched->virtualTime)?src->lastFinish:sched->virtualTime,
+			       PDU_size(pdu));
+            }
+         break;
+      }
+
+      // Si l'aval est dispo, on lui dit de venir chercher une PDU, ce
+      // qui déclanchera l'ordonnancement
+      printf_debug(DEBUG_SCHED, "on signale que la PDU %d (size %d) est dispo\n",
+		PDU_id(pdu),
+		PDU_size(pdu));
+      result = sched->destProcessPDU(sched->destination,
+				     schedFQ_getPDU,
+				     sched);
+   }
+
+   printf_debug(DEBUG_SCHED, "out %d\n", result);
+
+   return result;
+}
@@ -32,21 +32,120 @@ static struct schedACM_func_t schedKS_func = {
 struct sched_kse_t {
    struct schedACM_t * schedACM;
 
-   // La chose suivante est une variable de l'algo. Je sais que c'est crade de
-   // la mettre là, mais   elle est lourde à initialiser dynamiquement !
-   t_remplissage remplissage[NB_SOUS_CAS_MAX];
+   // La chose suivante est une variable de l'algo. Elle est lourde à
+   // initialiser, elle n'est donc allouée que pour les algorithmes
+   // qui en ont besoin (pas pour KS_ALGO_DYNAMIC)
+   t_remplissage * remplissage;
+
+   // L'algorithme de résolution (KS_ALGO_*)
+   int algo;
 
    // Cherche-t-on vraiment tous les cas ?
    int rechercheExhaustive;
 
+   // Détection des doublons de la recherche exhaustive : les états
+   // sont repérés par un hachage du vecteur des nombres de paquets
+   // dans une table à adressage ouvert
+   int            nbEtats;      //!< Nombre d'états créés (contigus)
+   unsigned int * hashEtat;     //!< Hachage de chaque état
+   int          * caseEtat;     //!< Case de la table occupée par chaque état
+   int          * tableHachage; //!< Indice de l'état + 1 (0 si libre)
+   unsigned int * multHachage;  //!< Coefficient de chaque file (m, q)
+
+   // Les variables de la programmation dynamique
+   int      capaciteMax;  //!< Plus grande charge utile (en octets)
+   int      nbExecutants; //!< Nombre de tampons de travail alloués
+   struct ks_travail_t * travail; //!< Un tampon par exécutant
+   t_remplissage * solutions; //!< La solution de chaque MODCOD
+};
+
+/**
+ * @brief Les tampons de travail de la programmation dynamique
+ *
+ * Chaque exécutant (voir schedACM_solveAllModcods) dispose des siens.
+ */
+struct ks_travail_t {
+   double * dpValeur;     //!< Meilleur intérêt par volume disponible
+   double * dpPrecedent;  //!< Idem, avant prise en compte de la file
+   int    * dpChoix;      //!< Nombre de paquets retenus par file et volume
+   int    * dpCumul;      //!< Tailles cumulées des têtes de files
+   int    * dpDebutCumul; //!< Début de chaque file dans dpCumul
+   int    * dpNbCumul;    //!< Nombre de paquets candidats par file
+   int      dpLgCumul;    //!< Taille allouée de dpCumul
 };
 
+/*
+ * Taille de la table de hachage des états (une puissance de 2, au
+ * moins le double du nombre d'états pour que les séquences de sondage
+ * restent courtes)
+ */
+#define KS_TAILLE_HACHAGE (2*NB_SOUS_CAS_MAX)
+
+/*
+ * Case de départ dans la table pour un hachage donné
+ */
+static inline int ks_caseHachage(unsigned int h)
+{
+   h ^= h >> 16;
+   h *= 0x85EBCA6Bu;
+   h ^= h >> 13;
+   return h & (KS_TAILLE_HACHAGE - 1);
+}
+
+/*
+ * Enregistrement de l'état r dans la table de hachage. La case
+ * utilisée est retournée.
+ */
+static int ks_rangerEtat(struct sched_kse_t * sched, int r)
+{
+   int c = ks_caseHachage(sched->hashEtat[r]);
+
+   while (sched->tableHachage[c]) {
+      c = (c + 1) & (KS_TAILLE_HACHAGE - 1);
+   }
+   sched->tableHachage[c] = r + 1;
+
+   return c;
+}
+
+/*
+ * Recherche d'un état identique à l'état rCourant auquel on ajoute un
+ * paquet de la file (m, q). Le hachage h de cet état et son volume
+ * sont fournis. Retourne l'indice de l'état trouvé ou -1.
+ */
+static int ks_chercherEtat(struct sched_kse_t * sched, unsigned int h, int volume,
+                           int rCourant, int m, int q)
+{
+   int c = ks_caseHachage(h);
+   int rS, mt, qt, doublon;
+
+   while (sched->tableHachage[c]) {
+      rS = sched->tableHachage[c] - 1;
+      if ((sched->hashEtat[rS] == h) && (sched->remplissage[rS].volumeTotal == volume)) {
+         // C'est la même jusqu'à preuve du contraire, on compare file par file
+         doublon = 1;
+         for (mt = 0; (doublon) && (mt < schedACM_getNbModCod(sched->schedACM)); mt++) {
+            for (qt = 0; (doublon) && (qt < schedACM_getNbQoS(sched->schedACM)); qt++) {
+               doublon = (sched->remplissage[rCourant].nbrePaquets[mt][qt] + (((mt==m) && (qt==q))?1:0)
+                          == sched->remplissage[rS].nbrePaquets[mt][qt]);
+	    }
+	 }
+         if (doublon) {
+            return rS;
+	 }
+      }
+      c = (c + 1) & (KS_TAILLE_HACHAGE - 1);
+   }
+
+   return -1;
+}
+
 /**
  * @brief Création et initialisation d'un ordonnanceur
  * @param dvbs2ll le lien sur lequel sont transmises les trames
  * @param nbQoS le nombre de files de qualité de service
  * @param declOK autorise-t-on le déclassement ?
- * @param exhaustif faut-il utiliser un algorithme exhaustif ?
+ * @param algo l'algorithme de résolution (KS_ALGO_*)
  *
  * Création d'un scheduler avec sa "destination". Cette dernière doit
  * être de type struct DVBS2ll_t  et avoir déjà été complêtement
@@ -57,20 +156,65 @@ struct sched_kse_t {
 struct schedACM_t * sched_kse_create(struct DVBS2ll_t * dvbs2ll,
 				     int nbQoS,
 				     int declOK,
-				     int exhaustif)
+				     int algo)
 {
+   int mc, nbFiles;
    struct sched_kse_t * result = (struct sched_kse_t * ) sim_malloc(sizeof(struct sched_kse_t));
    assert(result);
 
    result->schedACM = schedACM_create(dvbs2ll, nbQoS, declOK, &schedKS_func);
    schedACM_setPrivate(result->schedACM, result);
 
-   // On initialise le tableau de l'algo
-   tabRemplissage_init(result->remplissage, NB_SOUS_CAS_MAX, DVBS2ll_nbModcod(dvbs2ll), nbQoS);
+   result->algo = algo;
+   result->rechercheExhaustive = (algo == KS_ALGO_EXHAUSTIVE);
+   result->remplissage = NULL;
+   result->hashEtat = NULL;
+   result->caseEtat = NULL;
+   result->tableHachage = NULL;
+   result->multHachage = NULL;
+   result->nbExecutants = 0;
+   result->travail = NULL;
+   result->solutions = NULL;
+
+   if (algo == KS_ALGO_DYNAMIC) {
+      // Les tables sont dimensionnées pour la plus grosse BBFRAME
+      result->capaciteMax = 0;
+      for (mc = 0; mc < DVBS2ll_nbModcod(dvbs2ll); mc++) {
+         if (DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8 > result->capaciteMax) {
+            result->capaciteMax = DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8;
+	 }
+      }
+      // Les tampons de travail seront alloués au premier
+      // ordonnancement, selon le nombre d'exécutants
+      result->solutions = (t_remplissage *)sim_malloc(DVBS2ll_nbModcod(dvbs2ll)*sizeof(t_remplissage));
+      assert(result->solutions);
+      tabRemplissage_init(result->solutions, DVBS2ll_nbModcod(dvbs2ll), DVBS2ll_nbModcod(dvbs2ll), nbQoS);
+   } else {
+      // On initialise le tableau de l'algo
+      result->remplissage = (t_remplissage *)sim_malloc(NB_SOUS_CAS_MAX*sizeof(t_remplissage));
+      assert(result->remplissage);
+      tabRemplissage_init(result->remplissage, NB_SOUS_CAS_MAX, DVBS2ll_nbModcod(dvbs2ll), nbQoS);
+      result->nbEtats = 1;
+   }
 
-   printf_debug(DEBUG_KS, "%p created (in schedACM %p)\n", result, result->schedACM);
+   if (algo == KS_ALGO_EXHAUSTIVE) {
+      nbFiles = DVBS2ll_nbModcod(dvbs2ll)*nbQoS;
+      result->hashEtat = (unsigned int *)sim_malloc(NB_SOUS_CAS_MAX*sizeof(unsigned int));
+      result->caseEtat = (int *)sim_malloc(NB_SOUS_CAS_MAX*sizeof(int));
+      result->tableHachage = (int *)sim_malloc(KS_TAILLE_HACHAGE*sizeof(int));
+      result->multHachage = (unsigned int *)sim_malloc(nbFiles*sizeof(unsigned int));
+      assert(result->hashEtat && result->caseEtat && result->tableHachage && result->multHachage);
+      bzero(result->tableHachage, KS_TAILLE_HACHAGE*sizeof(int));
+      // Des coefficients impairs et bien dispersés
+      for (mc = 0; mc < nbFiles; mc++) {
+         result->multHachage[mc] = (2*mc + 1)*0x9E3779B1u;
+      }
+      // L'état vide est toujours l'état 0
+      result->hashEtat[0] = 0;
+      result->caseEtat[0] = ks_rangerEtat(result, 0);
+   }
 
-   result->rechercheExhaustive = exhaustif;
+   printf_debug(DEBUG_KS, "%p created (in schedACM %p)\n", result, result->schedACM);
 
    return result->schedACM;
 
@@ -111,8 +255,8 @@ void KS_afficherFiles(struct sched_kse_t * sched, int mc)
 	printf_debug(DEBUG_KS, "    QoS %d (%d PDUs)\n", q, filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)));
 	 for (n = 1; n <= filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)); n++) {
             id = filePDU_id_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), n);
-            taille = filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), n);
-	    gain = gainUtilite(schedACM_getQoS(sched->schedACM, m, q), taille, mc, schedACM_getACMLink(sched->schedACM));
+            taille = schedACM_getPDUSize(sched->schedACM, m, q, n);
+	    gain = schedACM_gainUtilite(sched->schedACM, m, q, taille, mc);
             printf_debug(DEBUG_KS, "      [%d] : PDU %d (taille %d, gain %f)\n", n, id, 
 			 taille, 
 			 gain);
@@ -146,7 +290,7 @@ void knapsackParModCod(int mc, struct sched_kse_t * sched)
    int volume;
    int fini;
    //   int choice; // Pour tirer au hasard en cas d'égalité
-   int mt, qt, doublon; // Pour la recherche de doublon dans la démarche exhaustive
+   unsigned int h; // Pour la recherche de doublon dans la démarche exhaustive
 
    do { // Pour chaque taille de BBFRAME
       printf_debug(DEBUG_KS_VERB, "       ---< Solution %d en cours d'analyse (volume %d / interet %5.2e) >---\n",
@@ -168,7 +312,7 @@ void knapsackParModCod(int mc, struct sched_kse_t * sched)
 
             printf_debug(DEBUG_KS_VERB, "m/q = %d/%d, rCourant = %d (v %d, i %5.2e)\n", m, q, rCourant, sched->remplissage[rCourant].volumeTotal, sched->remplissage[rCourant].interet);
 	    printf_debug(DEBUG_KS_VERB, "  Paquet de taille %d de q[%d][%d] (%d/%d paquets) dans BBF de %d oqp/%d ?\n",
-                       (filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))>(sched->remplissage[rCourant].nbrePaquets[m][q]))?filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), sched->remplissage[rCourant].nbrePaquets[m][q]+1):0,
+                       (filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q))>(sched->remplissage[rCourant].nbrePaquets[m][q]))?schedACM_getPDUSize(sched->schedACM, m, q, sched->remplissage[rCourant].nbrePaquets[m][q]+1):0,
                        m, q,
                        sched->remplissage[rCourant].nbrePaquets[m][q],
                        filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)),
@@ -176,82 +320,44 @@ void knapsackParModCod(int mc, struct sched_kse_t * sched)
 		       DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8);
             // ... s'il reste un paquet qui tienne (pas de fragmentation pour le moment) ...
             if ((sched->remplissage[rCourant].nbrePaquets[m][q] < filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q)))
-		&& (sched->remplissage[rCourant].volumeTotal + filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), sched->remplissage[rCourant].nbrePaquets[m][q]+1) <= (DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8))) {
+		&& (sched->remplissage[rCourant].volumeTotal + schedACM_getPDUSize(sched->schedACM, m, q, sched->remplissage[rCourant].nbrePaquets[m][q]+1) <= (DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8))) {
 	       printf_debug(DEBUG_KS_VERB, "      Oui\n");
-               tp = filePDU_size_PDU_n(schedACM_getInputQueue(sched->schedACM, m, q), sched->remplissage[rCourant].nbrePaquets[m][q]+1);
+               tp = schedACM_getPDUSize(sched->schedACM, m, q, sched->remplissage[rCourant].nbrePaquets[m][q]+1);
                printf_debug(DEBUG_KS_VERB, "         (taille %d)\n", tp);
                // ... quelle influence a ce remplissage sur l'utilité ?
-               interet = sched->remplissage[rCourant].interet + gainUtilite(schedACM_getQoS(sched->schedACM, m, q), tp, mc, schedACM_getACMLink(sched->schedACM));
+               interet = sched->remplissage[rCourant].interet + schedACM_gainUtilite(sched->schedACM, m, q, tp, mc);
                printf_debug(DEBUG_KS_VERB, "         (interet %5.2e)\n", interet);
                // ... et à quel volume total cela nous conduit ?
                volume = sched->remplissage[rCourant].volumeTotal + tp;
                printf_debug(DEBUG_KS_VERB, "         vers volume %d\n", volume);
 
                if (sched->rechercheExhaustive) {
-                  // Cherchons une place
-                  rDispo = rCourant + 1; 
-                  while ((rDispo < NB_SOUS_CAS_MAX) && (sched->remplissage[rDispo].volumeTotal != 0)) {
-                     rDispo++;
-	          }
+                  // Les états sont créés de façon contigüe, la place
+                  // disponible est donc la suivante
+                  rDispo = sched->nbEtats;
                   // Cherchons si la meme configuration existait déjà
-                  rS =  1;
-                  doublon = 0;
-                  while ((!doublon) &&(rS < NB_SOUS_CAS_MAX) && (sched->remplissage[rS].volumeTotal != 0)) {
-		     if (sched->remplissage[rS].volumeTotal == volume) {
-                       doublon = 1; // C'est la même jusqu'à preuve du contraire
-                       // On compare file par file 
-		       for (mt = 0; mt < schedACM_getNbModCod(sched->schedACM); mt++) {
-                          for (qt = 0; qt < schedACM_getNbQoS(sched->schedACM); qt++) {
-			    if ((mt==m) && (qt==q)) {
-                               doublon = doublon 
-				 && (sched->remplissage[rCourant].nbrePaquets[mt][qt] +1
-				     == sched->remplissage[rS].nbrePaquets[mt][qt] );
-			    } else {
-                               doublon = doublon 
-				 && (sched->remplissage[rCourant].nbrePaquets[mt][qt]
-				     == sched->remplissage[rS].nbrePaquets[mt][qt] );
-			    }
-			  }
-		       }
-		       if (doublon) {
-                          sched->remplissage[rS].nbChoix++;
-		       }
-		     }
-                     rS++;
-	          }
-                  // Sinon, il faut sauver ce nouveau résultat
-	          if (!doublon) {
-                     if (rDispo < NB_SOUS_CAS_MAX)  {
-                        schedACM_tryingNewSolution(sched->schedACM);
-                        printf_debug(DEBUG_KS_VERB, "             Nouvel etat cree bis [id %d, taille %d]\n", rDispo, volume);
-		        remplissage_copy(&(sched->remplissage[rCourant]), &(sched->remplissage[rDispo]), schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
-                        sched->remplissage[rDispo].volumeTotal = volume;
-                        sched->remplissage[rDispo].interet = interet;
-                        sched->remplissage[rDispo].nbChoix = 1;
-                        sched->remplissage[rDispo].nbrePaquets[m][q]++;
-		     } else {
-/* A des fins de debogage, on va dumper les cas, pour voir !
-	   	        motSim_error(MS_WARN, "NB_SOUS_CAS_MAX=%d mal dimensionne bis (%d etats crees)!!!\n",
-				     NB_SOUS_CAS_MAX,
-				     schedACM_getNbSolutions(sched->schedACM));
-		        for (rS=0; rS<NB_SOUS_CAS_MAX; rS++){
-		 	  printf("[%d] %d ", rS, sched->remplissage[rS].volumeTotal);
-		 	  for(mt = 0; mt < schedACM_getNbModCod(sched->schedACM); mt++) {
-                             for (qt = 0; qt < schedACM_getNbQoS(sched->schedACM); qt++) {
-			       printf("%d ", sched->remplissage[rS].nbrePaquets[mt][qt]);
-			     }
-                             printf("- ");
-                          }
-			  printf("(%d)\n", sched->remplissage[rS].nbChoix);
-		        }
-*/
-	   	        motSim_error(MS_FATAL, "NB_SOUS_CAS_MAX=%d mal dimensionne bis (%d etats crees)!!!\n",
-				     NB_SOUS_CAS_MAX,
-				     schedACM_getNbSolutions(sched->schedACM));
-
-		     }
-	          } else {
+                  // grâce au hachage du vecteur des nombres de paquets
+                  h = sched->hashEtat[rCourant] + sched->multHachage[m*schedACM_getNbQoS(sched->schedACM) + q];
+                  rS = ks_chercherEtat(sched, h, volume, rCourant, m, q);
+                  if (rS >= 0) {
+                     sched->remplissage[rS].nbChoix++;
 	             printf_debug(DEBUG_KS_VERB, "             Deja vu\n");
+                  // Sinon, il faut sauver ce nouveau résultat
+		  } else if (rDispo < NB_SOUS_CAS_MAX)  {
+                     schedACM_tryingNewSolution(sched->schedACM);
+                     printf_debug(DEBUG_KS_VERB, "             Nouvel etat cree bis [id %d, taille %d]\n", rDispo, volume);
+		     remplissage_copy(&(sched->remplissage[rCourant]), &(sched->remplissage[rDispo]), schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+                     sched->remplissage[rDispo].volumeTotal = volume;
+                     sched->remplissage[rDispo].interet = interet;
+                     sched->remplissage[rDispo].nbChoix = 1;
+                     sched->remplissage[rDispo].nbrePaquets[m][q]++;
+                     sched->hashEtat[rDispo] = h;
+                     sched->caseEtat[rDispo] = ks_rangerEtat(sched, rDispo);
+                     sched->nbEtats++;
+		  } else {
+	   	     motSim_error(MS_FATAL, "NB_SOUS_CAS_MAX=%d mal dimensionne bis (%d etats crees)!!!\n",
+				  NB_SOUS_CAS_MAX,
+				  schedACM_getNbSolutions(sched->schedACM));
 		  }
 
 	       } else { // Recherche non totalement exhaustive !!
@@ -355,7 +461,152 @@ void knapsackParModCod(int mc, struct sched_kse_t * sched)
    };
 
    // On nettoie le tableau des remplissages
-   tabRemplissage_raz(sched->remplissage, NB_SOUS_CAS_MAX, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+   if (sched->rechercheExhaustive) {
+      // Seuls les états créés sont à nettoyer, l'état vide reste en place
+      for (rS = 1; rS < sched->nbEtats; rS++) {
+         sched->tableHachage[sched->caseEtat[rS]] = 0;
+      }
+      tabRemplissage_raz(sched->remplissage, sched->nbEtats, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+      sched->nbEtats = 1;
+   } else {
+      tabRemplissage_raz(sched->remplissage, NB_SOUS_CAS_MAX, schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+   }
+}
+
+/*
+ * Allocation des tampons de travail de la programmation dynamique
+ * pour nb exécutants
+ */
+static void ks_allouerTravail(struct sched_kse_t * sched, int nb)
+{
+   int n;
+   int nbFiles = schedACM_getNbModCod(sched->schedACM)*schedACM_getNbQoS(sched->schedACM);
+   struct ks_travail_t * t;
+
+   sched->travail = (struct ks_travail_t *)realloc(sched->travail, nb*sizeof(struct ks_travail_t));
+   assert(sched->travail);
+   for (n = sched->nbExecutants; n < nb; n++) {
+      t = &(sched->travail[n]);
+      t->dpValeur = (double *)sim_malloc((sched->capaciteMax + 1)*sizeof(double));
+      t->dpPrecedent = (double *)sim_malloc((sched->capaciteMax + 1)*sizeof(double));
+      t->dpChoix = (int *)sim_malloc(nbFiles*(sched->capaciteMax + 1)*sizeof(int));
+      t->dpDebutCumul = (int *)sim_malloc(nbFiles*sizeof(int));
+      t->dpNbCumul = (int *)sim_malloc(nbFiles*sizeof(int));
+      assert(t->dpValeur && t->dpPrecedent && t->dpChoix && t->dpDebutCumul && t->dpNbCumul);
+      t->dpCumul = NULL;
+      t->dpLgCumul = 0;
+   }
+   sched->nbExecutants = nb;
+}
+
+/**
+ * @brief Résolution par programmation dynamique du problème du sac à
+ * dos avec une BBFRAME dont le modcod est passé en paramètre
+ * @param sched l'ordonnanceur à utiliser
+ * @param mc le numéro du MODCOD à tester
+ * @param solution (out) la meilleure solution pour ce MODCOD
+ * @param executant le numéro de l'exécutant
+ *
+ * Chaque file candidate est un groupe dont on choisit un préfixe de k
+ * paquets (pas de fragmentation, et on respecte l'ordre FIFO). Le gain
+ * d'un paquet étant proportionnel à sa taille au sein d'une file, la
+ * valeur d'un préfixe est le gain par octet de la file multiplié par
+ * le volume cumulé. On calcule donc, file après file, le meilleur
+ * intérêt atteignable pour chaque volume c de 0 à la capacité de la
+ * BBFRAME, en notant dans dpChoix le nombre de paquets retenus ; la
+ * solution est ensuite reconstruite en remontant ces choix.
+ *
+ * Le coût est en O(capacité x nombre de paquets candidats) et la
+ * mémoire est bornée par construction : pas de table d'états qui
+ * déborde.
+ *
+ * Cette fonction est de type schedACM_solveMC_t : elle n'utilise que
+ * les tampons de son exécutant et place son résultat dans solution.
+ */
+void knapsackDynamiqueParModCod(struct sched_kse_t * sched, int mc, t_remplissage * solution, int executant)
+{
+   struct DVBS2ll_t * dvbs2ll = schedACM_getACMLink(sched->schedACM);
+   struct ks_travail_t * t = &(sched->travail[executant]);
+   int nbQoS = schedACM_getNbQoS(sched->schedACM);
+   int capacite = DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/8;
+   int mMax = schedACM_getReclassification(sched->schedACM)?schedACM_getNbModCod(sched->schedACM):(mc+1);
+   int m, q, g, nbGroupes, c, k, kMeilleur, lg;
+   int * cumul;
+   int * choix;
+   double gainParOctet, valeur, meilleure;
+   double * tmp;
+
+   assert(capacite <= sched->capaciteMax);
+
+   // Tailles cumulées des têtes de chaque file candidate
+   nbGroupes = (mMax - mc)*nbQoS;
+   lg = 0;
+   for (g = 0; g < nbGroupes; g++) {
+      m = mc + g/nbQoS;
+      q = g%nbQoS;
+      k = filePDU_length(schedACM_getInputQueue(sched->schedACM, m, q));
+      if (k > capacite) {
+         k = capacite; // Au delà, il faudrait des paquets vides
+      }
+      if (lg + k + 1 > t->dpLgCumul) {
+         t->dpLgCumul = 2*(lg + k + 1);
+         t->dpCumul = (int *)realloc(t->dpCumul, t->dpLgCumul*sizeof(int));
+         assert(t->dpCumul);
+      }
+      t->dpDebutCumul[g] = lg;
+      t->dpNbCumul[g] = schedACM_cumulatedSizes(sched->schedACM, m, q, capacite, k, t->dpCumul + lg);
+      lg += t->dpNbCumul[g] + 1;
+   }
+
+   // Aucune file : intérêt nul pour tous les volumes
+   for (c = 0; c <= capacite; c++) {
+      t->dpValeur[c] = 0.0;
+   }
+
+   for (g = 0; g < nbGroupes; g++) {
+      m = mc + g/nbQoS;
+      q = g%nbQoS;
+      cumul = t->dpCumul + t->dpDebutCumul[g];
+      choix = t->dpChoix + g*(sched->capaciteMax + 1);
+
+      tmp = t->dpPrecedent;
+      t->dpPrecedent = t->dpValeur;
+      t->dpValeur = tmp;
+
+      gainParOctet = schedACM_gainUtilite(sched->schedACM, m, q, 1, mc);
+
+      for (c = 0; c <= capacite; c++) {
+         meilleure = t->dpPrecedent[c];
+         kMeilleur = 0;
+         // Un gain négatif ou nul ne justifie pas d'emmener des paquets
+         if (gainParOctet > 0.0) {
+            for (k = 1; (k <= t->dpNbCumul[g]) && (cumul[k] <= c); k++) {
+               valeur = t->dpPrecedent[c - cumul[k]] + gainParOctet*cumul[k];
+               if (valeur > meilleure) {
+                  meilleure = valeur;
+                  kMeilleur = k;
+               }
+            }
+         }
+         t->dpValeur[c] = meilleure;
+         choix[c] = kMeilleur;
+      }
+   }
+
+   // Reconstruction de la solution en remontant les choix
+   solution->interet = t->dpValeur[capacite];
+   c = capacite;
+   for (g = nbGroupes - 1; g >= 0; g--) {
+      k = t->dpChoix[g*(sched->capaciteMax + 1) + c];
+      solution->nbrePaquets[mc + g/nbQoS][g%nbQoS] = k;
+      c -= t->dpCumul[t->dpDebutCumul[g] + k];
+      solution->volumeTotal += t->dpCumul[t->dpDebutCumul[g] + k];
+   }
+   assert(c >= 0);
+   schedACM_tryingNewSolution(sched->schedACM);
+
+   printf_debug(DEBUG_KS, "mc %d : interet %5.2e, volume %d/%d\n", mc,
+		solution->interet, solution->volumeTotal, capacite);
 }
 
 /**
@@ -387,13 +638,30 @@ void scheduler_knapsack_exhaustif(struct sched_kse_t * sched)
     */
    printf_debug(DEBUG_KS, "********************DEBUT KNAPSACK****************************\n");
    //   KS_afficherFiles(sched, 0);
+
+   // La programmation dynamique traite les MODCODs indépendamment,
+   // éventuellement en parallèle ; les solutions sont ensuite réduites
+   // dans l'ordre des MODCODs, comme dans la version séquentielle
+   if (sched->algo == KS_ALGO_DYNAMIC) {
+      if (sched->nbExecutants < schedACM_getNbThreads(sched->schedACM)) {
+         ks_allouerTravail(sched, schedACM_getNbThreads(sched->schedACM));
+      }
+      schedACM_solveAllModcods(sched->schedACM, (schedACM_solveMC_t)knapsackDynamiqueParModCod, sched->solutions);
+   }
    for (mc = 0; mc < schedACM_getNbModCod(sched->schedACM); mc++) {
       printf_debug(DEBUG_KS, "-------====< MODCOD %d >====-------\n", mc);
 #ifdef DEBUG_NDES
       if (debug_mask&DEBUG_ALWAYS)
       KS_afficherFiles(sched, mc);
 #endif
-      knapsackParModCod(mc, sched);
+      if (sched->algo == KS_ALGO_DYNAMIC) {
+         if (sched->solutions[mc].interet > schedACM_getSolution(sched->schedACM)->interet) {
+            remplissage_copy(&(sched->solutions[mc]), schedACM_getSolution(sched->schedACM),
+		             schedACM_getNbModCod(sched->schedACM), schedACM_getNbQoS(sched->schedACM));
+         }
+      } else {
+         knapsackParModCod(mc, sched);
+      }
 
       printf_debug(DEBUG_KS, "-------====< Ordonnancement choisi mc=%d >====-------\n",
 		   schedACM_getSolution(sched->schedACM)->modcod);
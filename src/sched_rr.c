@@ -1,9 +1,43 @@
 /** @file sched_rr.c
  *  @brief Un ordonnanceur round robin élémentaire
+ *
+ *  L'ordonnanceur maintient la liste circulaire de ses entrées
+ *  actives, c'est-à-dire celles qui lui ont signalé une PDU (par
+ *  rrSched_processPDU) et qui ne se sont pas encore révélées
+ *  vides. Le choix de la prochaine source est donc en O(1), quel que
+ *  soit le nombre d'entrées inactives, qui ne sont jamais
+ *  sollicitées.
  */
 
+#include <stdlib.h>    // realloc, free
+#include <stdint.h>    // uintptr_t
+
 #include <sched_rr.h>
 
+/**
+ * Taille initiale des tableaux d'entrées
+ */
+#define SCHED_RR_NB_INPUT_INIT 8
+
+/**
+ * Fin de la liste des entrées actives
+ */
+#define SCHED_RR_NONE (-1)
+
+/**
+ * Une entrée de l'ordonnanceur
+ */
+struct rrSchedInput_t {
+   //! La source (file d'entrée)
+   void     * source;
+   //! Fonction d'émission de la source
+   getPDU_t   getPDU;
+   //! L'entrée est-elle dans la liste des actives ?
+   int        active;
+   //! L'entrée active suivante
+   int        next;
+};
+
 /**
  * Structure définissant notre ordonanceur
  */
@@ -15,15 +49,65 @@ struct rrSched_t {
 
    //! Nombre de sources (files d'entrée)
    int        nbSources;
-   //! Les sources (files d'entrée)
-   void     * sources[SCHED_RR_NB_INPUT_MAX];
-   //! Fonctions d'émission des souces
-   getPDU_t   srcGetPDU[SCHED_RR_NB_INPUT_MAX];
+   //! Nombre d'entrées allouées
+   int        nbSourcesMax;
+   //! Les entrées
+   struct rrSchedInput_t * inputs;
+
+   //! Table (adressage ouvert) des numéros d'entrée, indexée par la
+   //! source, de taille toujours au moins double de nbSources
+   int        indexSize;
+   int      * index;
 
-   //! La dernière source servie par le tourniquet
-   int lastServed;
+   //! La prochaine entrée active à servir (tête de liste)
+   int        head;
+   //! La dernière entrée active (queue de liste)
+   int        tail;
 };
 
+/*
+ * Position de la source dans la table d'index : soit la case qui
+ * contient son numéro d'entrée, soit la case vide où l'insérer
+ */
+static int rrSched_slot(struct rrSched_t * sched, void * source)
+{
+   unsigned int h = (unsigned int)(((uintptr_t)source >> 4) * 2654435761u);
+   int s = h & (sched->indexSize - 1);
+
+   while ((sched->index[s] != SCHED_RR_NONE)
+	  && (sched->inputs[sched->index[s]].source != source)) {
+      s = (s + 1) & (sched->indexSize - 1);
+   }
+   return s;
+}
+
+/*
+ * Numéro de l'entrée associée à une source (SCHED_RR_NONE si elle
+ * n'a pas été ajoutée)
+ */
+static int rrSched_lookup(struct rrSched_t * sched, void * source)
+{
+   return sched->index[rrSched_slot(sched, source)];
+}
+
+/*
+ * (Re)construction de la table d'index avec une taille donnée
+ */
+static void rrSched_buildIndex(struct rrSched_t * sched, int size)
+{
+   int n;
+
+   free(sched->index);
+   sched->indexSize = size;
+   sched->index = (int *)sim_malloc(size*sizeof(int));
+   for (n = 0; n < size; n++) {
+      sched->index[n] = SCHED_RR_NONE;
+   }
+   for (n = 0; n < sched->nbSources; n++) {
+      sched->index[rrSched_slot(sched, sched->inputs[n].source)] = n;
+   }
+}
+
 /**
  * Création d'une instance de l'ordonnanceur avec la destination en
  * paramètre 
@@ -42,9 +126,14 @@ struct rrSched_t * rrSched_create(void * destination,
 
    // Pas de source définie
    result->nbSources = 0;
+   result->nbSourcesMax = SCHED_RR_NB_INPUT_INIT;
+   result->inputs = (struct rrSchedInput_t *)sim_malloc(SCHED_RR_NB_INPUT_INIT*sizeof(struct rrSchedInput_t));
+   result->index = NULL;
+   rrSched_buildIndex(result, 2*SCHED_RR_NB_INPUT_INIT);
 
-   // On commence quelquepart ...
-   result->lastServed = 0;
+   // Aucune entrée active
+   result->head = SCHED_RR_NONE;
+   result->tail = SCHED_RR_NONE;
 
    return result;
 }
@@ -56,35 +145,86 @@ void rrSched_addSource(struct rrSched_t * sched,
 		       void * source,
 		       getPDU_t getPDU)
 {
-   assert(sched->nbSources < SCHED_RR_NB_INPUT_MAX);
+   struct rrSchedInput_t * input;
+
+   assert(rrSched_lookup(sched, source) == SCHED_RR_NONE);
+
+   if (sched->nbSources == sched->nbSourcesMax) {
+      sched->nbSourcesMax *= 2;
+      sched->inputs = (struct rrSchedInput_t *)realloc(sched->inputs,
+				       sched->nbSourcesMax*sizeof(struct rrSchedInput_t));
+      assert(sched->inputs != NULL);
+   }
+
+   input = &sched->inputs[sched->nbSources];
+   input->source = source;
+   input->getPDU = getPDU;
+   input->active = 0;
+   input->next = SCHED_RR_NONE;
+   sched->nbSources++;
+
+   // On garde la table d'index à moitié vide au plus
+   if (2*sched->nbSources > sched->indexSize) {
+      rrSched_buildIndex(sched, 2*sched->indexSize);
+   } else {
+      sched->index[rrSched_slot(sched, source)] = sched->nbSources - 1;
+   }
+}
+
+/*
+ * Ajout d'une entrée en queue de la liste des actives
+ */
+static void rrSched_activate(struct rrSched_t * sched, int n)
+{
+   sched->inputs[n].active = 1;
+   sched->inputs[n].next = SCHED_RR_NONE;
+   if (sched->tail == SCHED_RR_NONE) {
+      sched->head = n;
+   } else {
+      sched->inputs[sched->tail].next = n;
+   }
+   sched->tail = n;
+}
 
-   sched->sources[sched->nbSources] = source;
-   sched->srcGetPDU[sched->nbSources++] = getPDU;
+/*
+ * Retrait de l'entrée de tête de la liste des actives
+ */
+static int rrSched_popHead(struct rrSched_t * sched)
+{
+   int n = sched->head;
+
+   sched->head = sched->inputs[n].next;
+   if (sched->head == SCHED_RR_NONE) {
+      sched->tail = SCHED_RR_NONE;
+   }
+   sched->inputs[n].active = 0;
+   return n;
 }
 
 /*
  * La fonction permettant de demander une PDU à notre scheduler
  * C'est ici qu'est implanté l'algorithme
+ *
+ * L'entrée de tête est servie puis remise en queue. Une entrée qui ne
+ * fournit rien est retirée de la liste, jusqu'à sa prochaine
+ * notification : chaque activation coûte donc au plus un appel vain.
  */
 struct PDU_t * rrSched_getPDU(void * s)
 {
    struct rrSched_t * sched = (struct rrSched_t * )s;
    struct PDU_t * result = NULL;
+   int n;
 
    assert(sched->nbSources > 0);
 
-   int next = sched->lastServed;
+   while ((result == NULL) && (sched->head != SCHED_RR_NONE)) {
+      n = rrSched_popHead(sched);
+      result = sched->inputs[n].getPDU(sched->inputs[n].source);
+      if (result) {
+         rrSched_activate(sched, n);
+      }
+   }
 
-   // Quelle est la prochaine source à servir ?
-   do {
-      // On cherche depuis la prochaine la première source qui a des
-      // choses à nous donner
-      next = (next + 1)%sched->nbSources;
-      result = sched->srcGetPDU[next](sched->sources[next]);
-   } while ((result == NULL) && (next != sched->lastServed));
-
-   if (result)
-     sched->lastServed = next;
    return result;
 }
 
@@ -96,10 +236,19 @@ int rrSched_processPDU(void *s,
 		       void * source)
 {
    int result;
+   int n;
    struct rrSched_t * sched = (struct rrSched_t *)s;
 
    printf_debug(DEBUG_SCHED, "in\n");
 
+   // La source a (au moins) une PDU à nous proposer
+   n = rrSched_lookup(sched, source);
+   if (n == SCHED_RR_NONE) {
+      motSim_error(MS_WARN, "source %p inconnue, ignoree\n", source);
+   } else if (!sched->inputs[n].active) {
+      rrSched_activate(sched, n);
+   }
+
    result = sched->destProcessPDU(sched->destination, rrSched_getPDU, sched);
 
    printf_debug(DEBUG_SCHED, "out %d\n", result);
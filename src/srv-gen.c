@@ -12,6 +12,7 @@
 #include <event.h>
 #include <date-generator.h>
 #include <srv-gen.h>
+#include <fluid-source.h>
 #include <ndesObject.h>
 #include <log.h>
 
@@ -65,6 +66,9 @@ struct srvGen_t {
 
    // Les sondes
    struct probe_t * serviceProbe;
+
+   // Le trafic de fond fluide éventuel
+   struct fluidSource_t * fluid;
 };
 
 /**
@@ -109,6 +113,8 @@ struct srvGen_t * srvGen_create(void * destination,
 
    result->serviceProbe = NULL;
 
+   result->fluid = NULL;
+
    return result;
 }
 
@@ -139,7 +145,9 @@ void srvGen_startService(struct srvGen_t * srv, struct PDU_t * pdu)
    srv->currentPDU = pdu;
 
    //Déterminer une date de fin en fonction du temps de traitement
-   if (srv->serviceTime == serviceTimeProp){
+   if (srv->fluid) {
+      date = fluidSource_getServiceEnd(srv->fluid, PDU_size(pdu));
+   } else if (srv->serviceTime == serviceTimeProp){
       date = motSim_getCurrentTime() + PDU_size(pdu) * srv->serviceTimeParameter;
    } else {
       assert(srv->dateGenerator);
@@ -188,7 +196,7 @@ void srvGen_terminateProcess(struct srvGen_t * srv)
       pdu = srv->getPDU(srv->source);
       // Est-elle encore prete ?
       if (pdu) {
-         ndesLog_logLineF(PDU_getObject(pdu), "IN %d", srvGen_getObjectId(srv));
+         ndesLog_tracePDU(NDESLOG_SRV, pdu, ndesLog_in, srvGen_getObjectId(srv));
          srvGen_startService(srv, pdu);
       } else { // Si elle ne l'est plus, inutile d'y revenir pour le moment
          srv->source = NULL; 
@@ -218,7 +226,7 @@ int srvGen_processPDU(void * srv,
 
       // On va chercher une PDU puisqu'il y en a une de prête
       pdu = getPDU(source);
-      ndesLog_logLineF(PDU_getObject(pdu), "IN %d", srvGen_getObjectId(server));
+      ndesLog_tracePDU(NDESLOG_SRV, pdu, ndesLog_in, srvGen_getObjectId(server));
 
       srvGen_startService(server, pdu);
       return 1;
@@ -249,7 +257,7 @@ struct PDU_t * srvGen_getPDU(void * s)
    
    srv->currentPDU = NULL;
 
-   ndesLog_logLineF(PDU_getObject(pdu), "OUT %d", srvGen_getObjectId(srv));
+   ndesLog_tracePDU(NDESLOG_SRV, pdu, ndesLog_out, srvGen_getObjectId(srv));
 
    return pdu;
 }
@@ -275,4 +283,20 @@ void srvGen_setServiceTime(struct srvGen_t * srv,
          motSim_error(MS_FATAL, "Unknown service time strategy");
       break;
    }
+
+   if (srv->fluid) {
+      srvGen_setFluidBackground(srv, srv->fluid);
+   }
+}
+
+/*
+ * Ajout d'un trafic de fond fluide
+ */
+void srvGen_setFluidBackground(struct srvGen_t * srv, struct fluidSource_t * fs)
+{
+   if (srv->serviceTime != serviceTimeProp) {
+      motSim_error(MS_FATAL, "Fluid background needs a serviceTimeProp server");
+   }
+   srv->fluid = fs;
+   fluidSource_setLinkCapacity(fs, 1.0/srv->serviceTimeParameter);
 }
@@ -0,0 +1,97 @@
+/*----------------------------------------------------------------------*/
+/*   Mesure du nombre de BBFRAMEs ordonnancées par seconde par les      */
+/* ordonnanceurs ACM, sur 4 MODCODs x 3 QoS puis sur la table complète */
+/* des 28 MODCODs DVB-S2 x 8 QoS.                                       */
+/*   Ce n'est pas un test : il n'est pas dans la liste TESTS.           */
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>     // printf, ...
+#include <sys/time.h>  // gettimeofday
+
+#include <motsim.h>
+#include <pdu-sink.h>
+#include <file_pdu.h>
+#include <dvb-s2-ll.h>
+#include <schedUtility.h>
+#include <sched_ks.h>
+
+#define NB_BBFRAMES 200
+#define NB_PDU_PAR_FILE 50
+
+/*
+ * Création d'un lien avec 4 MODCODs ou avec la table complète
+ */
+struct DVBS2ll_t * creerLien(int complet)
+{
+   struct DVBS2ll_t * dvbs2ll;
+
+   dvbs2ll = DVBS2ll_create(PDUSink_create(), PDUSink_processPDU, 1000000, FEC_FRAME_BITSIZE_LARGE);
+   if (complet) {
+      DVBS2ll_loadModcods(dvbs2ll, "dvbs2-modcods.txt");
+   } else {
+      DVBS2ll_addModcod(dvbs2ll, C14SIZE, MQPSK);
+      DVBS2ll_addModcod(dvbs2ll, C12SIZE, M8PSK);
+      DVBS2ll_addModcod(dvbs2ll, C34SIZE, M16APSK);
+      DVBS2ll_addModcod(dvbs2ll, C910SIZE, M32APSK);
+   }
+   return dvbs2ll;
+}
+
+/*
+ * Nombre de BBFRAMEs construites par seconde. Les files sont
+ * rechargées entre deux trames, hors mesure.
+ */
+double bench(struct schedACM_t * sched)
+{
+   struct timeval start, end;
+   struct filePDU_t ** files;
+   struct filePDU_t * file;
+   double duree = 0.0;
+   int m, q, n;
+
+   files = (struct filePDU_t **)sim_malloc(schedACM_getNbQoS(sched)*sizeof(struct filePDU_t *));
+   for (m = 0; m < schedACM_getNbModCod(sched); m++) {
+      for (q = 0; q < schedACM_getNbQoS(sched); q++) {
+         files[q] = filePDU_create(NULL, NULL);
+         schedACM_setFileQoSType(sched, m, q, kseQoS_log, 1.0 + q, 0.0);
+      }
+      schedACM_setInputQueues(sched, m, files);
+   }
+
+   for (n = 0; n < NB_BBFRAMES; n++) {
+      for (m = 0; m < schedACM_getNbModCod(sched); m++) {
+         for (q = 0; q < schedACM_getNbQoS(sched); q++) {
+            file = schedACM_getInputQueue(sched, m, q);
+            while (filePDU_length(file) < NB_PDU_PAR_FILE) {
+               filePDU_insert(file, PDU_create(40 + random()%1460, NULL));
+	    }
+         }
+      }
+      schedACM_setPacketsWaiting(sched, 1);
+
+      gettimeofday(&start, NULL);
+      PDU_free(schedACM_getPDU(sched, NULL));
+      gettimeofday(&end, NULL);
+      duree += (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+   }
+
+   return NB_BBFRAMES/duree;
+}
+
+int main() {
+   int complet, nbQoS;
+
+   motSim_create();
+
+   printf("MODCODs x QoS   Utility    UtilityProp  Knapsack (DP)  (BBFRAMEs/s)\n");
+   for (complet = 0; complet <= 1; complet++) {
+      nbQoS = complet?8:3;
+      printf("%4d x %d     %10.0f   %10.0f   %10.0f\n",
+             complet?28:4, nbQoS,
+             bench(schedUtility_create(creerLien(complet), nbQoS, 1)),
+             bench(schedUtilityProp_create(creerLien(complet), nbQoS, 1)),
+             bench(sched_kse_create(creerLien(complet), nbQoS, 0, KS_ALGO_DYNAMIC)));
+   }
+
+   return 0;
+}
@@ -0,0 +1,52 @@
+/*----------------------------------------------------------------------*/
+/*   Mesure du coût d'une date produite par un générateur de dates,    */
+/* selon la taille des lots d'inter-arrivées tirées d'avance.           */
+/*   Ce n'est pas un test : il n'est pas dans la liste TESTS.           */
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>     // printf, ...
+#include <sys/time.h>  // gettimeofday
+
+#include <motsim.h>
+#include <date-generator.h>
+
+#define NBDATES 20000000
+
+/*
+ * Coût moyen (en ns) d'une date
+ */
+double bench(struct dateGenerator_t * dateGen, int batchLength)
+{
+   struct timeval start, end;
+   double d = 0.0;
+   int n;
+
+   dateGenerator_setBatchLength(dateGen, batchLength);
+
+   gettimeofday(&start, NULL);
+   for (n = 0 ; n < NBDATES; n++){
+      d = dateGenerator_nextDate(dateGen, d);
+   }
+   gettimeofday(&end, NULL);
+
+   return ((end.tv_sec - start.tv_sec) * 1e9
+           + (end.tv_usec - start.tv_usec) * 1e3) / NBDATES;
+}
+
+int main() {
+   struct dateGenerator_t * poisson, * periodic;
+   int batchLength;
+
+   motSim_create();
+
+   poisson = dateGenerator_createExp(3.0);
+   periodic = dateGenerator_createPeriodic(0.1);
+
+   printf("lot     Poisson (ns)  Periodique (ns)\n");
+   for (batchLength = 1; batchLength <= DATE_GENERATOR_BATCH_LENGTH; batchLength *= 4) {
+      printf("%4d    %8.2f      %8.2f\n", batchLength,
+             bench(poisson, batchLength), bench(periodic, batchLength));
+   }
+
+   return 0;
+}
@@ -0,0 +1,81 @@
+/*----------------------------------------------------------------------*/
+/*   Mesure du coût d'un ordonnancement par le Deficit Round Robin,     */
+/* selon le nombre de flots actifs (de 10 à 100 000).                   */
+/*   Ce n'est pas un test : il n'est pas dans la liste TESTS.           */
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>     // printf, ...
+#include <sys/time.h>  // gettimeofday
+
+#include <motsim.h>
+#include <sched_drr.h>
+
+#define NB_FLOTS_MAX 100000
+#define NB_PDU_PAR_FLOT 4
+#define NB_PDU 2000000
+#define QUANTUM 1500
+
+/*
+ * Un flot n'est ici qu'une adresse servant de source : la PDU qu'il
+ * fournit le désigne dans ses données
+ */
+int flots[NB_FLOTS_MAX];
+
+struct PDU_t * flot_getPDU(void * flot)
+{
+   return PDU_create(40 + random()%1460, flot);
+}
+
+/*
+ * Une destination toujours occupée : c'est le banc qui tire les PDU
+ */
+int occupee(void * d, getPDU_t getPDU, void * source)
+{
+   return 0;
+}
+
+/*
+ * Coût moyen (en ns) d'une PDU : son ordonnancement et la soumission
+ * d'une nouvelle PDU par le même flot, qui reste donc actif
+ */
+double bench(int nbFlots)
+{
+   struct timeval start, end;
+   struct schedDRR_t * sched;
+   struct PDU_t * pdu;
+   void * flot;
+   int f, n;
+
+   sched = schedDRR_create(NULL, occupee);
+   for (f = 0; f < nbFlots; f++) {
+      schedDRR_addSource(sched, QUANTUM, &flots[f], flot_getPDU);
+      for (n = 0; n < NB_PDU_PAR_FLOT; n++) {
+         schedDRR_processPDU(sched, flot_getPDU, &flots[f]);
+      }
+   }
+
+   gettimeofday(&start, NULL);
+   for (n = 0 ; n < NB_PDU; n++){
+      pdu = schedDRR_getPDU(sched);
+      flot = PDU_private(pdu);
+      PDU_free(pdu);
+      schedDRR_processPDU(sched, flot_getPDU, flot);
+   }
+   gettimeofday(&end, NULL);
+
+   return ((end.tv_sec - start.tv_sec) * 1e9
+           + (end.tv_usec - start.tv_usec) * 1e3) / NB_PDU;
+}
+
+int main() {
+   int nbFlots;
+
+   motSim_create();
+
+   printf("  Flots    ns/PDU\n");
+   for (nbFlots = 10; nbFlots <= NB_FLOTS_MAX; nbFlots *= 10) {
+      printf("%7d  %8.1f\n", nbFlots, bench(nbFlots));
+   }
+
+   return 0;
+}
@@ -0,0 +1,115 @@
+/*----------------------------------------------------------------------*/
+/*   Mesure du coût d'un ordonnancement par les ordonnanceurs           */
+/* équitables (SCFQ, WFQ, WF2Q+), comparé au Deficit Round Robin, selon */
+/* le nombre de flots actifs (de 10 à 100 000).                         */
+/*   Ce n'est pas un test : il n'est pas dans la liste TESTS.           */
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>     // printf, ...
+#include <sys/time.h>  // gettimeofday
+
+#include <motsim.h>
+#include <sched_drr.h>
+#include <sched_fq.h>
+
+#define NB_FLOTS_MAX 100000
+#define NB_PDU_PAR_FLOT 4
+#define NB_PDU 2000000
+#define QUANTUM 1500
+#define THROUGHPUT 1000000000
+
+/*
+ * Un flot n'est ici qu'une adresse servant de source : la PDU qu'il
+ * fournit le désigne dans ses données
+ */
+int flots[NB_FLOTS_MAX];
+
+struct PDU_t * flot_getPDU(void * flot)
+{
+   return PDU_create(40 + random()%1460, flot);
+}
+
+/*
+ * Une destination toujours occupée : c'est le banc qui tire les PDU
+ */
+int occupee(void * d, getPDU_t getPDU, void * source)
+{
+   return 0;
+}
+
+/*
+ * Création d'un ordonnanceur et ajout des flots, les poids variant
+ * de 1 à 4
+ */
+void * creer(int algo, int nbFlots)
+{
+   struct schedDRR_t * drr = NULL;
+   struct schedFQ_t * fq = NULL;
+   int f;
+
+   switch (algo) {
+      case 0 : drr = schedDRR_create(NULL, occupee); break;
+      case 1 : fq = schedSCFQ_create(NULL, occupee); break;
+      case 2 : fq = schedWFQ_create(NULL, occupee, THROUGHPUT); break;
+      default : fq = schedWF2QPlus_create(NULL, occupee); break;
+   }
+   for (f = 0; f < nbFlots; f++) {
+      if (drr) {
+         schedDRR_addSource(drr, QUANTUM*(1 + f%4), &flots[f], flot_getPDU);
+      } else {
+         schedFQ_addSource(fq, 1 + f%4, &flots[f], flot_getPDU);
+      }
+   }
+   return drr?(void *)drr:(void *)fq;
+}
+
+/*
+ * Coût moyen (en ns) d'une PDU : son ordonnancement et la soumission
+ * d'une nouvelle PDU par le même flot, qui reste donc actif. La date
+ * de simulation n'avance pas : pour WFQ, le système fluide n'est
+ * donc jamais vidé.
+ */
+double bench(int algo, int nbFlots)
+{
+   struct timeval start, end;
+   processPDU_t processPDU = algo?schedFQ_processPDU:schedDRR_processPDU;
+   getPDU_t getPDU = algo?schedFQ_getPDU:schedDRR_getPDU;
+   struct PDU_t * pdu;
+   void * sched;
+   void * flot;
+   int f, n;
+
+   sched = creer(algo, nbFlots);
+   for (f = 0; f < nbFlots; f++) {
+      for (n = 0; n < NB_PDU_PAR_FLOT; n++) {
+         processPDU(sched, flot_getPDU, &flots[f]);
+      }
+   }
+
+   gettimeofday(&start, NULL);
+   for (n = 0 ; n < NB_PDU; n++){
+      pdu = getPDU(sched);
+      flot = PDU_private(pdu);
+      PDU_free(pdu);
+      processPDU(sched, flot_getPDU, flot);
+   }
+   gettimeofday(&end, NULL);
+
+   return ((end.tv_sec - start.tv_sec) * 1e9
+           + (end.tv_usec - start.tv_usec) * 1e3) / NB_PDU;
+}
+
+int main() {
+   int nbFlots;
+
+   motSim_create();
+
+   printf("  Flots       DRR      SCFQ       WFQ     WF2Q+  (ns/PDU)\n");
+   for (nbFlots = 10; nbFlots <= NB_FLOTS_MAX; nbFlots *= 10) {
+      printf("%7d  %8.1f  %8.1f  %8.1f  %8.1f\n", nbFlots,
+             bench(0, nbFlots), bench(1, nbFlots),
+             bench(2, nbFlots), bench(3, nbFlots));
+   }
+
+   return 0;
+}
@@ -3,7 +3,8 @@
  *
  * Ce petit programme définit le scénario décrit dans le papier qui
  * défini le Deficit Round Robin. Le résultat est bien le même que
- * celui obtenu "à la main".
+ * celui obtenu "à la main" : les PDU doivent atteindre le puits dans
+ * l'ordre donné par le tableau attendu.
  */
 
 #include <pdu-source.h>
@@ -12,7 +13,21 @@
 #include <srv-gen.h>
 #include <log.h>
 
+/*
+ * Les tailles des PDU dans l'ordre de service du papier (quantum 500),
+ * précédées de celle de la source 0
+ */
+#define NB_PDU 12
+static int attendu[NB_PDU] = {1, 200, 500, 100, 180, 750, 20, 500, 600, 200, 700, 50};
+
 int main() {
+  // Une PDU qui occupe le lien pendant que les autres arrivent, afin
+  // que toutes les files soient pleines au début du premier tour,
+  // comme dans le papier
+  struct dateSize sequence0[] = {
+     {0.0,   1},
+     {0, 0}
+   };
   struct dateSize sequence1[] = {
      {0.0, 200},
      {0.0, 750},
@@ -37,16 +52,21 @@ int main() {
      {0, 0}
    };
 
-   struct PDUSource_t * sourcePDU1, *sourcePDU2, * sourcePDU3, *sourcePDU4;
+   struct PDUSource_t * sourcePDU0, * sourcePDU1, *sourcePDU2, * sourcePDU3, *sourcePDU4;
    struct PDUSink_t   * sink;
    struct srvGen_t    * link;
    struct schedDRR_t  * schedDRR;
+   struct probe_t     * sizes;
+   int n;
+   int result = 0;
 
    // Initialisation du simulateur
    motSim_create();
 
    // Le puits
    sink = PDUSink_create();
+   sizes = probe_createExhaustive();
+   PDUSink_addInputProbe(sink, sizes);
 
    // Le lien
    link = srvGen_create(sink, PDUSink_processPDU);
@@ -55,6 +75,9 @@ int main() {
    schedDRR = schedDRR_create(link, srvGen_processPDU);
 
    // Initialisation des sources
+   sourcePDU0 = PDUSource_createDeterministic(sequence0,
+					      schedDRR,
+					      schedDRR_processPDU);
    sourcePDU1 = PDUSource_createDeterministic(sequence1,
 					      schedDRR,
 					      schedDRR_processPDU);
@@ -67,23 +90,31 @@ int main() {
    sourcePDU4 = PDUSource_createDeterministic(sequence4,
 					      schedDRR,
 					      schedDRR_processPDU);
+   schedDRR_addSource(schedDRR, 500, sourcePDU0, PDUSource_getPDU);
    schedDRR_addSource(schedDRR, 500, sourcePDU1, PDUSource_getPDU);
    schedDRR_addSource(schedDRR, 500, sourcePDU2, PDUSource_getPDU);
    schedDRR_addSource(schedDRR, 500, sourcePDU3, PDUSource_getPDU);
    schedDRR_addSource(schedDRR, 500, sourcePDU4, PDUSource_getPDU);
 
-   // On active les sources pour que l'ordonnanceur les traite dans le
-   // bon ordre (sur le premier round)
+   // Les sources deviennent actives dans l'ordre de démarrage, qui est
+   // donc l'ordre de service du premier tour
+   PDUSource_start(sourcePDU0);
    PDUSource_start(sourcePDU1);
-   PDUSource_start(sourcePDU4);
-   PDUSource_start(sourcePDU3);
    PDUSource_start(sourcePDU2);
+   PDUSource_start(sourcePDU3);
+   PDUSource_start(sourcePDU4);
 
    motSim_runUntilTheEnd();
 
    motSim_printStatus();
-   printf("Fini !\n");
-   ndesLog_dump("fichier");
 
-   return 1;
+   result = (probe_nbSamples(sizes) != NB_PDU);
+   for (n = 0; (n < NB_PDU) && (!result); n++) {
+      if ((int)probe_exhaustiveGetSample(sizes, n) != attendu[n]) {
+         printf("PDU %d de taille %d au lieu de %d\n", n, (int)probe_exhaustiveGetSample(sizes, n), attendu[n]);
+         result = 1;
+      }
+   }
+
+   return result;
 }
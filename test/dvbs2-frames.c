@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : un lien DVB-S2 alimenté par une source qui lui      */
+/* remet plusieurs trames d'avance, chacune avec son MODCOD. Les dates  */
+/* de réception doivent être exactement celles d'une émission trame     */
+/* par trame.                                                           */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <dvb-s2-ll.h>
+
+#define NB_TRAMES 7
+#define NB_AVANCE 3
+
+static int modcods[NB_TRAMES] = {0, 1, 1, 0, 1, 0, 0};
+
+/*
+ * Une source de trames et un récepteur minimalistes
+ */
+struct testTrames_t {
+   struct DVBS2ll_t * dvbs2ll;
+   int    nbRemises;
+   int    nbSollicitations;
+   int    nbRecues;
+   int    tailles[NB_TRAMES];
+   double dates[NB_TRAMES];
+};
+
+void fournirTrames(struct testTrames_t * t)
+{
+   int n;
+
+   t->nbSollicitations++;
+   for (n = 0; (n < NB_AVANCE) && (t->nbRemises < NB_TRAMES); n++) {
+      if (!DVBS2ll_sendFrame(t->dvbs2ll, PDU_create(100 + t->nbRemises, NULL), modcods[t->nbRemises])) {
+         printf("Trame %d refusee\n", t->nbRemises);
+         exit(1);
+      }
+      t->nbRemises++;
+   }
+}
+
+int recevoir(void * r, getPDU_t getPDU, void * source)
+{
+   struct testTrames_t * t = (struct testTrames_t *)r;
+   struct PDU_t * pdu = getPDU(source);
+
+   if (t->nbRecues < NB_TRAMES) {
+      t->tailles[t->nbRecues] = PDU_size(pdu);
+      t->dates[t->nbRecues] = motSim_getCurrentTime();
+   }
+   t->nbRecues++;
+   PDU_free(pdu);
+
+   return 1;
+}
+
+int main() {
+   struct testTrames_t t = {NULL, 0, 0, 0};
+   struct probe_t * dummies;
+   double date = 0.0;
+   int n;
+   int result = 0;
+
+   motSim_create();
+
+   t.dvbs2ll = DVBS2ll_create(&t, recevoir, 1000000, FEC_FRAME_BITSIZE_LARGE);
+   DVBS2ll_addModcod(t.dvbs2ll, C14SIZE, MQPSK);
+   DVBS2ll_addModcod(t.dvbs2ll, C910SIZE, M8PSK);
+   DVBS2ll_setFrameSource(t.dvbs2ll, &t, (DVBS2ll_provideFrames_t)fournirTrames);
+   dummies = probe_createExhaustive();
+   DVBS2ll_addDummyFecFrameProbe(t.dvbs2ll, dummies);
+
+   // Le support est libre, la première trame part tout de suite, les
+   // suivantes attendent
+   fournirTrames(&t);
+   result = result || (DVBS2ll_available(t.dvbs2ll)) || (DVBS2ll_framesQueued(t.dvbs2ll) != NB_AVANCE - 1);
+
+   for (n = 0; n < NB_TRAMES; n++) {
+      date += DVBS2ll_bbframeTransmissionTime(t.dvbs2ll, modcods[n]);
+   }
+   motSim_runUntil(date + DVBS2ll_bbframeTransmissionTime(t.dvbs2ll, DVBS2ll_nbModcod(t.dvbs2ll))/2.0);
+
+   // Toutes les trames, dans l'ordre et à la bonne date
+   result = result || (t.nbRecues != NB_TRAMES);
+   date = 0.0;
+   for (n = 0; (n < NB_TRAMES) && (!result); n++) {
+      date += DVBS2ll_bbframeTransmissionTime(t.dvbs2ll, modcods[n]);
+      if ((t.tailles[n] != 100 + n) || (fabs(t.dates[n] - date) > 1e-12)) {
+         printf("Trame %d : taille %d, date %f au lieu de %f\n", n, t.tailles[n], t.dates[n], date);
+         result = 1;
+      }
+   }
+
+   // La source n'est sollicitée que lorsque le lien n'a plus rien,
+   // puis une DUMMY part faute de trame
+   result = result || (t.nbSollicitations != (NB_TRAMES + NB_AVANCE - 1)/NB_AVANCE + 1);
+   result = result || (probe_nbSamples(dummies) != 1);
+
+   // La réinitialisation vide la file du lien
+   t.nbRemises = 0;
+   fournirTrames(&t);
+   motSim_reset();
+   result = result || (!DVBS2ll_available(t.dvbs2ll)) || (DVBS2ll_framesQueued(t.dvbs2ll) != 0);
+
+   return result;
+}
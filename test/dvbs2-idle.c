@@ -0,0 +1,126 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : le mode inactif d'un lien DVB-S2 doit donner les    */
+/* mêmes dates de réception et le même nombre de DUMMY que l'émission   */
+/* une à une des DUMMY. Deux liens identiques, l'un en mode inactif,    */
+/* reçoivent le même trafic sporadique. Le comptage doit rester juste  */
+/* sur plusieurs exécutions enchaînées.                                 */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+
+#include <motsim.h>
+#include <dvb-s2-ll.h>
+
+#define NB_TRAMES 200
+#define NB_LIENS 2
+
+/*
+ * Un lien, les trames qu'il a à émettre et ce qu'il a reçu
+ */
+struct testLien_t {
+   struct DVBS2ll_t * dvbs2ll;
+   struct probe_t   * dummies;
+   int    nbArrivees;
+   int    nbEmises;
+   int    nbRecues;
+   double dates[NB_TRAMES];
+};
+
+struct testLien_t liens[NB_LIENS];
+int nbArrivees = 0;
+
+void fournirTrame(struct testLien_t * l)
+{
+   if (l->nbEmises < l->nbArrivees) {
+      DVBS2ll_sendFrame(l->dvbs2ll, PDU_create(100, NULL), l->nbEmises%2);
+      l->nbEmises++;
+   }
+}
+
+int recevoir(void * r, getPDU_t getPDU, void * source)
+{
+   struct testLien_t * l = (struct testLien_t *)r;
+
+   PDU_free(getPDU(source));
+   l->dates[l->nbRecues++] = motSim_getCurrentTime();
+
+   return 1;
+}
+
+/*
+ * Arrivée d'une trame, par rafales séparées de longs silences
+ */
+void arrivee(void * nul)
+{
+   int l;
+
+   for (l = 0; l < NB_LIENS; l++) {
+      liens[l].nbArrivees++;
+      if (DVBS2ll_available(liens[l].dvbs2ll)) {
+         fournirTrame(&liens[l]);
+      } else {
+         DVBS2ll_wakeUp(liens[l].dvbs2ll);
+      }
+   }
+   if (++nbArrivees < NB_TRAMES) {
+      motSim_insertNewEvent(arrivee, NULL, motSim_getCurrentTime()
+			    + ((random()%10)?0.001*(random()%50):1.0 + random()%1000*0.001));
+   }
+}
+
+/*
+ * Les deux liens ont-ils émis autant de DUMMY ?
+ */
+int memesDummies()
+{
+   if (probe_nbSamples(liens[0].dummies) != probe_nbSamples(liens[1].dummies)) {
+      printf("t=%f : %lu DUMMY au lieu de %lu\n", motSim_getFinishTime(),
+             probe_nbSamples(liens[1].dummies), probe_nbSamples(liens[0].dummies));
+      return 0;
+   }
+   return 1;
+}
+
+int main() {
+   int l, n;
+   int result = 0;
+   unsigned long nbDummies;
+
+   motSim_create();
+
+   for (l = 0; l < NB_LIENS; l++) {
+      liens[l].nbArrivees = liens[l].nbEmises = liens[l].nbRecues = 0;
+      liens[l].dvbs2ll = DVBS2ll_create(&liens[l], recevoir, 1000000, FEC_FRAME_BITSIZE_LARGE);
+      DVBS2ll_addModcod(liens[l].dvbs2ll, C14SIZE, MQPSK);
+      DVBS2ll_addModcod(liens[l].dvbs2ll, C910SIZE, M8PSK);
+      DVBS2ll_setFrameSource(liens[l].dvbs2ll, &liens[l], (DVBS2ll_provideFrames_t)fournirTrame);
+      liens[l].dummies = probe_createExhaustive();
+      DVBS2ll_addDummyFecFrameProbe(liens[l].dvbs2ll, liens[l].dummies);
+   }
+   DVBS2ll_setIdleMode(liens[1].dvbs2ll, 1);
+
+   motSim_insertNewEvent(arrivee, NULL, 0.0);
+   motSim_runUntil(100.0);
+
+   result = result || (liens[0].nbRecues != NB_TRAMES) || (liens[1].nbRecues != NB_TRAMES);
+   for (n = 0; (n < NB_TRAMES) && (!result); n++) {
+      if (liens[0].dates[n] != liens[1].dates[n]) {
+         printf("Trame %d recue a %f au lieu de %f\n", n, liens[1].dates[n], liens[0].dates[n]);
+         result = 1;
+      }
+   }
+   result = result || !memesDummies();
+
+   // Une seconde exécution, sans aucun trafic : le lien inactif ne
+   // reçoit aucun événement mais doit compter ses DUMMY jusqu'au bout
+   nbDummies = probe_nbSamples(liens[0].dummies);
+   motSim_runUntil(200.0);
+   result = result || !memesDummies();
+   if (probe_nbSamples(liens[0].dummies) <= nbDummies) {
+      printf("Aucune DUMMY pendant la seconde execution\n");
+      result = 1;
+   }
+
+   return result;
+}
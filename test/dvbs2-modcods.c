@@ -0,0 +1,77 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : chargement de la table complète des MODCODs DVB-S2  */
+/* depuis un fichier, puis ordonnancement sur 28 MODCODs et 8 QoS.      */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+
+#include <motsim.h>
+#include <pdu-sink.h>
+#include <file_pdu.h>
+#include <dvb-s2-ll.h>
+#include <schedUtility.h>
+
+#define NB_QOS 8
+
+/*
+ * Un ordonnancement sur des files toutes chargées
+ */
+int ordonnancer(struct schedACM_t * sched)
+{
+   struct filePDU_t ** files;
+   int m, q, n;
+
+   files = (struct filePDU_t **)sim_malloc(NB_QOS*sizeof(struct filePDU_t *));
+   for (m = 0; m < schedACM_getNbModCod(sched); m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         files[q] = filePDU_create(NULL, NULL);
+         for (n = 0; n < 10; n++) {
+            filePDU_insert(files[q], PDU_create(100 + 10*q + n, NULL));
+         }
+         schedACM_setFileQoSType(sched, m, q, kseQoS_lin, 1.0 + q, 0.0);
+      }
+      schedACM_setInputQueues(sched, m, files);
+   }
+   schedACM_schedule(sched);
+
+   printf("modcod %d, volume %d\n", schedACM_getSolution(sched)->modcod,
+          schedACM_getSolution(sched)->volumeTotal);
+
+   return (schedACM_getSolution(sched)->volumeTotal <= 0);
+}
+
+int main() {
+   struct DVBS2ll_t * dvbs2ll;
+   int mc;
+   int result = 0;
+
+   motSim_create();
+
+   dvbs2ll = DVBS2ll_create(PDUSink_create(), PDUSink_processPDU, 1000000, FEC_FRAME_BITSIZE_LARGE);
+   result = result || (DVBS2ll_loadModcods(dvbs2ll, "dvbs2-modcods.txt") != 28);
+   result = result || (DVBS2ll_nbModcod(dvbs2ll) != 28);
+   if (result) {
+      return result;
+   }
+
+   // Le plus robuste et le plus efficace
+   result = result
+      || (DVBS2ll_bbframePayloadBitSize(dvbs2ll, 0) != C14SIZE)
+      || (DVBS2ll_bitsPerSymbol(dvbs2ll, 0) != MQPSK)
+      || (DVBS2ll_bbframePayloadBitSize(dvbs2ll, 27) != C910SIZE)
+      || (DVBS2ll_bitsPerSymbol(dvbs2ll, 27) != M32APSK);
+
+   // Le débit utile croît avec le numéro de MODCOD
+   for (mc = 1; mc < DVBS2ll_nbModcod(dvbs2ll); mc++) {
+      result = result
+	 || (DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc)/DVBS2ll_bbframeTransmissionTime(dvbs2ll, mc)
+             < DVBS2ll_bbframePayloadBitSize(dvbs2ll, mc-1)/DVBS2ll_bbframeTransmissionTime(dvbs2ll, mc-1));
+   }
+
+   // Les ordonnanceurs ne sont plus limités en MODCODs ni en QoS
+   result = result || ordonnancer(schedUtility_create(dvbs2ll, NB_QOS, 1));
+   result = result || ordonnancer(schedUtilityProp_create(dvbs2ll, NB_QOS, 1));
+
+   return result;
+}
@@ -0,0 +1,107 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : trafic de fond fluide.                              */
+/*   Un serveur de capacité 1000 octets/s partage sa capacité avec une  */
+/* source fluide de profil connu. On vérifie les temps de service, le   */
+/* volume de la file fluide et son effet sur une file de PDUs, puis le  */
+/* débit moyen d'une source on/off.                                     */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <pdu-source.h>
+#include <pdu-sink.h>
+#include <srv-gen.h>
+#include <file_pdu.h>
+#include <fluid-source.h>
+
+#define EPSILON 1e-9
+
+struct fluidRate_t profile[] = {
+   {1.0, 500.0},  // La moitié de la capacité
+   {3.0, 1500.0}, // Saturation : 500 octets en attente à 4.0
+   {4.0, 0.0},
+   {0.0, 0.0}
+};
+
+struct dateSize sequence[] = {
+   {0.5, 1000},
+   {2.5, 1000},
+   {0.0, 0}
+};
+
+struct fluidSource_t * fluid;
+struct filePDU_t * file;
+int result = 0;
+
+/*
+ * Vérification de l'effet de la file fluide sur une file de PDUs
+ */
+void checkFile(void * data)
+{
+   printf("A %f, file fluide %f\n", motSim_getCurrentTime(), fluidSource_getBacklog(fluid));
+   result = result || (fabs(fluidSource_getBacklog(fluid) - 500.0) > EPSILON);
+
+   filePDU_insert(file, PDU_create(600, NULL)); // Ne tient pas
+   filePDU_insert(file, PDU_create(400, NULL)); // Tient
+   result = result || (filePDU_length(file) != 1);
+}
+
+/*
+ * Une date de fin pour les simulations sans événement
+ */
+void nothing(void * data)
+{
+}
+
+int main() {
+   struct PDUSource_t * source;
+   struct srvGen_t    * server;
+   struct PDUSink_t   * sink;
+   struct probe_t     * serviceProbe;
+   struct fluidSource_t * onOff;
+
+   motSim_create();
+
+   fluid = fluidSource_createProfile(profile);
+
+   sink = PDUSink_create();
+   server = srvGen_create(sink, PDUSink_processPDU);
+   srvGen_setServiceTime(server, serviceTimeProp, 0.001);
+   srvGen_setFluidBackground(server, fluid);
+   serviceProbe = probe_createExhaustive();
+   srvGen_addServiceProbe(server, serviceProbe);
+
+   source = PDUSource_createDeterministic(sequence, server, srvGen_processPDU);
+
+   file = filePDU_create(NULL, NULL);
+   filePDU_setMaxSize(file, 1000);
+   filePDU_setFluidBackground(file, fluid);
+   motSim_insertNewEvent(checkFile, NULL, 4.0);
+
+   PDUSource_start(source);
+   motSim_runUntilTheEnd();
+
+   printf("Services : %f %f, volume fluide %f\n",
+          probe_exhaustiveGetSampleN(serviceProbe, 0),
+          probe_exhaustiveGetSampleN(serviceProbe, 1),
+          fluidSource_getVolume(fluid));
+   result = result
+      || (probe_nbSamples(serviceProbe) != 2)
+      || (fabs(probe_exhaustiveGetSampleN(serviceProbe, 0) - 1.5) > EPSILON)
+      || (fabs(probe_exhaustiveGetSampleN(serviceProbe, 1) - 2.75) > EPSILON)
+      || (fabs(fluidSource_getVolume(fluid) - 2500.0) > EPSILON);
+
+   // Une source on/off de débit moyen 50
+   onOff = fluidSource_createOnOff(100.0, dateGenerator_createExp(1.0),
+                                   dateGenerator_createExp(1.0));
+   motSim_insertNewEvent(nothing, NULL, 10000.0);
+   motSim_runUntilTheEnd();
+   printf("Debit moyen on/off %f\n", fluidSource_getVolume(onOff)/motSim_getCurrentTime());
+   result = result
+      || (fabs(fluidSource_getVolume(onOff)/motSim_getCurrentTime() - 50.0) > 2.5);
+
+   return result;
+}
@@ -0,0 +1,125 @@
+/*
+ * Test du rejeu des générateurs depuis un fichier
+ */
+#include <motsim.h>
+#include <random-generator.h>
+
+#include <stdio.h>     // printf, ...
+#include <stdlib.h>    // exit
+#include <unistd.h>    // unlink, fork
+#include <sys/stat.h>  // stat
+#include <sys/wait.h>  // waitpid
+
+#define NBECH 100000
+#define TRACE_FILE "generators-6.trace"
+
+// Moins qu'un bloc de trace, et pas un multiple de sa taille
+#define NBECH_COURT 1000
+#define TRACE_FILE_2 "generators-6-2.trace"
+
+/*----------------------------------------------------------------------*/
+/*                                                                      */
+/*----------------------------------------------------------------------*/
+int main() {
+   struct randomGenerator_t * rg, * rg2;
+   struct probe_t           * pr2, *pr3; 
+   int n;
+   double v ;
+   double valeurs[NBECH_COURT];
+   struct stat st;
+   pid_t pid;
+   int status;
+
+   motSim_create(); // Les sondes datent les échantillons
+
+   pr2 = probe_createExhaustive();
+   probe_setPersistent(pr2);  // On va utiliser un motSim_reset
+   pr3 = probe_createExhaustive();
+   probe_setPersistent(pr3);
+
+   // On crée un générateur de réels (loi exp par défaut)
+   rg = randomGenerator_createDoubleExp(1.0);
+
+   // On demande d'enregistrer dans un fichier
+   randomGenerator_recordThenReplayToFile(rg, TRACE_FILE);
+
+   // Un premier tour
+   for (n = 0 ; n < NBECH;n++){
+      probe_sample(pr2, randomGenerator_getNextDouble(rg));
+   }
+
+   // Le deuxième tour sera un rejeu 
+   motSim_reset();
+
+   for (n = 0 ; n < NBECH;n++){
+      probe_sample(pr3, randomGenerator_getNextDouble(rg));
+   }
+
+   // Comparaison des résultats
+   for (n = 0 ; n < NBECH;n++){
+     if (probe_exhaustiveGetSampleN(pr2, n) != probe_exhaustiveGetSampleN(pr3, n)) {
+       printf("ERREUR sur %d : %f != %f\n", n, probe_exhaustiveGetSampleN(pr2, n),probe_exhaustiveGetSampleN(pr3, n));
+       exit(1);
+     }
+   }
+
+   // Un autre générateur rejoue le même fichier
+   rg2 = randomGenerator_createDoubleExp(1.0);
+   randomGenerator_replayFromFile(rg2, TRACE_FILE);
+   for (n = 0 ; n < NBECH;n++){
+      v = randomGenerator_getNextDouble(rg2);
+      if (v != probe_exhaustiveGetSampleN(pr2, n)) {
+         printf("ERREUR de rejeu sur %d : %f != %f\n", n, v, probe_exhaustiveGetSampleN(pr2, n));
+         exit(1);
+      }
+   }
+
+   probe_delete(pr2);
+   probe_delete(pr3);
+   randomGenerator_delete(rg);
+   randomGenerator_delete(rg2);
+   unlink(TRACE_FILE);
+
+   // Un enregistrement sans reset, complété par la destruction du
+   // générateur, puis rejoué par un nouveau générateur
+   rg = randomGenerator_createDoubleExp(1.0);
+   randomGenerator_recordThenReplayToFile(rg, TRACE_FILE_2);
+   for (n = 0 ; n < NBECH_COURT;n++){
+      valeurs[n] = randomGenerator_getNextDouble(rg);
+   }
+   randomGenerator_delete(rg);
+
+   rg2 = randomGenerator_createDoubleExp(1.0);
+   randomGenerator_replayFromFile(rg2, TRACE_FILE_2);
+   for (n = 0 ; n < NBECH_COURT;n++){
+      v = randomGenerator_getNextDouble(rg2);
+      if (v != valeurs[n]) {
+         printf("ERREUR de rejeu apres destruction sur %d : %f != %f\n", n, v, valeurs[n]);
+         exit(1);
+      }
+   }
+   randomGenerator_delete(rg2);
+   unlink(TRACE_FILE_2);
+
+   // Un processus qui enregistre puis se termine, sans reset ni
+   // destruction : la trace doit tout de même être complète
+   fflush(stdout);
+   pid = fork();
+   if (pid == 0) {
+      rg = randomGenerator_createDoubleExp(1.0);
+      randomGenerator_recordThenReplayToFile(rg, TRACE_FILE_2);
+      for (n = 0 ; n < NBECH_COURT;n++){
+         randomGenerator_getNextDouble(rg);
+      }
+      exit(0);
+   }
+   waitpid(pid, &status, 0);
+   if ((stat(TRACE_FILE_2, &st)) || (st.st_size != NBECH_COURT*sizeof(double))) {
+      printf("ERREUR : trace incomplete a la fin du processus\n");
+      exit(1);
+   }
+   unlink(TRACE_FILE_2);
+
+   printf("[OK]\n");
+   return 0;
+}
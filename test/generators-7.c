@@ -0,0 +1,71 @@
+/*
+ * Test du rejeu des générateurs de dates : après un motSim_reset, un
+ * générateur qui enregistre doit redonner exactement les mêmes dates,
+ * en mémoire comme dans un fichier.
+ */
+#include <motsim.h>
+#include <date-generator.h>
+
+#include <stdio.h>     // printf, ...
+#include <unistd.h>    // unlink
+
+#define NBDATES 100
+#define TRACE_FILE "generators-7.trace"
+
+/*
+ * Un tour de NBDATES dates, rangées dans dates
+ */
+void tirer(struct dateGenerator_t * dg, double * dates)
+{
+   double t = 0.0;
+   int n;
+
+   for (n = 0; n < NBDATES; n++) {
+      t = dateGenerator_nextDate(dg, t);
+      dates[n] = t;
+   }
+}
+
+/*
+ * Enregistrement, réinitialisation puis rejeu. Retourne 0 si les deux
+ * tours donnent les mêmes dates
+ */
+int rejouer(struct dateGenerator_t * dg, char * nom)
+{
+   double enregistrees[NBDATES], rejouees[NBDATES];
+   int n;
+
+   tirer(dg, enregistrees);
+   motSim_reset();
+   tirer(dg, rejouees);
+
+   for (n = 0; n < NBDATES; n++) {
+      if (enregistrees[n] != rejouees[n]) {
+         printf("%s : date %d rejouee %f au lieu de %f\n", nom, n, rejouees[n], enregistrees[n]);
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*----------------------------------------------------------------------*/
+/*                                                                      */
+/*----------------------------------------------------------------------*/
+int main() {
+   struct dateGenerator_t * dg;
+   int result = 0;
+
+   motSim_create();
+
+   dg = dateGenerator_createExp(1.0);
+   dateGenerator_recordThenReplay(dg);
+   result = rejouer(dg, "memoire") || result;
+
+   dg = dateGenerator_createExp(1.0);
+   dateGenerator_recordThenReplayToFile(dg, TRACE_FILE);
+   result = rejouer(dg, "fichier") || result;
+
+   unlink(TRACE_FILE);
+
+   return result;
+}
@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : un lien à long délai de propagation a en vol des    */
+/* centaines de PDU. Chacune doit être reçue exactement à la fin de son */
+/* émission plus la propagation, et le lien doit de nouveau             */
+/* fonctionner après une réinitialisation.                              */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <file_pdu.h>
+#include <ll-simplex.h>
+
+#define THROUGHPUT  10000000  // Une PDU de 1000 octets en 0,8 ms
+#define TAILLE      1000
+#define PROPAGATION 0.250
+#define PERIODE     0.001
+#define NB_PDU      400
+
+struct filePDU_t * file;
+int nbArrivees = 0;
+int nbRecues = 0;
+double dates[NB_PDU + 1];
+
+int recevoir(void * r, getPDU_t getPDU, void * source)
+{
+   struct PDU_t * pdu = getPDU(source);
+
+   if (nbRecues <= NB_PDU) {
+      dates[nbRecues] = motSim_getCurrentTime();
+   }
+   nbRecues++;
+   PDU_free(pdu);
+
+   return 1;
+}
+
+/*
+ * Une arrivée par période, 250 PDU sont donc en vol en même temps
+ */
+void arrivee(void * nul)
+{
+   filePDU_insert(file, PDU_create(TAILLE, NULL));
+   if (++nbArrivees < NB_PDU) {
+      motSim_insertNewEvent(arrivee, NULL, motSim_getCurrentTime() + PERIODE);
+   }
+}
+
+int main() {
+   struct llSimplex_t * lien;
+   double tx = TAILLE*8.0/THROUGHPUT;
+   int n;
+   int result = 0;
+
+   motSim_create();
+
+   lien = llSimplex_create(NULL, recevoir, THROUGHPUT, PROPAGATION);
+   file = filePDU_create(lien, llSimplex_processPDU);
+
+   motSim_insertNewEvent(arrivee, NULL, 0.0);
+
+   motSim_runUntil(1.0);
+   result = result || (nbRecues != NB_PDU);
+   for (n = 0; (n < NB_PDU) && (!result); n++) {
+      if (fabs(dates[n] - (n*PERIODE + tx + PROPAGATION)) > 1e-9) {
+         printf("PDU %d recue a %f au lieu de %f\n", n, dates[n], n*PERIODE + tx + PROPAGATION);
+         result = 1;
+      }
+   }
+
+   // Réinitialisation avec des PDU en vol, puis une nouvelle PDU
+   nbArrivees = nbRecues = 0;
+   motSim_insertNewEvent(arrivee, NULL, motSim_getCurrentTime());
+   motSim_runUntil(motSim_getCurrentTime() + PROPAGATION/2.0);
+   motSim_reset();
+   nbRecues = 0;
+   filePDU_insert(file, PDU_create(TAILLE, NULL));
+   motSim_runUntil(1.0);
+   if ((nbRecues != 1) || (fabs(dates[0] - (tx + PROPAGATION)) > 1e-9)) {
+      printf("Apres reinitialisation : %d PDU recues\n", nbRecues);
+      result = 1;
+   }
+
+   return result;
+}
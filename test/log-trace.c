@@ -0,0 +1,129 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : sélection à l'exécution des événements tracés       */
+/* (catégories, échantillonnage et filtrage des PDU). Les entités      */
+/* sollicitées à vide ne doivent rien tracer.                           */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, remove, ...
+
+#include <motsim.h>
+#include <log.h>
+#include <file_pdu.h>
+#include <sched_rr.h>
+#include <srv-gen.h>
+#include <pdu-filter.h>
+
+#define NB_PDU 100
+#define ECHANTILLONNAGE 3
+
+#define FICHIER_TRACE "log-trace.bin"
+#define FICHIER_TEXTE "log-trace.txt"
+
+/*
+ * On ne garde que les PDU d'identifiant pair
+ */
+int paire(void * nul, struct PDU_t * pdu)
+{
+   return (PDU_id(pdu) % 2) == 0;
+}
+
+/*
+ * Passage de NB_PDU PDU dans une file. On renvoie le nombre de PDU
+ * dont l'identifiant est multiple de m et (si pair) pair.
+ */
+int traverser(struct filePDU_t * file, int m, int pair)
+{
+   struct PDU_t * pdu;
+   int n, result = 0;
+
+   for (n = 0; n < NB_PDU; n++) {
+      pdu = PDU_create(1, NULL);
+      if (((PDU_id(pdu) % m) == 0) && ((!pair) || (PDU_id(pdu) % 2 == 0))) {
+         result++;
+      }
+      filePDU_insert(file, pdu);
+      PDU_free(filePDU_extract(file));
+   }
+
+   return result;
+}
+
+/*
+ * Une destination toujours occupée
+ */
+int occupee(void * d, getPDU_t getPDU, void * source)
+{
+   return 0;
+}
+
+int main() {
+   struct filePDU_t   * file;
+   struct filePDU_t   * entrees[2];
+   struct rrSched_t   * sched;
+   struct srvGen_t    * srv;
+   int n;
+   struct PDUFilter_t * filtre;
+   struct PDU_t       * pdu;
+   int attendus = 0, obtenus;
+   int result = 0;
+
+   motSim_create();
+
+   ndesLog_setFile(FICHIER_TRACE);
+   ndesLog_disable();
+
+   file = filePDU_create(NULL, NULL);
+   filtre = PDUFilter_create();
+   PDUFilter_setTestFunction(filtre, paire);
+   pdu = PDU_create(1, NULL);
+
+   // Rien n'est tracé
+   traverser(file, 1, 0);
+
+   // Les files, une PDU sur ECHANTILLONNAGE (une entrée et une sortie
+   // par PDU). La création des PDU n'est pas tracée.
+   ndesLog_setCategories(NDESLOG_FILE);
+   ndesLog_setSampling(ECHANTILLONNAGE);
+   attendus += 2*traverser(file, ECHANTILLONNAGE, 0);
+   ndesLog_logLine(PDU_getObject(pdu), "Pas trace");
+
+   // Seulement les PDU paires
+   ndesLog_setSampling(1);
+   ndesLog_setPDUFilter(filtre);
+   attendus += 2*traverser(file, 1, 1);
+
+   // Les deux à la fois, et les lignes de texte
+   ndesLog_setSampling(ECHANTILLONNAGE);
+   ndesLog_setCategories(NDESLOG_FILE | NDESLOG_TEXT);
+   ndesLog_logLineF(PDU_getObject(pdu), "Trace %d", 1);
+   attendus += 1 + 2*traverser(file, ECHANTILLONNAGE, 1);
+
+   // Un ordonnanceur qui interroge des files vides, un serveur sans
+   // PDU : seuls l'entrée et la sortie de l'unique PDU sont tracées
+   ndesLog_setSampling(1);
+   ndesLog_setPDUFilter(NULL);
+   ndesLog_setCategories(NDESLOG_ALL & ~NDESLOG_OBJECT);
+   sched = rrSched_create(NULL, occupee);
+   for (n = 0; n < 2; n++) {
+      entrees[n] = filePDU_create(sched, rrSched_processPDU);
+      rrSched_addSource(sched, entrees[n], filePDU_getPDU);
+   }
+   filePDU_insert(entrees[0], PDU_create(1, NULL));
+   PDU_free(rrSched_getPDU(sched));
+   result = result || (rrSched_getPDU(sched) != NULL);
+   result = result || (filePDU_extract(file) != NULL);
+   srv = srvGen_create(NULL, NULL);
+   result = result || (srvGen_getPDU(srv) != NULL);
+   attendus += 2;
+
+   obtenus = ndesLog_dump(FICHIER_TEXTE);
+   if (obtenus != attendus) {
+      printf("%d evenements au lieu de %d\n", obtenus, attendus);
+      result = 1;
+   }
+   remove(FICHIER_TRACE);
+   remove(FICHIER_TEXTE);
+
+   return result;
+}
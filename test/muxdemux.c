@@ -12,6 +12,7 @@
 
 #define NB_CHANNELS 5
 #define NB_PDU 7
+#define NB_SAPS 500 // For the SAPI allocation test
 
 struct dateSize sequence[NB_CHANNELS][NB_PDU+1] = {
    {
@@ -130,5 +131,18 @@ int main()
       }
    }
 
+   // SAPI allocation : the lowest available one, unless specified
+   sm = muxDemuxSender_create(NULL, NULL);
+   rd = muxDemuxReceiver_create();
+   result = result || (!muxDemuxSender_createNewSAP(sm, 3)) || (!muxDemuxReceiver_createNewSAP(rd, 3, NULL, NULL));
+   for (n = 0; n < 3 + NB_SAPS; n++) {
+      result = result || (!muxDemuxSender_createNewSAP(sm, 0)) || (!muxDemuxReceiver_createNewSAP(rd, 0, NULL, NULL));
+   }
+   // SAPIs 1 to NB_SAPS + 4 are now in use
+   for (n = 1; n <= NB_SAPS + 4; n++) {
+      result = result || (muxDemuxSender_createNewSAP(sm, n)) || (muxDemuxReceiver_createNewSAP(rd, n, NULL, NULL));
+   }
+   result = result || (!muxDemuxSender_createNewSAP(sm, NB_SAPS + 5)) || (!muxDemuxReceiver_createNewSAP(rd, NB_SAPS + 5, NULL, NULL));
+
    return result;
 }
@@ -0,0 +1,68 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : stock d'instances des ndesObject. Les instances     */
+/* libérées doivent resservir et l'occupation du stock être juste.      */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+
+#include <motsim.h>
+#include <ndesObject.h>
+#include <pdu.h>
+
+#define NB_OBJETS 10
+
+/*
+ * Un type d'objet minimaliste
+ */
+struct exemple_t {
+   declareAsNdesObject;
+   int valeur;
+};
+
+defineObjectFunctions(exemple);
+
+struct ndesObjectType_t exempleType = {
+   ndesObjectTypeDefaultValues(exemple)
+};
+
+int main() {
+   struct exemple_t * objets[NB_OBJETS];
+   struct exemple_t * o;
+   struct PDU_t * pdu, * autre;
+   int n;
+   int result = 0;
+
+   motSim_create();
+
+   for (n = 0; n < NB_OBJETS; n++) {
+      objets[n] = (struct exemple_t *)ndesObject_createObject(&exempleType);
+      result = result || (objets[n]->valeur != 0) || (exemple_getObject(objets[n]) == NULL);
+      objets[n]->valeur = n + 1;
+   }
+   result = result || (exempleType.nbInUse != NB_OBJETS) || (exempleType.nbMalloc != NB_OBJETS);
+
+   // Les instances libérées sont réutilisées, réinitialisées
+   ndesObject_freeObject(objets[3]);
+   ndesObject_freeObject(objets[7]);
+   result = result || (exempleType.nbInUse != NB_OBJETS - 2) || (exempleType.nbFree != 2);
+
+   o = (struct exemple_t *)ndesObject_createObject(&exempleType);
+   result = result || (o != objets[7]) || (o->valeur != 0);
+   o = (struct exemple_t *)ndesObject_createObject(&exempleType);
+   result = result || (o != objets[3]) || (o->valeur != 0);
+   result = result || (exempleType.nbFree != 0) || (exempleType.nbMalloc != NB_OBJETS);
+
+   // Les PDU passent par le même mécanisme, leur ndesObject n'est créé
+   // qu'à la demande
+   pdu = PDU_create(100, NULL);
+   result = result || (PDU_getObject(pdu) == NULL) || (PDU_getObjectId(pdu) != ndesObject_getId(PDU_getObject(pdu)));
+   PDU_free(pdu);
+   autre = PDU_create(200, NULL);
+   result = result || (autre != pdu) || (PDU_size(autre) != 200);
+
+   if (result) {
+      ndesObjectType_printStats(&exempleType);
+   }
+   return result;
+}
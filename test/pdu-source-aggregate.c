@@ -0,0 +1,75 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : agrégat de sources.                                 */
+/*   NBFLOWS flots poissonniens partagent un même générateur de dates.  */
+/* On vérifie le débit global, la cohérence des statistiques par flot   */
+/* et la croissance des dates de production.                            */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <pdu-source-aggregate.h>
+
+#define NBFLOWS  10000
+#define LAMBDA   0.1
+#define DURATION 100.0
+
+unsigned long nbReceived = 0;
+motSimDate_t lastDate = 0.0;
+int result = 0;
+
+/*
+ * Une destination qui vérifie l'ordre des dates
+ */
+int checkProcessPDU(void * r, getPDU_t getPDU, void * source)
+{
+   struct PDU_t * pdu;
+
+   if ((getPDU == NULL) || (source == NULL)) { 
+      return 1;
+   }
+   pdu = getPDU(source);
+   if (motSim_getCurrentTime() < lastDate) {
+      printf("ERREUR : %f < %f\n", motSim_getCurrentTime(), lastDate);
+      result = 1;
+   }
+   lastDate = motSim_getCurrentTime();
+   nbReceived++;
+   PDU_free(pdu);
+
+   return 1;
+}
+
+int main() {
+   struct PDUSourceAggregate_t * agg;
+   unsigned long total = 0;
+   double expected = NBFLOWS * LAMBDA * DURATION;
+   int f;
+
+   motSim_create();
+
+   agg = PDUSourceAggregate_create(NBFLOWS, dateGenerator_createExp(LAMBDA),
+                                   &nbReceived, checkProcessPDU);
+   PDUSourceAggregate_setPDUSizeGenerator(agg, randomGenerator_createUIntConstant(100));
+   PDUSourceAggregate_start(agg);
+
+   motSim_runUntil(DURATION);
+
+   for (f = 0; f < NBFLOWS; f++) {
+      total += PDUSourceAggregate_getFlowNbPDU(agg, f);
+      if (PDUSourceAggregate_getFlowVolume(agg, f)
+          != 100 * PDUSourceAggregate_getFlowNbPDU(agg, f)) {
+         printf("ERREUR de volume sur le flot %d\n", f);
+         result = 1;
+      }
+   }
+   printf("%lu PDU produites, %lu reçues (attendu %f)\n", total, nbReceived, expected);
+
+   result = result
+      || (nbReceived != total)
+      || (fabs(total - expected) > 0.03 * expected);
+
+   return result;
+}
@@ -0,0 +1,85 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : rejeu d'une trace par une PDUSource.                */
+/*   Une trace binaire de deux flots est répartie sur deux puits, puis  */
+/* une trace texte est rejouée en boucle.                               */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <unistd.h>    // unlink
+
+#include <motsim.h>
+#include <pdu-source.h>
+#include <pdu-sink.h>
+
+#define NBREC 10000
+#define BIN_FILE "pdu-trace.bin"
+#define TXT_FILE "pdu-trace.txt"
+
+int main() {
+   struct PDUSource_t * source;
+   struct PDUSink_t   * sink[3];
+   struct probe_t     * sizeProbe[3];
+   struct PDUTraceRecord_t record;
+   FILE * f;
+   int n;
+   int result = 0;
+
+   motSim_create();
+
+   // Construction d'une trace binaire de deux flots
+   f = fopen(BIN_FILE, "wb");
+   for (n = 0; n < NBREC; n++) {
+      record.date = 10.0 + n * 0.01;
+      record.size = 1 + n % 100;
+      record.flowId = n % 2;
+      fwrite(&record, sizeof(record), 1, f);
+   }
+   fclose(f);
+
+   for (n = 0; n < 3; n++) {
+      sink[n] = PDUSink_create();
+      sizeProbe[n] = probe_createExhaustive();
+      PDUSink_addInputProbe(sink[n], sizeProbe[n]);
+   }
+
+   source = PDUSource_createFromTrace(BIN_FILE, PDUSourceTraceBinary,
+                                      sink[0], PDUSink_processPDU);
+   PDUSource_setTraceFlowDestination(source, 1, sink[1], PDUSink_processPDU);
+   PDUSource_start(source);
+
+   motSim_runUntilTheEnd();
+
+   printf("%ld + %ld PDU recues a %f\n", probe_nbSamples(sizeProbe[0]),
+          probe_nbSamples(sizeProbe[1]), motSim_getCurrentTime());
+   result = result
+      || (probe_nbSamples(sizeProbe[0]) != NBREC/2)
+      || (probe_nbSamples(sizeProbe[1]) != NBREC/2)
+      || (motSim_getCurrentTime() > (NBREC - 1) * 0.01 + 1e-6);
+
+   // Une trace texte rejouée en boucle (la première source est
+   // relancée par le reset, elle alimente toujours les deux premiers
+   // puits)
+   f = fopen(TXT_FILE, "w");
+   fprintf(f, "# date, taille\n0.1, 100\n0.2, 200\n0.3, 300\n");
+   fclose(f);
+
+   motSim_reset();
+   source = PDUSource_createFromTrace(TXT_FILE, PDUSourceTraceText,
+                                      sink[2], PDUSink_processPDU);
+   PDUSource_setTraceLoop(source, 1.0);
+   PDUSource_setTraceTimeShift(source, 0.5);
+   PDUSource_start(source);
+   motSim_runUntil(10.0);
+
+   printf("%ld PDU recues (moyenne %f)\n", probe_nbSamples(sizeProbe[2]),
+          probe_mean(sizeProbe[2]));
+   result = result
+      || (probe_nbSamples(sizeProbe[2]) != 30)
+      || (probe_mean(sizeProbe[2]) != 200.0);
+
+   unlink(BIN_FILE);
+   unlink(TXT_FILE);
+
+   return result;
+}
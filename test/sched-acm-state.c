@@ -0,0 +1,142 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : l'état des files d'entrée d'un ordonnanceur ACM,    */
+/* maintenu incrémentalement, doit rester conforme au contenu des       */
+/* files au fil des insertions, extractions et pertes.                  */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <pdu-sink.h>
+#include <file_pdu.h>
+#include <dvb-s2-ll.h>
+#include <schedUtility.h>
+
+#define NB_QOS 2
+#define NB_OPERATIONS 20000
+
+/*
+ * Comparaison de l'état de l'ordonnanceur avec un parcours de la file
+ */
+int verifier(struct schedACM_t * sched, int m, int q)
+{
+   struct filePDU_t * file = schedACM_getInputQueue(sched, m, q);
+   int n, cumul = 0;
+   int c[8];
+
+   for (n = 1; n <= filePDU_length(file); n++) {
+      cumul += filePDU_size_PDU_n(file, n);
+      if ((schedACM_getPDUSize(sched, m, q, n) != filePDU_size_PDU_n(file, n))
+	  || (schedACM_getCumulatedSize(sched, m, q, n) != cumul)) {
+         printf("Erreur sur (%d, %d) paquet %d\n", m, q, n);
+         return 1;
+      }
+   }
+   if ((schedACM_cumulatedSizes(sched, m, q, 1500, 7, c)
+	!= filePDU_cumulatedSizes(file, 1500, 7, c))) {
+      printf("Erreur de cumuls sur (%d, %d)\n", m, q);
+      return 1;
+   }
+   return 0;
+}
+
+int main() {
+   struct DVBS2ll_t * dvbs2ll;
+   struct schedACM_t * sched;
+   struct filePDU_t * files[NB_QOS];
+   int m, q, i, j, n, sz;
+   struct PDU_t * pdus[4];
+   int result = 0;
+   double d, g;
+
+   motSim_create();
+
+   dvbs2ll = DVBS2ll_create(PDUSink_create(), PDUSink_processPDU, 1000000, FEC_FRAME_BITSIZE_LARGE);
+   DVBS2ll_addModcod(dvbs2ll, C14SIZE, MQPSK);
+   DVBS2ll_addModcod(dvbs2ll, C910SIZE, M8PSK);
+
+   sched = schedUtility_create(dvbs2ll, NB_QOS, 1);
+
+   for (m = 0; m < DVBS2ll_nbModcod(dvbs2ll); m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         files[q] = filePDU_create(NULL, NULL);
+         // Des paquets déjà présents avant l'attribution
+         filePDU_insert(files[q], PDU_create(100 + q, NULL));
+         schedACM_setFileQoSType(sched, m, q, kseQoS_log, 1.0, 0.0);
+      }
+      // Une file bornée en tête, pour les pertes
+      filePDU_setMaxLength(files[NB_QOS-1], 40);
+      filePDU_setDropStrategy(files[NB_QOS-1], filePDU_dropHead);
+      schedACM_setInputQueues(sched, m, files);
+   }
+
+   // Des insertions et extractions aléatoires, assez pour que les
+   // tableaux de cumuls s'agrandissent et bouclent
+   for (i = 0; (i < NB_OPERATIONS) && (!result); i++) {
+      m = random()%DVBS2ll_nbModcod(dvbs2ll);
+      q = random()%NB_QOS;
+      if (random()%5 < 3) {
+         filePDU_insert(schedACM_getInputQueue(sched, m, q), PDU_create(1 + random()%1500, NULL));
+      } else if (random()%2) {
+         PDU_free(filePDU_extract(schedACM_getInputQueue(sched, m, q)));
+      } else {
+         // Extraction groupée, éventuellement plus que la file n'en a
+         n = 1 + random()%4;
+         if (filePDU_length(schedACM_getInputQueue(sched, m, q)) >= n) {
+            sz = filePDU_size_n_PDU(schedACM_getInputQueue(sched, m, q), n);
+         } else {
+            sz = filePDU_size(schedACM_getInputQueue(sched, m, q));
+         }
+         n = filePDU_extractN(schedACM_getInputQueue(sched, m, q), n, pdus);
+         for (j = 0; j < n; j++) {
+            sz -= PDU_size(pdus[j]);
+            PDU_free(pdus[j]);
+         }
+         result = result || (sz != 0);
+      }
+      if (i%100 == 0) {
+         for (m = 0; m < DVBS2ll_nbModcod(dvbs2ll); m++) {
+            for (q = 0; q < NB_QOS; q++) {
+               result = result || verifier(sched, m, q);
+            }
+         }
+      }
+   }
+
+   // La dérivée et les gains mis en cache suivent le débit
+   schedACM_schedule(sched);
+   d = schedACM_getDerivee(sched, 0, 0);
+   result = result || (d != utiliteDerivee(schedACM_getQoS(sched, 0, 0),
+					    schedACM_getQoS(sched, 0, 0)->debit,
+					    dvbs2ll));
+   g = schedACM_gainUtilite(sched, 0, 0, 1000, 1);
+   result = result || (fabs(g - d*1000/DVBS2ll_bbframeTransmissionTime(dvbs2ll, 1)) > 1e-12*g);
+   schedACM_setPacketsWaiting(sched, 1);
+   PDU_free(schedACM_getPDU(sched, NULL));
+   schedACM_schedule(sched);
+   result = result || (schedACM_getDerivee(sched, 0, 0)
+		       != utiliteDerivee(schedACM_getQoS(sched, 0, 0),
+					 schedACM_getQoS(sched, 0, 0)->debit,
+					 dvbs2ll));
+
+   // Une modification de MODCOD après la création de l'ordonnanceur
+   // doit être prise en compte dès l'ordonnancement suivant
+   DVBS2ll_setModcod(dvbs2ll, 1, C910SIZE, M16APSK);
+   schedACM_schedule(sched);
+   d = schedACM_getDerivee(sched, 0, 0);
+   g = schedACM_gainUtilite(sched, 0, 0, 1000, 1);
+   result = result || (fabs(g - d*1000/DVBS2ll_bbframeTransmissionTime(dvbs2ll, 1)) > 1e-12*g);
+
+   // La réinitialisation vide les files, l'état doit suivre
+   motSim_reset();
+   for (m = 0; m < DVBS2ll_nbModcod(dvbs2ll); m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         result = result || (schedACM_getCumulatedSize(sched, m, q, 0) != 0)
+	    || verifier(sched, m, q);
+      }
+   }
+
+   return result;
+}
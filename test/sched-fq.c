@@ -0,0 +1,171 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : les ordonnanceurs équitables à temps virtuel.       */
+/*   Des sources toujours actives doivent se partager le lien selon     */
+/* leurs poids, avec WFQ, WF2Q+ et SCFQ. Sur l'exemple de Bennett et    */
+/* Zhang, WFQ sert d'une traite la rafale de la source lourde alors     */
+/* que WF2Q+ l'entrelace avec les autres.                               */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <string.h>    // memset
+
+#include <motsim.h>
+#include <srv-gen.h>
+#include <sched_fq.h>
+
+#define THROUGHPUT 1000000
+#define TAILLE     1000
+
+#define NB_FLOTS_MAX 11
+#define NB_PDU_MAX   1000
+
+/*
+ * Un flot n'est ici qu'une adresse servant de source : la PDU qu'il
+ * fournit le désigne dans ses données
+ */
+int flots[NB_FLOTS_MAX];
+
+struct PDU_t * flot_getPDU(void * flot)
+{
+   return PDU_create(TAILLE, flot);
+}
+
+/*
+ * Ce que reçoit le puits d'un scénario
+ */
+struct scenario_t {
+   int nbRecues;
+   int nbParFlot[NB_FLOTS_MAX];
+   int ordre[NB_PDU_MAX];
+};
+
+int recevoir(void * r, getPDU_t getPDU, void * source)
+{
+   struct scenario_t * sc = (struct scenario_t *)r;
+   struct PDU_t * pdu = getPDU(source);
+   int f = (int *)PDU_private(pdu) - flots;
+
+   if (sc->nbRecues < NB_PDU_MAX) {
+      sc->ordre[sc->nbRecues] = f;
+   }
+   sc->nbRecues++;
+   sc->nbParFlot[f]++;
+   PDU_free(pdu);
+
+   return 1;
+}
+
+/*
+ * Création d'un ordonnanceur de chaque type sur un lien (un serveur
+ * de débit THROUGHPUT) vers le puits du scénario. Le scénario n'est
+ * pas libéré : son lien peut encore avoir des PDU à lui remettre.
+ */
+struct schedFQ_t * creerSched(int algo, struct scenario_t ** scenario)
+{
+   struct srvGen_t * lien;
+   struct scenario_t * sc = (struct scenario_t *)sim_malloc(sizeof(struct scenario_t));
+
+   *scenario = sc;
+   sc->nbRecues = 0;
+   memset(sc->nbParFlot, 0, sizeof(sc->nbParFlot));
+   lien = srvGen_create(sc, recevoir);
+   srvGen_setServiceTime(lien, serviceTimeProp, 8.0/THROUGHPUT);
+
+   switch (algo) {
+      case 0 :
+         return schedWFQ_create(lien, srvGen_processPDU, THROUGHPUT);
+      case 1 :
+         return schedWF2QPlus_create(lien, srvGen_processPDU);
+      default :
+         return schedSCFQ_create(lien, srvGen_processPDU);
+   }
+}
+
+static char * noms[3] = {"WFQ", "WF2Q+", "SCFQ"};
+
+/*
+ * Trois sources de poids 1, 2 et 4, toujours actives : sur 350 PDU,
+ * chacune doit en obtenir sa part à une PDU près
+ */
+int partage(int algo)
+{
+   struct scenario_t * sc;
+   struct schedFQ_t * sched;
+   int f, n;
+   int result = 0;
+
+   sched = creerSched(algo, &sc);
+   for (f = 0; f < 3; f++) {
+      schedFQ_addSource(sched, 1 << f, &flots[f], flot_getPDU);
+   }
+   for (n = 0; n < 300; n++) {
+      for (f = 0; f < 3; f++) {
+         schedFQ_processPDU(sched, flot_getPDU, &flots[f]);
+      }
+   }
+   motSim_runUntil(motSim_getCurrentTime() + 350*TAILLE*8.0/THROUGHPUT - 1e-6);
+
+   for (f = 0; f < 3; f++) {
+      if (abs(sc->nbParFlot[f] - 50*(1 << f)) > 1) {
+         printf("%s : %d PDU pour le flot %d au lieu de %d\n", noms[algo], sc->nbParFlot[f], f, 50*(1 << f));
+         result = 1;
+      }
+   }
+   return result;
+}
+
+/*
+ * Une source de poids 10 émet 11 PDU, dix sources de poids 1 en
+ * émettent une chacune. Retourne le nombre de PDU de la source
+ * lourde parmi les 10 premières servies.
+ */
+int rafale(int algo)
+{
+   struct scenario_t * sc;
+   struct schedFQ_t * sched;
+   int f, n, nb = 0;
+
+   sched = creerSched(algo, &sc);
+   schedFQ_addSource(sched, 10.0, &flots[0], flot_getPDU);
+   for (f = 1; f < 11; f++) {
+      schedFQ_addSource(sched, 1.0, &flots[f], flot_getPDU);
+   }
+   for (n = 0; n < 11; n++) {
+      schedFQ_processPDU(sched, flot_getPDU, &flots[0]);
+   }
+   for (f = 1; f < 11; f++) {
+      schedFQ_processPDU(sched, flot_getPDU, &flots[f]);
+   }
+   motSim_runUntil(motSim_getCurrentTime() + 22*TAILLE*8.0/THROUGHPUT);
+
+   for (n = 0; n < 10; n++) {
+      nb += (sc->ordre[n] == 0);
+   }
+   return ((sc->nbRecues == 21) && (sc->nbParFlot[0] == 11))?nb:-1;
+}
+
+int main() {
+   int algo, nb;
+   int result = 0;
+
+   motSim_create();
+
+   for (algo = 0; algo < 3; algo++) {
+      result = partage(algo) || result;
+   }
+
+   // WFQ sert toute la rafale, WF2Q+ alterne
+   nb = rafale(0);
+   if (nb != 10) {
+      printf("WFQ : %d PDU de la rafale sur les 10 premieres\n", nb);
+      result = 1;
+   }
+   nb = rafale(1);
+   if ((nb < 0) || (nb > 6)) {
+      printf("WF2Q+ : %d PDU de la rafale sur les 10 premieres\n", nb);
+      result = 1;
+   }
+
+   return result;
+}
@@ -0,0 +1,151 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : ordonnancement knapsack par programmation           */
+/* dynamique.                                                           */
+/*   Sur un petit cas, la solution doit avoir le même intérêt que la    */
+/* recherche exhaustive. Sur des BBFRAMEs de 58 Kbits et des centaines  */
+/* de paquets en attente, elle doit tenir dans la BBFRAME et la remplir */
+/* presque complètement, y compris en résolvant les MODCODs en          */
+/* parallèle (NDES_PTHREAD).                                            */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+#include <math.h>      // fabs
+
+#include <motsim.h>
+#include <pdu-sink.h>
+#include <file_pdu.h>
+#include <dvb-s2-ll.h>
+#include <sched_ks.h>
+
+#define NB_MODCOD 2
+#define NB_QOS 2
+#define NB_PDU_GROS_CAS 300
+#define TAILLE_MAX 1500
+
+/*
+ * Création d'un lien et de ses files d'entrée
+ */
+struct DVBS2ll_t * creerLien(int c1, int m1, int c2, int m2)
+{
+   struct PDUSink_t * sink = PDUSink_create();
+   struct DVBS2ll_t * dvbs2ll;
+
+   dvbs2ll = DVBS2ll_create(sink, PDUSink_processPDU, 1000000, FEC_FRAME_BITSIZE_LARGE);
+   DVBS2ll_addModcod(dvbs2ll, c1, m1);
+   DVBS2ll_addModcod(dvbs2ll, c2, m2);
+
+   return dvbs2ll;
+}
+
+/*
+ * Affectation des files et des fonctions d'utilité à un ordonnanceur
+ */
+void configurer(struct schedACM_t * sched, struct filePDU_t * files[][NB_QOS])
+{
+   int m, q;
+
+   for (m = 0; m < schedACM_getNbModCod(sched); m++) {
+      schedACM_setInputQueues(sched, m, files[m]);
+      for (q = 0; q < NB_QOS; q++) {
+         schedACM_setFileQoSType(sched, m, q, kseQoS_lin, 1.0 + m*NB_QOS + q, 0.0);
+      }
+   }
+}
+
+/*
+ * Vérification de la cohérence d'une solution
+ */
+int verifier(struct schedACM_t * sched, struct filePDU_t * files[][NB_QOS])
+{
+   t_remplissage * sol = schedACM_getSolution(sched);
+   struct DVBS2ll_t * dvbs2ll = schedACM_getACMLink(sched);
+   int m, q, vol = 0;
+
+   for (m = 0; m < schedACM_getNbModCod(sched); m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         if (sol->nbrePaquets[m][q] > filePDU_length(files[m][q])) {
+            return 1;
+	 }
+         vol += filePDU_size_n_PDU(files[m][q], sol->nbrePaquets[m][q]);
+      }
+   }
+   printf("modcod %d, volume %d/%d, interet %e\n", sol->modcod, vol,
+	  DVBS2ll_bbframePayloadBitSize(dvbs2ll, sol->modcod)/8, sol->interet);
+
+   return (vol != sol->volumeTotal)
+     || (8*vol > DVBS2ll_bbframePayloadBitSize(dvbs2ll, sol->modcod));
+}
+
+int main() {
+   struct DVBS2ll_t * dvbs2ll;
+   struct schedACM_t * exhaustif, * dynamique;
+#ifdef NDES_PTHREAD
+   struct schedACM_t * parallele;
+#endif
+   struct filePDU_t * files[NB_MODCOD][NB_QOS];
+   double interetExhaustif;
+   int modcodExhaustif;
+   int m, q, n, capacite;
+   int result = 0;
+
+   motSim_create();
+
+   /* Un petit cas, avec déclassement */
+   dvbs2ll = creerLien(C14SIZE, MQPSK, C12SIZE, M8PSK);
+   for (m = 0; m < 2; m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         files[m][q] = filePDU_create(NULL, NULL);
+         for (n = 0; n < 4; n++) {
+            filePDU_insert(files[m][q], PDU_create(150 + 97*((m*NB_QOS + q*3 + n*5)%7), NULL));
+	 }
+      }
+   }
+   exhaustif = sched_kse_create(dvbs2ll, NB_QOS, 1, KS_ALGO_EXHAUSTIVE);
+   configurer(exhaustif, files);
+   dynamique = sched_kse_create(dvbs2ll, NB_QOS, 1, KS_ALGO_DYNAMIC);
+   configurer(dynamique, files);
+
+   schedACM_schedule(exhaustif);
+   result = result || verifier(exhaustif, files);
+   interetExhaustif = schedACM_getSolution(exhaustif)->interet;
+   modcodExhaustif = schedACM_getSolution(exhaustif)->modcod;
+
+   schedACM_schedule(dynamique);
+   result = result || verifier(dynamique, files);
+   result = result
+     || (fabs(schedACM_getSolution(dynamique)->interet - interetExhaustif) > 1e-9*interetExhaustif)
+     || (schedACM_getSolution(dynamique)->modcod != modcodExhaustif);
+
+   /* De grosses BBFRAMEs et des centaines de paquets */
+   dvbs2ll = creerLien(C89SIZE, M16APSK, C910SIZE, M32APSK);
+   for (m = 0; m < 2; m++) {
+      for (q = 0; q < NB_QOS; q++) {
+         files[m][q] = filePDU_create(NULL, NULL);
+         for (n = 0; n < NB_PDU_GROS_CAS; n++) {
+            filePDU_insert(files[m][q], PDU_create(40 + random()%(TAILLE_MAX - 40), NULL));
+	 }
+      }
+   }
+   dynamique = sched_kse_create(dvbs2ll, NB_QOS, 1, KS_ALGO_DYNAMIC);
+   configurer(dynamique, files);
+   schedACM_schedule(dynamique);
+   result = result || verifier(dynamique, files);
+
+#ifdef NDES_PTHREAD
+   // La résolution parallèle des MODCODs donne la même solution
+   parallele = sched_kse_create(dvbs2ll, NB_QOS, 1, KS_ALGO_DYNAMIC);
+   configurer(parallele, files);
+   schedACM_setNbThreads(parallele, 4);
+   schedACM_schedule(parallele);
+   result = result || verifier(parallele, files)
+     || (schedACM_getSolution(parallele)->interet != schedACM_getSolution(dynamique)->interet)
+     || (schedACM_getSolution(parallele)->modcod != schedACM_getSolution(dynamique)->modcod);
+#endif
+
+   // Avec autant de paquets, il ne doit pas rester de place perdue
+   capacite = DVBS2ll_bbframePayloadBitSize(dvbs2ll, schedACM_getSolution(dynamique)->modcod)/8;
+   result = result || (schedACM_getSolution(dynamique)->volumeTotal <= capacite - TAILLE_MAX);
+
+   return result;
+}
@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------*/
+/*   Test de NDES : l'ordonnanceur round robin avec un grand nombre     */
+/* d'entrées, dont seules quelques unes sont actives. Les entrées       */
+/* actives doivent être servies à tour de rôle et les autres ne jamais  */
+/* être sollicitées.                                                    */
+/*----------------------------------------------------------------------*/
+
+#include <stdlib.h>    // Malloc, NULL, exit, ...
+#include <stdio.h>     // printf, ...
+
+#include <motsim.h>
+#include <file_pdu.h>
+#include <sched_rr.h>
+
+#define NB_FILES   1000
+#define NB_ACTIVES 5
+#define NB_PDU     4
+
+static int actives[NB_ACTIVES] = {999, 3, 500, 42, 0};
+
+struct filePDU_t * files[NB_FILES];
+int nbAppels = 0;
+
+/*
+ * Les files sont interrogées au travers de cette fonction pour
+ * compter les sollicitations
+ */
+struct PDU_t * compterGetPDU(void * file)
+{
+   nbAppels++;
+   return filePDU_getPDU(file);
+}
+
+/*
+ * Une destination toujours occupée : c'est le test qui tire les PDU
+ */
+int occupee(void * d, getPDU_t getPDU, void * source)
+{
+   return 0;
+}
+
+int main() {
+   struct rrSched_t * sched;
+   struct PDU_t * pdu;
+   int a, n, f;
+   int result = 0;
+
+   motSim_create();
+
+   sched = rrSched_create(NULL, occupee);
+   for (f = 0; f < NB_FILES; f++) {
+      files[f] = filePDU_create(sched, rrSched_processPDU);
+      rrSched_addSource(sched, files[f], compterGetPDU);
+   }
+
+   // Les PDU portent le numéro de leur file comme taille
+   for (a = 0; a < NB_ACTIVES; a++) {
+      for (n = 0; n < NB_PDU; n++) {
+         filePDU_insert(files[actives[a]], PDU_create(actives[a], NULL));
+      }
+   }
+
+   // Service à tour de rôle, dans l'ordre d'activation
+   for (n = 0; n < NB_PDU; n++) {
+      for (a = 0; a < NB_ACTIVES; a++) {
+         pdu = rrSched_getPDU(sched);
+         if ((pdu == NULL) || (PDU_size(pdu) != actives[a])) {
+            printf("PDU %d de la file %d non servie\n", n, actives[a]);
+            result = 1;
+         }
+         if (pdu) {
+            PDU_free(pdu);
+         }
+      }
+   }
+   result = result || (rrSched_getPDU(sched) != NULL);
+
+   // Chaque file active a été sollicitée une fois de plus que son
+   // nombre de PDU, les autres jamais
+   if (nbAppels != NB_ACTIVES*(NB_PDU + 1)) {
+      printf("%d sollicitations au lieu de %d\n", nbAppels, NB_ACTIVES*(NB_PDU + 1));
+      result = 1;
+   }
+
+   // Une file vidée est de nouveau servie après notification
+   nbAppels = 0;
+   filePDU_insert(files[7], PDU_create(7, NULL));
+   pdu = rrSched_getPDU(sched);
+   result = result || (pdu == NULL) || (PDU_size(pdu) != 7) || (nbAppels != 1);
+
+   return result;
+}